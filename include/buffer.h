@@ -0,0 +1,184 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/buffer.h
+ *
+ * @brief Type-tagged buffers for mixed precision storage
+ *
+ * A buffer stores many elements of a single data type as raw, aligned bytes.
+ * The type tag lives on the buffer rather than on each element, so storage
+ * costs exactly the width of the format and kernels dispatch once per buffer
+ * to a type-specialized loop.
+ *
+ * Supported data types are:
+ *   - TYPE_FLOAT_F32, TYPE_FLOAT_F16, TYPE_FLOAT_BF16
+ *   - TYPE_FLOAT_F8 (E4M3), TYPE_FLOAT_F8_E5M2
+ *   - TYPE_QUANT_K8, TYPE_QUANT_K4 (blocks of BUFFER_BLOCK_SIZE elements
+ *     sharing a half precision scale)
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef ALT_BUFFER_H
+#define ALT_BUFFER_H
+
+#include "matrix.h"
+#include "precision.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Alignment of buffer storage in bytes (one cache line, one AVX-512 vector)
+#define BUFFER_ALIGNMENT  64
+// Number of elements sharing one scale in quantized formats
+#define BUFFER_BLOCK_SIZE 32
+
+/**
+ * @brief 8-bit quantized block: x[i] = scale * quants[i]
+ */
+typedef struct BlockQ8 {
+    float16_t scale;                     ///< Half precision block scale.
+    int8_t    quants[BUFFER_BLOCK_SIZE]; ///< Signed 8-bit quants.
+} block_q8_t;
+
+/**
+ * @brief 4-bit quantized block: x[i] = scale * (nibble[i] - 8)
+ *
+ * Element i is stored in the low nibble of quants[i / 2] when i is even and
+ * in the high nibble when i is odd.
+ */
+typedef struct BlockQ4 {
+    float16_t scale;                         ///< Half precision block scale.
+    uint8_t   quants[BUFFER_BLOCK_SIZE / 2]; ///< Two 4-bit quants per byte.
+} block_q4_t;
+
+/**
+ * @brief A structure representing a type-tagged buffer.
+ *
+ * @param type  The data type shared by every element.
+ * @param count The number of logical elements.
+ * @param size  The number of bytes of storage in use.
+ * @param data  Raw storage aligned to BUFFER_ALIGNMENT bytes.
+ */
+typedef struct Buffer {
+    data_type_t type;  ///< The data type shared by every element.
+    size_t      count; ///< The number of logical elements.
+    size_t      size;  ///< The number of bytes of storage in use.
+    void*       data;  ///< Raw storage aligned to BUFFER_ALIGNMENT bytes.
+} buffer_t;
+
+/**
+ * @brief Returns a human readable name for a data type.
+ */
+const char* buffer_type_name(data_type_t type);
+
+/**
+ * @brief Returns the number of bytes needed to store count elements.
+ *
+ * @param type  The data type of the elements.
+ * @param count The number of elements.
+ * @return The storage size in bytes, or 0 for an invalid type.
+ */
+size_t buffer_type_size(data_type_t type, size_t count);
+
+/**
+ * @brief Create a new zero-filled buffer.
+ *
+ * @param type  The data type of the elements.
+ * @param count The number of elements.
+ * @return A pointer to the newly created buffer, or NULL on failure.
+ */
+buffer_t* buffer_create(data_type_t type, size_t count);
+
+/**
+ * @brief Free an allocated buffer and its storage.
+ *
+ * @param buffer A pointer to the buffer to be freed.
+ */
+void buffer_free(buffer_t* buffer);
+
+/**
+ * @brief Encode 32-bit floats into the buffer's data type.
+ *
+ * @param buffer The destination buffer.
+ * @param src    The source array; must hold buffer->count elements.
+ * @return True on success, false if the type is not supported.
+ */
+bool buffer_from_float(buffer_t* buffer, const float* src);
+
+/**
+ * @brief Decode the buffer into 32-bit floats.
+ *
+ * @param buffer The source buffer.
+ * @param dst    The destination array; must hold buffer->count elements.
+ * @return True on success, false if the type is not supported.
+ */
+bool buffer_to_float(const buffer_t* buffer, float* dst);
+
+/**
+ * @brief Create a copy of a buffer converted to another data type.
+ *
+ * @param buffer The source buffer.
+ * @param type   The data type of the copy.
+ * @return A pointer to the converted buffer, or NULL on failure.
+ */
+buffer_t* buffer_convert(const buffer_t* buffer, data_type_t type);
+
+/**
+ * @brief Dot product of a buffer with a 32-bit float array.
+ *
+ * The buffer is decoded blockwise inside the kernel, so no full-size f32 copy
+ * is made. Quantized types accumulate the integer quants and apply the block
+ * scale once per block.
+ *
+ * @param buffer The typed buffer.
+ * @param b      The float array; must hold buffer->count elements.
+ * @return The dot product, or NAN if the type is not supported.
+ */
+float buffer_dot_float(const buffer_t* buffer, const float* b);
+
+// Mixed precision storage for vectors and matrices
+
+/**
+ * @brief Encode an N-dimensional vector into a typed buffer
+ *
+ * The vector keeps its 32-bit elements for computation; the buffer holds the
+ * same values at the requested storage precision.
+ *
+ * @param vector Input vector
+ * @param type Data type of the buffer
+ * @return A pointer to the newly created buffer
+ */
+buffer_t* vector_to_buffer(const vector_t* vector, data_type_t type);
+
+/**
+ * @brief Decode a typed buffer into a new N-dimensional vector
+ *
+ * @param buffer Input buffer
+ * @return A pointer to the newly created vector
+ */
+vector_t* vector_from_buffer(const buffer_t* buffer);
+
+/**
+ * @brief Encode a matrix into a typed buffer in row-major order
+ *
+ * @param matrix Input matrix
+ * @param type Data type of the buffer
+ * @return A pointer to the newly created buffer
+ */
+buffer_t* matrix_to_buffer(const matrix_t* matrix, data_type_t type);
+
+/**
+ * @brief Decode a typed buffer into a new rows x columns matrix
+ *
+ * @param buffer Input buffer; must hold rows * columns elements
+ * @param rows Number of rows
+ * @param columns Number of columns
+ * @return A pointer to the newly created matrix
+ */
+matrix_t* matrix_from_buffer(
+    const buffer_t* buffer, const size_t rows, const size_t columns
+);
+
+#endif // ALT_BUFFER_H
@@ -1,10 +1,17 @@
 /**
  * @file include/fixed.h
+ *
+ * @brief Q16.16 fixed-point arithmetic
+ *
+ * Products are formed in 64 bits and rounded once, results saturate instead
+ * of wrapping, and division multiplies by a Newton-Raphson reciprocal. The
+ * array kernels use AVX2 when the compiler targets it.
  */
 
 #ifndef FIXED_H
 #define FIXED_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Define constants for Lookup Table (LUT) and Fixed-Point Arithmetic
@@ -20,6 +27,10 @@
 // Define fixed-point data type and conversion macros
 typedef int32_t fixed16_t; // Using 32-bit integer for fixed-point calculations
 
+// Saturation bounds, roughly +/- 32768.0
+#define FIXED_MAX         INT32_MAX
+#define FIXED_MIN         INT32_MIN
+
 // Converts a fixed-point number to an integer (truncating the fractional part)
 #define FIXED_TO_INT(x)   ((x) >> FIXED_SIZE)
 
@@ -34,4 +45,103 @@ typedef int32_t fixed16_t; // Using 32-bit integer for fixed-point calculations
 // CPUs)
 #define FIXED_TO_FLOAT(x) ((float) (x) / FIXED_VAL)
 
+// Rounding applied when discarding fractional bits
+typedef enum FixedRounding {
+    FIXED_ROUND_FLOOR,        // toward negative infinity, same as (x >> n)
+    FIXED_ROUND_ZERO,         // toward zero
+    FIXED_ROUND_NEAREST,      // to nearest, ties toward positive infinity
+    FIXED_ROUND_NEAREST_EVEN, // to nearest, ties to even
+} fixed_rounding_t;
+
+// Clamp a wide intermediate into the fixed16_t range
+fixed16_t fixed_saturate(int64_t value);
+
+// Shift value right by shift bits (0 < shift < 63) with the given rounding
+int64_t fixed_round_shift(int64_t value, int shift, fixed_rounding_t mode);
+
+// Saturating addition and subtraction
+fixed16_t fixed_add(fixed16_t a, fixed16_t b);
+fixed16_t fixed_sub(fixed16_t a, fixed16_t b);
+
+// Saturating multiplication rounded to nearest
+fixed16_t fixed_mul(fixed16_t a, fixed16_t b);
+
+// Saturating multiplication with an explicit rounding mode
+fixed16_t fixed_mul_round(fixed16_t a, fixed16_t b, fixed_rounding_t mode);
+
+// Saturating reciprocal 1 / a; zero saturates to FIXED_MAX
+fixed16_t fixed_reciprocal(fixed16_t a);
+
+// Saturating division a / b rounded to nearest; b == 0 saturates by sign of a
+fixed16_t fixed_div(fixed16_t a, fixed16_t b);
+
+// Elementwise dst[i] = a[i] op b[i] with the scalar semantics above
+void fixed_add_array(
+    const fixed16_t* a, const fixed16_t* b, fixed16_t* dst, size_t n
+);
+void fixed_sub_array(
+    const fixed16_t* a, const fixed16_t* b, fixed16_t* dst, size_t n
+);
+void fixed_mul_array(
+    const fixed16_t* a, const fixed16_t* b, fixed16_t* dst, size_t n
+);
+
+// Elementwise dst[i] = src[i] * scalar
+void fixed_scale_array(
+    const fixed16_t* src, fixed16_t scalar, fixed16_t* dst, size_t n
+);
+
+// Dot product accumulated exactly, rounded once at the end and saturated
+fixed16_t fixed_dot(const fixed16_t* a, const fixed16_t* b, size_t n);
+
+/*
+ * Integer GEMM for integer-only inference
+ *
+ * Inputs are symmetric int16 quants, products accumulate in int32, and a
+ * per-channel requantization maps the accumulators back to int16 using only
+ * integer multiplies and shifts. B is packed one FIXED_GEMM_BLOCK_K by
+ * FIXED_GEMM_BLOCK_N panel at a time with pairs of rows interleaved, which
+ * is the layout _mm256_madd_epi16 consumes.
+ *
+ * Accumulators wrap like int32 arithmetic, so callers must keep
+ * k * max|a| * max|b| below 2^31 and avoid the quant -32768; symmetric
+ * 12-bit quants (|q| <= 2047) allow k up to 512.
+ */
+
+// Panel dimensions for the packed B operand
+#define FIXED_GEMM_BLOCK_N 64
+#define FIXED_GEMM_BLOCK_K 256
+
+// Requantization scale = multiplier * 2^-(31 + shift), multiplier in Q31
+typedef struct FixedRequant {
+    int32_t multiplier; // in [2^30, 2^31) for non-zero scales
+    int32_t shift;      // additional right shift; negative shifts left
+} fixed_requant_t;
+
+// Decompose a positive real scale at setup time; the only floating point use
+fixed_requant_t fixed_requant_create(double scale);
+
+// Scale an accumulator, round to nearest, and saturate to int16
+int16_t fixed_requantize(int32_t value, fixed_requant_t requant);
+
+// c[m x n] = a[m x k] * b[k x n], all row-major
+void fixed_gemm_s16(
+    const int16_t* a,
+    const int16_t* b,
+    int32_t*       c,
+    size_t         m,
+    size_t         n,
+    size_t         k
+);
+
+// dst[i][j] = requantize(c[i][j] + bias[j], requant[j]); bias may be NULL
+void fixed_gemm_requantize(
+    const int32_t*         c,
+    const int32_t*         bias,
+    const fixed_requant_t* requant,
+    int16_t*               dst,
+    size_t                 m,
+    size_t                 n
+);
+
 #endif // FIXED_H
@@ -18,11 +18,16 @@
 #ifndef LEHMER_H
 #define LEHMER_H
 
+#include <stdalign.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // These constants were defined with 32-bits in mind, not 64-bits.
 #define MODULUS    2147483647 // Mersenne prime number used as modulus (2^31 - 1)
 #define MULTIPLIER 48271      // Multiplier for the Lehmer RNG
@@ -31,6 +36,29 @@
 #define A256       22925      // Jump multiplier for stream separation
 #define DEFAULT    123456789  // Default seed value
 
+// A256 == MULTIPLIER^LEHMER_STREAM_STRIDE % MODULUS
+#define LEHMER_STREAM_STRIDE 8367782 // Steps between streams from A256
+
+/*
+ * Division-free step
+ *
+ * MODULUS is the Mersenne prime 2^31 - 1, so 2^31 == 1 (mod MODULUS) and a
+ * product p = hi * 2^31 + lo reduces to hi + lo. Two folds bring any product
+ * below 2^62 under 2^31, and the result never equals MODULUS because
+ * products of non-zero seeds are never multiples of the prime.
+ */
+
+// p % MODULUS for p < 2^62 that is not a non-zero multiple of MODULUS
+static inline uint64_t lehmer_reduce(uint64_t product) {
+    product = (product & MODULUS) + (product >> 31);
+    return (product & MODULUS) + (product >> 31);
+}
+
+// seed * MULTIPLIER % MODULUS for a seed below MODULUS
+static inline uint64_t lehmer_step(uint64_t seed) {
+    return lehmer_reduce(seed * MULTIPLIER);
+}
+
 typedef struct LehmerState {
     uint64_t* seed;        // Current state of each stream
     size_t    stream;      // Current stream index
@@ -49,4 +77,143 @@ void lehmer_seed_streams(lehmer_state_t* state, uint64_t value);
 
 double lehmer_generate(lehmer_state_t* state);
 
+/*
+ * Jump-ahead
+ *
+ * Advancing k steps multiplies the seed by MULTIPLIER^k % MODULUS, which is
+ * found by square-and-multiply in O(log k). Workers that jump a shared seed
+ * by disjoint offsets draw disjoint subsequences of one logical stream, so a
+ * parallel run reproduces the serial one exactly. The period is MODULUS - 1,
+ * so k is taken modulo it.
+ */
+
+// MULTIPLIER^k % MODULUS
+uint64_t lehmer_jump_multiplier(uint64_t k);
+
+// Advance the selected stream by k steps as if lehmer_generate ran k times
+void lehmer_jump(lehmer_state_t* state, uint64_t k);
+
+// Seed stream i with value advanced by i * stride steps, for any stride
+void lehmer_seed_streams_stride(
+    lehmer_state_t* state, uint64_t value, uint64_t stride
+);
+
+// Uniform float in [0, 1) on a 2^-23 grid, filled into the mantissa
+float lehmer_generate_float(lehmer_state_t* state);
+
+/*
+ * Batched generation
+ *
+ * The batch variants write n consecutive draws of the selected stream and
+ * match n calls to lehmer_generate (or lehmer_generate_float) exactly.
+ *
+ * The lane variants advance up to LEHMER_MAX_LANES consecutive streams in
+ * lockstep, starting at the selected stream, so independent lanes fill SIMD
+ * registers. out[i] is drawn from stream (stream + i % lanes) % size, lanes
+ * is clamped to [1, min(size, LEHMER_MAX_LANES)], and the seeds are written
+ * back afterwards. 4, 8 and 16 lanes map onto whole AVX2 registers.
+ */
+
+#define LEHMER_MAX_LANES 16
+
+void lehmer_generate_batch(lehmer_state_t* state, double* out, size_t n);
+void lehmer_generate_batch_float(lehmer_state_t* state, float* out, size_t n);
+
+void lehmer_generate_lanes(
+    lehmer_state_t* state, double* out, size_t n, size_t lanes
+);
+void lehmer_generate_lanes_float(
+    lehmer_state_t* state, float* out, size_t n, size_t lanes
+);
+
+/*
+ * Samplers
+ *
+ * All samplers draw from the selected stream. Normals use the 128-strip
+ * ziggurat from tables.h: one draw supplies the strip, the sign and a 23-bit
+ * position, and about 98.8% of samples are accepted without evaluating exp
+ * or log. Bounded integers use Lemire's multiply-and-reject method over the
+ * LEHMER_RANGE_MAX distinct outputs of the generator, so they are exactly
+ * unbiased and rarely need the remainder of a division.
+ */
+
+// Number of distinct draws per step; the largest range lehmer_bounded takes
+#define LEHMER_RANGE_MAX (MODULUS - 1)
+
+// Standard normal sample
+double lehmer_normal(lehmer_state_t* state);
+
+// out[i] = mean + stddev * normal
+void lehmer_normal_batch(
+    lehmer_state_t* state, float* out, size_t n, float mean, float stddev
+);
+
+// out[i] = low + (high - low) * u with u in [0, 1) as lehmer_generate_float
+void lehmer_uniform_batch(
+    lehmer_state_t* state, float* out, size_t n, float low, float high
+);
+
+// Uniform integer in [0, range) for 0 < range <= LEHMER_RANGE_MAX; 0 gives 0
+uint32_t lehmer_bounded(lehmer_state_t* state, uint32_t range);
+
+void lehmer_bounded_batch(
+    lehmer_state_t* state, uint32_t* out, size_t n, uint32_t range
+);
+
+/*
+ * Per-thread stream handles
+ *
+ * lehmer_state_t shares one stream cursor and packs the seeds next to each
+ * other, so threads that select streams and generate from the same state
+ * race on the cursor and false share the seeds. A handle instead copies one
+ * stream's seed into its own cache line: check it out once per worker,
+ * generate without touching the state, and commit it back when done.
+ * Checkouts of distinct streams may run concurrently; the same stream must
+ * not be checked out twice at once.
+ *
+ * The lehmer_thread_* functions bind a handle stored in thread-local
+ * storage, for code that cannot pass a handle down its call chain.
+ */
+
+#define LEHMER_CACHE_LINE 64
+
+typedef struct LehmerStream {
+    alignas(LEHMER_CACHE_LINE) uint64_t seed; // Private copy of the seed
+    size_t stream;                            // Index in the owning state
+} lehmer_stream_t;
+
+// Copy the seed of the given stream into the handle
+void lehmer_stream_checkout(
+    const lehmer_state_t* state, lehmer_stream_t* handle, size_t stream
+);
+
+// Write the handle's seed back to its stream
+void lehmer_stream_commit(
+    lehmer_state_t* state, const lehmer_stream_t* handle
+);
+
+double lehmer_stream_generate(lehmer_stream_t* handle);
+float  lehmer_stream_generate_float(lehmer_stream_t* handle);
+
+void lehmer_stream_generate_batch(
+    lehmer_stream_t* handle, double* out, size_t n
+);
+void lehmer_stream_generate_batch_float(
+    lehmer_stream_t* handle, float* out, size_t n
+);
+
+// Bind the calling thread to a stream; returns false if already bound
+bool lehmer_thread_bind(lehmer_state_t* state, size_t stream);
+
+// Commit and release the calling thread's stream
+void lehmer_thread_unbind(void);
+
+// Draw from the calling thread's stream; the thread must be bound
+double lehmer_thread_generate(void);
+float  lehmer_thread_generate_float(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // LEHMER_H
@@ -0,0 +1,101 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/linear.h
+ *
+ * @brief C interface to simple linear regression, y = m * x + b
+ *
+ * See source/linear.cpp for the derivation of the loss and its partial
+ * derivatives. Gradients here are of the mean squared error, so descent
+ * subtracts them: m -= learning_rate * dedm.
+ *
+ * Build: compile source/linear.cpp with a C++17 compiler and link the object
+ * with the C sources. It needs no C++ runtime library.
+ */
+
+#ifndef ALT_LINEAR_H
+#define ALT_LINEAR_H
+
+#include "lehmer.h"
+#include "vector.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Values per accumulator of the fused gradient kernel
+#define LINEAR_LANES 8
+
+struct Params {
+    float slope;
+    float intercept;
+};
+
+// Loss and both partial derivatives at one (m, b), from a single pass
+struct Gradient {
+    float mse;  // (1 / n) * Σ(y' - (m * x + b))^2
+    float dedm; // -2/n * Σx(y' - (m * x + b))
+    float dedb; // -2/n * Σ(y' - (m * x + b))
+};
+
+// Sufficient statistics of simple linear regression. Each sum is kept with a
+// compensation term; zero-initialize before the first update.
+struct LinearStats {
+    size_t n;
+    double x, y, xx, xy;         // Σx, Σy, Σxx, Σxy
+    double x_c, y_c, xx_c, xy_c; // Rounding error of each sum
+};
+
+struct LinearModel {
+    struct Vector* X;
+    struct Vector* Y;
+    struct Params* params;
+    float          learning_rate;
+    size_t         iterations;
+};
+
+struct LinearModel* create_linear_model(size_t size, float learning_rate, size_t iterations);
+bool                destroy_linear_model(struct LinearModel* linear_model);
+
+float slope_intercept_form(float x, float m, float b);
+float mean_square_error(float X[], float Y[], size_t size, float m, float b);
+float partial_derivative_m(float X[], float Y[], size_t size, float m, float b);
+float partial_derivative_b(float X[], float Y[], size_t size, float m, float b);
+
+// mean_square_error, partial_derivative_m and partial_derivative_b fused
+struct Gradient mean_square_error_gradient(
+    const float X[], const float Y[], size_t size, float m, float b
+);
+
+// Gradient descent from m = b = 1, one fused pass per iteration
+struct Params fit_linear_regression(
+    float X[], float Y[], size_t size, float learning_rate, size_t iterations
+);
+
+// Adds size points to stats, e.g. as they arrive in chunks
+void linear_stats_update(struct LinearStats* stats, const float X[], const float Y[], size_t size);
+
+// Adds the points summarized by other to stats, e.g. from another thread or file
+void linear_stats_merge(struct LinearStats* stats, const struct LinearStats* other);
+
+// Exact least squares line of the points in stats; false if x does not vary
+bool linear_stats_solve(const struct LinearStats* stats, struct Params* params);
+
+// Least squares line from one pass split across threads (0 or 1 for none)
+struct Params fit_linear_ols(const float X[], const float Y[], size_t size, size_t threads);
+
+// Uniformly random permutation of 0 .. n - 1 by Fisher-Yates, n <= LEHMER_RANGE_MAX
+void linear_shuffle(uint32_t* order, size_t n, lehmer_state_t* state);
+
+// Mini-batch gradient descent over the model's points; iterations counts epochs
+struct Params fit_linear_minibatch(
+    struct LinearModel* linear_model, size_t batch_size, lehmer_state_t* state
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALT_LINEAR_H
@@ -11,10 +11,15 @@
 #include <pthread.h> // For including mutex functions
 #include <stdarg.h>  // For variadic function support
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h> // For memory allocation support
 #include <string.h> // Include for strerror declaration
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @brief Enumeration representing different levels of logging.
  */
@@ -25,6 +30,38 @@ typedef enum LOG_LEVEL {
     LOG_LEVEL_ERROR  /**< Error level logging. */
 } log_level_t;
 
+/**
+ * @brief Compile-time minimum log level.
+ *
+ * LOG calls below this level compile to nothing, including the evaluation of
+ * their arguments. Override it on the command line, e.g.
+ * -DLOG_MIN_LEVEL=LOG_LEVEL_WARN for release builds.
+ */
+#ifndef LOG_MIN_LEVEL
+    #define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+/**
+ * @brief Enumeration representing the modules with their own runtime level.
+ *
+ * A translation unit selects its module by defining LOG_MODULE_ID before
+ * including this header; it defaults to LOG_MODULE_DEFAULT.
+ */
+typedef enum LOG_MODULE {
+    LOG_MODULE_DEFAULT,   /**< Anything without a module of its own. */
+    LOG_MODULE_VECTOR,    /**< source/vector.c */
+    LOG_MODULE_MATRIX,    /**< source/matrix.c */
+    LOG_MODULE_PRECISION, /**< source/precision.c */
+    LOG_MODULE_BUFFER,    /**< source/buffer.c */
+    LOG_MODULE_XOR,       /**< source/xor.c */
+    LOG_MODULE_LINEAR,    /**< source/linear.cpp */
+    LOG_MODULE_COUNT      /**< Number of modules. */
+} log_module_t;
+
+#ifndef LOG_MODULE_ID
+    #define LOG_MODULE_ID LOG_MODULE_DEFAULT
+#endif
+
 /**
  * @brief Enumeration representing different types of logging.
  */
@@ -34,16 +71,212 @@ typedef enum LOG_TYPE {
     LOG_TYPE_FILE     /**< Log to a file. */
 } log_type_t;
 
+/**
+ * @brief Enumeration representing what an asynchronous logger does when its
+ * queue is full.
+ */
+typedef enum LOG_POLICY {
+    LOG_POLICY_DROP,     /**< Discard the new message. */
+    LOG_POLICY_BLOCK,    /**< Wait for the writer thread to free a slot. */
+    LOG_POLICY_OVERWRITE /**< Discard the oldest queued message. */
+} log_policy_t;
+
+/**
+ * @brief Bytes per queued message, including the level prefix. Longer
+ * messages are truncated and terminated with a newline.
+ */
+#define LOG_ASYNC_MESSAGE_SIZE 512
+
+/**
+ * @brief Default number of queue slots; capacities are rounded up to a power
+ * of two.
+ */
+#define LOG_ASYNC_CAPACITY 4096
+
+/**
+ * @brief Default bytes per segment file of a segmented logger.
+ */
+#define LOG_SEGMENT_SIZE (16 * 1024 * 1024)
+
+/**
+ * @brief Compresses a closed segment file.
+ *
+ * Runs on the writer thread. On success it writes the path of the result to
+ * compressed, or leaves it empty if the segment stays where it is, and should
+ * remove the original once it is no longer needed.
+ *
+ * @param path The path of the closed segment.
+ * @param compressed Receives the path of the compressed file.
+ * @param size The capacity of compressed in bytes.
+ * @param context The context pointer given in log_segment_config_t.
+ *
+ * @return True on success, false to keep the segment as it is.
+ */
+typedef bool (*log_compress_t)(const char* path, char* compressed, size_t size, void* context);
+
+/**
+ * @brief Configuration of a segmented logger.
+ */
+typedef struct LogSegmentConfig {
+    const char*    path;     /**< Segment path prefix; segments are path.000000, path.000001, ... */
+    size_t         size;     /**< Bytes per segment, 0 for LOG_SEGMENT_SIZE. */
+    long           interval; /**< Seconds before a segment is closed early, 0 for never. */
+    size_t         keep;     /**< Closed segments kept, older ones deleted; 0 keeps all. */
+    log_compress_t compress; /**< Called for every closed segment, NULL for none. */
+    void*          context;  /**< Passed to compress. */
+    size_t         capacity; /**< Queue slots, 0 for LOG_ASYNC_CAPACITY. */
+    log_policy_t   policy;   /**< Behavior when the queue is full. */
+} log_segment_config_t;
+
+/**
+ * @brief Default bytes per thread buffer of a buffered logger.
+ */
+#define LOG_BUFFERED_SIZE (16 * 1024)
+
+/**
+ * @brief Default milliseconds between timed flushes of a buffered logger.
+ */
+#define LOG_BUFFERED_INTERVAL 100
+
+/**
+ * @brief Most arguments a LOG_BINARY format may consume, star widths and
+ * precisions included; formats with more are logged as text.
+ */
+#define LOG_BINARY_ARGUMENTS 16
+
+/**
+ * @brief Static state of one LOG_BINARY call site.
+ *
+ * The first call registers the site: its format string is parsed once into
+ * argument kinds and it receives a process-wide ID. Every later call only
+ * loads the ID.
+ */
+typedef struct LogSite {
+    const char*   format; /**< printf format string. */
+    const char*   file;   /**< Source file of the call. */
+    int           line;   /**< Source line of the call. */
+    uint32_t      id;     /**< Site ID, 0 until registered; accessed atomically. */
+    unsigned char count;  /**< Number of arguments, set at registration. */
+    unsigned char kinds[LOG_BINARY_ARGUMENTS]; /**< Argument kinds, set at registration. */
+} log_site_t;
+
+/**
+ * @brief Milliseconds between automatic summaries of suppressed messages.
+ */
+#define LOG_LIMIT_SUMMARY_INTERVAL 1000
+
+/**
+ * @brief Static state of one rate-limited or sampled call site.
+ *
+ * The counters are accessed atomically. A site joins a process-wide registry
+ * the first time it suppresses a message, together with the logger it was
+ * suppressed for, so its count can be summarized to that logger. Destroying
+ * the logger reports the count and removes the site again.
+ */
+typedef struct LogLimit {
+    const char*      file;       /**< Source file of the call. */
+    int              line;       /**< Source line of the call. */
+    int              level;      /**< Level of the call, set at registration. */
+    uint64_t         calls;      /**< Calls that passed the level filters. */
+    uint64_t         suppressed; /**< Messages suppressed since the last report. */
+    uint64_t         deadline;   /**< CLOCK_MONOTONIC_COARSE nanoseconds of the next interval. */
+    uint32_t         registered; /**< Nonzero once the site is in the registry. */
+    struct Logger*   logger;     /**< Logger receiving summaries, set at registration. */
+    struct LogLimit* next;       /**< Next registered site. */
+} log_limit_t;
+
+/**
+ * @brief Enumeration representing the layout of every line a logger writes.
+ */
+typedef enum LOG_FORMAT {
+    LOG_FORMAT_PLAIN,   /**< "[LEVEL] message key=value", the default. */
+    LOG_FORMAT_STAMPED, /**< "seconds.millis tid [LEVEL] message key=value". */
+    LOG_FORMAT_JSON     /**< One JSON object per line. */
+} log_format_t;
+
+/**
+ * @brief Enumeration representing the value types of a structured field.
+ */
+typedef enum LOG_FIELD_TYPE {
+    LOG_FIELD_INT,    /**< value.integer */
+    LOG_FIELD_DOUBLE, /**< value.real */
+    LOG_FIELD_STRING, /**< value.string */
+    LOG_FIELD_BOOL    /**< value.boolean */
+} log_field_type_t;
+
+/**
+ * @brief A key=value pair attached to a message by LOG_FIELDS.
+ *
+ * Build fields with log_field_int and friends. Keys and strings are only
+ * read while the message is formatted, so they need not outlive the call.
+ */
+typedef struct LogField {
+    const char*      key;  /**< Field name. */
+    log_field_type_t type; /**< Selects the member of value. */
+
+    union {
+        long long   integer; /**< LOG_FIELD_INT */
+        double      real;    /**< LOG_FIELD_DOUBLE */
+        const char* string;  /**< LOG_FIELD_STRING */
+        bool        boolean; /**< LOG_FIELD_BOOL */
+    } value;
+} log_field_t;
+
+static inline log_field_t log_field_int(const char* key, long long value) {
+    log_field_t field;
+    field.key           = key;
+    field.type          = LOG_FIELD_INT;
+    field.value.integer = value;
+    return field;
+}
+
+static inline log_field_t log_field_double(const char* key, double value) {
+    log_field_t field;
+    field.key        = key;
+    field.type       = LOG_FIELD_DOUBLE;
+    field.value.real = value;
+    return field;
+}
+
+static inline log_field_t log_field_string(const char* key, const char* value) {
+    log_field_t field;
+    field.key          = key;
+    field.type         = LOG_FIELD_STRING;
+    field.value.string = value;
+    return field;
+}
+
+static inline log_field_t log_field_bool(const char* key, bool value) {
+    log_field_t field;
+    field.key           = key;
+    field.type          = LOG_FIELD_BOOL;
+    field.value.boolean = value;
+    return field;
+}
+
+/**
+ * @brief Background writer state, defined in logger.c.
+ */
+struct LogAsync;
+
+/**
+ * @brief Per-thread buffer state, defined in logger.c.
+ */
+struct LogBuffered;
+
 /**
  * @brief Structure representing a logger object.
  */
 struct Logger {
-    log_level_t     log_level;     /**< The logging level of the logger. */
-    log_type_t      log_type;      /**< The type of logger. */
-    const char*     log_type_name; /**< The name associated with the logger type. */
-    FILE*           file_stream;   /**< The file stream for writing log messages. */
-    const char*     file_path;     /**< The path to the log file. */
-    pthread_mutex_t thread_lock;   /**< Mutex to ensure thread-safe logging. */
+    log_level_t         log_level;     /**< The logging level of the logger. */
+    log_type_t          log_type;      /**< The type of logger. */
+    const char*         log_type_name; /**< The name associated with the logger type. */
+    FILE*               file_stream;   /**< The file stream for writing log messages. */
+    const char*         file_path;     /**< The path to the log file. */
+    pthread_mutex_t     thread_lock;   /**< Mutex to ensure thread-safe logging. */
+    struct LogAsync*    async;         /**< Background writer, NULL when synchronous. */
+    struct LogBuffered* buffered;      /**< Per-thread buffers, NULL when unbuffered. */
+    log_format_t        log_format;    /**< Layout of every line. */
 };
 
 /**
@@ -113,8 +346,9 @@ struct Logger* logger_create(log_level_t log_level, log_type_t log_type, const c
 /**
  * @brief Destroys a logger instance and releases associated resources.
  *
- * This function closes the log file associated with the logger, if any,
- * and frees the memory allocated for the logger instance.
+ * This function reports and unregisters the logger's limited sites, closes
+ * the log file associated with the logger, if any, and frees the memory
+ * allocated for the logger instance.
  *
  * @param logger A pointer to the logger instance to be destroyed.
  * @return True if the logger was successfully destroyed, false otherwise.
@@ -137,6 +371,295 @@ bool logger_destroy(struct Logger* logger);
  */
 bool logger_message(struct Logger* logger, log_level_t log_level, const char* format, ...);
 
+/**
+ * @brief Logs a message followed by structured fields.
+ *
+ * Behaves like logger_message. The fields are written after the message as
+ * key=value pairs, or as members of the JSON object in LOG_FORMAT_JSON.
+ *
+ * @param logger A pointer to the logger instance to use for logging.
+ * @param log_level The log level of the message to be logged.
+ * @param fields The fields to append, may be NULL if count is 0.
+ * @param count The number of fields.
+ * @param format The format string of the message to be logged.
+ * @param ... Additional arguments for formatting the message (optional).
+ *
+ * @return true if the message was successfully logged, false otherwise.
+ */
+bool logger_fields_message(
+    struct Logger*     logger,
+    log_level_t        log_level,
+    const log_field_t* fields,
+    size_t             count,
+    const char*        format,
+    ...
+);
+
+/**
+ * @brief Selects the layout of every line a logger writes.
+ *
+ * LOG_FORMAT_STAMPED and LOG_FORMAT_JSON add the wall-clock time and the
+ * kernel thread ID to each line. The time comes from CLOCK_MONOTONIC_COARSE,
+ * which is read without a system call, plus the offset to CLOCK_REALTIME
+ * taken once per process, so it has the resolution of the kernel tick
+ * (typically 1 to 4 ms) and never steps backwards. The thread ID is looked up
+ * once per thread. Set the format before other threads start logging.
+ *
+ * @param logger A pointer to the logger instance.
+ * @param log_format The layout to use.
+ *
+ * @return True if the format was set, false if it is invalid.
+ */
+bool logger_set_format(struct Logger* logger, log_format_t log_format);
+
+/**
+ * @brief Returns the wall-clock time used by stamped lines, in nanoseconds
+ * since the epoch, e.g. to log durations between two points as fields.
+ */
+uint64_t logger_timestamp(void);
+
+/**
+ * @brief Switches a logger to asynchronous mode.
+ *
+ * Callers format each message into a slot of a lock-free multi-producer ring
+ * buffer and return without taking the logger mutex or touching stdio. A
+ * dedicated writer thread drains the ring and emits the messages with large
+ * batched write(2) calls on the descriptor of the logger's stream. When the
+ * ring is full, the policy decides whether the caller drops its message,
+ * blocks, or overwrites the oldest one.
+ *
+ * Asynchronous loggers are drained and stopped at normal process exit, so
+ * every message logged before exit() or a return from main is written.
+ *
+ * @param logger A pointer to the logger instance.
+ * @param capacity The number of queue slots, or 0 for LOG_ASYNC_CAPACITY.
+ * @param policy The behavior when the queue is full.
+ *
+ * @return True if the writer thread started, false otherwise.
+ */
+bool logger_start_async(struct Logger* logger, size_t capacity, log_policy_t policy);
+
+/**
+ * @brief Switches a logger to asynchronous mode with segment files as output.
+ *
+ * Messages are queued as with logger_start_async, but the writer thread
+ * copies them into a preallocated, memory-mapped segment file instead of
+ * calling write(2) on the logger's stream, so logging never waits on file
+ * system calls. A segment is closed when the next batch does not fit or when
+ * it has been open for the configured interval. Closing trims the segment to
+ * its contents, runs the optional compressor and deletes segments beyond the
+ * configured number to keep, all on the writer thread.
+ *
+ * Until a segment is closed its file keeps its full preallocated size, with
+ * zero bytes after the last message. Messages already copied survive a crash
+ * of the process because the mapping is shared with the page cache.
+ *
+ * @param logger A pointer to the logger instance.
+ * @param config The segment configuration; the path is copied.
+ *
+ * @return True if the first segment was created and the writer started.
+ */
+bool logger_start_segments(struct Logger* logger, const log_segment_config_t* config);
+
+/**
+ * @brief Drains the queue, stops the writer thread and returns the logger to
+ * synchronous mode. A segmented logger closes its last segment.
+ *
+ * No other thread may log through the logger while it is being stopped.
+ *
+ * @param logger A pointer to the logger instance.
+ *
+ * @return True if the logger was asynchronous and is now stopped.
+ */
+bool logger_stop_async(struct Logger* logger);
+
+/**
+ * @brief Switches a logger to per-thread buffered mode.
+ *
+ * Each thread appends its messages to a private buffer, so logging takes no
+ * shared lock. A buffer is written with a single writev(2) when the next
+ * message does not fit, when a message at LOG_LEVEL_ERROR is logged, when
+ * its thread exits, and every interval by a flusher thread. Lines are never
+ * split, and each one starts with a logger-wide sequence number so the
+ * output of all threads can be merged back into logging order, e.g. with
+ * sort -n -s.
+ *
+ * Buffered loggers are flushed and stopped at normal process exit. Asynchronous
+ * and buffered modes are mutually exclusive.
+ *
+ * @param logger A pointer to the logger instance.
+ * @param size The bytes per thread buffer, or 0 for LOG_BUFFERED_SIZE.
+ * @param interval The milliseconds between timed flushes, or 0 for
+ * LOG_BUFFERED_INTERVAL.
+ *
+ * @return True if buffered mode started, false otherwise.
+ */
+bool logger_start_buffered(struct Logger* logger, size_t size, long interval);
+
+/**
+ * @brief Writes every thread buffer, stops the flusher thread and returns the
+ * logger to synchronous mode.
+ *
+ * No other thread may log through the logger while it is being stopped.
+ *
+ * @param logger A pointer to the logger instance.
+ *
+ * @return True if the logger was buffered and is now stopped.
+ */
+bool logger_stop_buffered(struct Logger* logger);
+
+/**
+ * @brief Switches a logger to binary per-thread buffered mode.
+ *
+ * Works like logger_start_buffered, but the stream receives binary records
+ * instead of text. Messages logged with LOG_BINARY store only the ID of their
+ * call site, a coarse timestamp (one kernel tick, typically 1 to 4 ms) and
+ * the raw bytes of their arguments, and are
+ * formatted later by logger_decode or the log_decoder tool. Messages logged
+ * with LOG are formatted as usual and stored as text records.
+ *
+ * The records use the byte order and type sizes of the host, so logs must be
+ * decoded on the same platform.
+ *
+ * @param logger A pointer to the logger instance, usually a file logger.
+ * @param size The bytes per thread buffer, or 0 for LOG_BUFFERED_SIZE.
+ * @param interval The milliseconds between timed flushes, or 0 for
+ * LOG_BUFFERED_INTERVAL.
+ *
+ * @return True if binary mode started, false otherwise.
+ */
+bool logger_start_binary(struct Logger* logger, size_t size, long interval);
+
+/**
+ * @brief Records a message of a LOG_BINARY call site.
+ *
+ * On a binary logger only the arguments are copied. Any other logger formats
+ * the message and logs it like LOG would. Use the LOG_BINARY macro rather
+ * than calling this directly.
+ *
+ * @param logger A pointer to the logger instance to use for logging.
+ * @param log_level The log level of the message to be logged.
+ * @param site The static state of the call site.
+ * @param ... The arguments of the site's format string.
+ *
+ * @return true if the message was successfully logged, false otherwise.
+ */
+bool logger_binary_message(struct Logger* logger, log_level_t log_level, log_site_t* site, ...);
+
+/**
+ * @brief Renders a binary log as text.
+ *
+ * Every message becomes one line with its UTC timestamp followed by the
+ * prefix and text a synchronous logger would have written. Lines are sorted
+ * by sequence number, so the output is in logging order across threads. A
+ * record cut short at the end of the input, e.g. by a crash, is ignored.
+ *
+ * @param input The binary log, opened for reading.
+ * @param output The stream receiving the text.
+ *
+ * @return True if the whole input was decoded, false otherwise.
+ */
+bool logger_decode(FILE* input, FILE* output);
+
+/**
+ * @brief Returns true for the first n calls of a site.
+ */
+bool logger_limit_first(log_limit_t* limit, uint64_t n);
+
+/**
+ * @brief Returns true for the first call of a site and every k-th after it.
+ */
+bool logger_limit_every(log_limit_t* limit, uint64_t k);
+
+/**
+ * @brief Returns true for at most one call of a site per interval of
+ * milliseconds, measured with the coarse monotonic clock.
+ */
+bool logger_limit_interval(log_limit_t* limit, long interval);
+
+/**
+ * @brief Counts a message suppressed at a site.
+ *
+ * Costs one atomic increment. Every LOG_LIMIT_SUMMARY_INTERVAL milliseconds
+ * the writer thread of an asynchronous logger or the flusher thread of a
+ * buffered one writes the summary of its sites; a synchronous logger has no
+ * thread, so the first suppression after the interval writes it instead.
+ * logger_flush, logger_destroy and process exit report whatever is still
+ * pending. See logger_limit_summary.
+ *
+ * @param logger The logger the message was meant for.
+ * @param log_level The level of the message.
+ * @param limit The static state of the call site.
+ */
+void logger_limit_suppress(struct Logger* logger, log_level_t log_level, log_limit_t* limit);
+
+/**
+ * @brief Logs how many messages a site suppressed since its last report, if
+ * any, and resets the count. Called when the site lets a message through.
+ */
+void logger_limit_report(struct Logger* logger, log_level_t log_level, log_limit_t* limit);
+
+/**
+ * @brief Logs and resets the suppressed count of every site of a logger that
+ * suppressed messages since its last report, one line per site at the site's
+ * level.
+ *
+ * @param logger A pointer to the logger instance whose sites are summarized.
+ */
+void logger_limit_summary(struct Logger* logger);
+
+/**
+ * @brief Reports the suppressed counts of the logger's limited sites, then
+ * waits until every message logged before the call has been written.
+ *
+ * @param logger A pointer to the logger instance.
+ *
+ * @return True once the messages are written, false on invalid input.
+ */
+bool logger_flush(struct Logger* logger);
+
+/**
+ * @brief Returns the number of messages discarded by the drop and overwrite
+ * policies since the logger became asynchronous.
+ *
+ * @param logger A pointer to the logger instance.
+ */
+size_t logger_dropped(const struct Logger* logger);
+
+/**
+ * @brief Runtime minimum level of each module, indexed by log_module_t.
+ *
+ * Read with a relaxed atomic load by LOG and written through
+ * logger_set_module_level; every module starts at LOG_LEVEL_DEBUG.
+ */
+extern int log_module_levels[LOG_MODULE_COUNT];
+
+/**
+ * @brief Sets the runtime minimum level of a module.
+ *
+ * Takes effect for LOG calls in every thread without further
+ * synchronization; a call racing with the change may use either level.
+ *
+ * @param module The module to update.
+ * @param log_level The lowest level the module will log.
+ *
+ * @return True if the level was set, false if the module is invalid.
+ */
+bool logger_set_module_level(log_module_t module, log_level_t log_level);
+
+/**
+ * @brief Returns the runtime minimum level of a module, or LOG_LEVEL_DEBUG if
+ * the module is invalid.
+ */
+log_level_t logger_get_module_level(log_module_t module);
+
+/**
+ * @brief Returns true if a module currently logs messages of the given level.
+ */
+static inline bool logger_module_enabled(int module, log_level_t log_level) {
+    return (int) log_level >= __atomic_load_n(&log_module_levels[module], __ATOMIC_RELAXED);
+}
+
 /**
  * @brief Macro for logging messages using a logger instance.
  *
@@ -144,6 +667,10 @@ bool logger_message(struct Logger* logger, log_level_t log_level, const char* fo
  * logger instance. It calls the logger_message function with the specified logger,
  * log level, and message format.
  *
+ * Messages below LOG_MIN_LEVEL are removed at compile time. Otherwise the
+ * level of the module named by LOG_MODULE_ID is checked with one relaxed
+ * load, and the arguments are only evaluated when the message passes it.
+ *
  * @param logger A pointer to the logger instance to use for logging.
  * @param level The log level of the message to be logged.
  * @param format The format string of the message to be logged.
@@ -155,7 +682,100 @@ bool logger_message(struct Logger* logger, log_level_t log_level, const char* fo
  * @endcode
  */
 #define LOG(logger, level, format, ...) \
-    logger_message((logger), (level), "[%s:%d] " format, __FILE__, __LINE__, ##__VA_ARGS__)
+    do { \
+        if ((int) (level) >= (int) LOG_MIN_LEVEL && logger_module_enabled(LOG_MODULE_ID, (level))) { \
+            logger_message((logger), (level), "[%s:%d] " format, __FILE__, __LINE__, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+/**
+ * @brief Macro for logging messages with structured fields.
+ *
+ * Filters by level like LOG. fields must be an array, not a pointer, since
+ * its length is taken with sizeof.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * log_field_t fields[] = {log_field_int("step", step), log_field_double("loss", loss)};
+ * LOG_FIELDS(my_logger, LOG_LEVEL_INFO, fields, "Epoch %d done\n", epoch);
+ * @endcode
+ */
+#define LOG_FIELDS(logger, level, fields, format, ...) \
+    do { \
+        if ((int) (level) >= (int) LOG_MIN_LEVEL && logger_module_enabled(LOG_MODULE_ID, (level))) { \
+            logger_fields_message( \
+                (logger), (level), (fields), sizeof(fields) / sizeof((fields)[0]), \
+                "[%s:%d] " format, __FILE__, __LINE__, ##__VA_ARGS__ \
+            ); \
+        } \
+    } while (0)
+
+/**
+ * @brief Macro for logging messages from a site only when allow is true.
+ *
+ * The building block of LOG_FIRST_N, LOG_EVERY_N and LOG_EVERY_MS. Filters
+ * by level like LOG, then evaluates allow, which may refer to the site's
+ * static log_limit_t as log_limit. Arguments of suppressed messages are never
+ * evaluated; the message is only counted, and the count is reported the next
+ * time the site logs or by the periodic summary.
+ */
+#define LOG_LIMITED(logger, level, allow, format, ...) \
+    do { \
+        if ((int) (level) >= (int) LOG_MIN_LEVEL && logger_module_enabled(LOG_MODULE_ID, (level))) { \
+            static log_limit_t log_limit = {__FILE__, __LINE__, 0, 0, 0, 0, 0, NULL, NULL}; \
+            if (allow) { \
+                logger_limit_report((logger), (level), &log_limit); \
+                logger_message((logger), (level), "[%s:%d] " format, __FILE__, __LINE__, ##__VA_ARGS__); \
+            } else { \
+                logger_limit_suppress((logger), (level), &log_limit); \
+            } \
+        } \
+    } while (0)
+
+/**
+ * @brief Logs only the first n messages of the call site.
+ */
+#define LOG_FIRST_N(logger, level, n, format, ...) \
+    LOG_LIMITED(logger, level, logger_limit_first(&log_limit, (n)), format, ##__VA_ARGS__)
+
+/**
+ * @brief Logs one in every k messages of the call site, starting with the first.
+ */
+#define LOG_EVERY_N(logger, level, k, format, ...) \
+    LOG_LIMITED(logger, level, logger_limit_every(&log_limit, (k)), format, ##__VA_ARGS__)
+
+/**
+ * @brief Logs at most one message of the call site per interval of milliseconds.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * LOG_EVERY_MS(my_logger, LOG_LEVEL_ERROR, 1000, "Bad value: %f\n", value);
+ * @endcode
+ */
+#define LOG_EVERY_MS(logger, level, interval, format, ...) \
+    LOG_LIMITED(logger, level, logger_limit_interval(&log_limit, (interval)), format, ##__VA_ARGS__)
+
+/**
+ * @brief Macro for logging messages in binary form with deferred formatting.
+ *
+ * Takes the same arguments as LOG and filters by level the same way. On a
+ * logger started with logger_start_binary, the message is recorded without
+ * being formatted; see logger_start_binary. On any other logger it is
+ * formatted and written like LOG. The format must be a string literal, and
+ * %s arguments are copied, so they need not outlive the call.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * LOG_BINARY(my_logger, LOG_LEVEL_DEBUG, "step %zu loss %f\n", step, loss);
+ * @endcode
+ */
+#define LOG_BINARY(logger, level, format, ...) \
+    do { \
+        if ((int) (level) >= (int) LOG_MIN_LEVEL && logger_module_enabled(LOG_MODULE_ID, (level))) { \
+            static log_site_t log_site = {format, __FILE__, __LINE__, 0, 0, {0}}; \
+            logger_binary_message((logger), (level), &log_site, ##__VA_ARGS__); \
+        } \
+    } while (0)
 
 /**
  * @brief Global Logger Object
@@ -211,4 +831,8 @@ void initialize_global_logger(
     const char* file_path
 );
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ALT_LOGGER_H
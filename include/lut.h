@@ -0,0 +1,67 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/lut.h
+ *
+ * @brief Lookup table evaluation of exp, sigmoid, tanh, and GELU
+ *
+ * Each function is sampled at LUT_MAX_SIZE evenly spaced points over
+ * [EXP_MIN, EXP_MAX] (see fixed.h) and evaluated by linear interpolation
+ * between neighbouring samples. Float and fixed16_t variants share the same
+ * sample points; the array variants use AVX2 gathers when available.
+ *
+ * Linear interpolation with spacing h is within h^2 / 8 * max|f''| of f over
+ * each interval. With h = LUT_STEP (~0.02) that is:
+ *   - exp:     relative error <= 5.3e-5 (f'' = f, growing e^(h/2) per step)
+ *   - sigmoid: absolute error <= 4.9e-6 (max|f''| ~ 0.096)
+ *   - tanh:    absolute error <= 3.9e-5 (max|f''| ~ 0.770)
+ *   - gelu:    absolute error <= 4.0e-5 (max|f''| ~ 0.798)
+ * The fixed16_t variants add up to 2^-16 of output quantization.
+ *
+ * Outside [EXP_MIN, EXP_MAX]:
+ *   - exp flushes to 0 below; above, the float variant falls back to expf()
+ *     and the fixed16_t variant saturates to FIXED_MAX
+ *   - sigmoid and tanh clamp to their end samples (error <= 4.6e-5)
+ *   - gelu returns 0 below and x above
+ *
+ * GELU uses the tanh approximation:
+ *   0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef ALT_LUT_H
+#define ALT_LUT_H
+
+#include "fixed.h"
+
+#include <stddef.h>
+
+// Distance between neighbouring samples, (EXP_MAX - EXP_MIN) / 999 ~ 0.02
+#define LUT_STEP ((float) (EXP_MAX - EXP_MIN) / (LUT_MAX_SIZE - 1))
+
+// Scalar evaluators
+float lut_exp(float x);
+float lut_sigmoid(float x);
+float lut_tanh(float x);
+float lut_gelu(float x);
+
+// Scalar evaluators in Q16.16
+fixed16_t lut_exp_fixed(fixed16_t x);
+fixed16_t lut_sigmoid_fixed(fixed16_t x);
+fixed16_t lut_tanh_fixed(fixed16_t x);
+fixed16_t lut_gelu_fixed(fixed16_t x);
+
+// Elementwise evaluators; src and dst may alias
+void lut_exp_array(const float* src, float* dst, size_t n);
+void lut_sigmoid_array(const float* src, float* dst, size_t n);
+void lut_tanh_array(const float* src, float* dst, size_t n);
+void lut_gelu_array(const float* src, float* dst, size_t n);
+
+// Elementwise evaluators in Q16.16; src and dst may alias
+void lut_exp_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n);
+void lut_sigmoid_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n);
+void lut_tanh_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n);
+void lut_gelu_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n);
+
+#endif // ALT_LUT_H
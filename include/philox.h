@@ -0,0 +1,67 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/philox.h
+ *
+ * @brief Philox-4x32-10 counter-based RNG in pure C
+ *
+ * Title: Parallel random numbers: as easy as 1, 2, 3
+ * Paper: https://dl.acm.org/doi/10.1145/2063384.2063405
+ * Source: https://github.com/DEShawResearch/random123
+ *
+ * Each 128-bit output block is a keyed bijection of a 128-bit counter, so
+ * the value at any position is computed directly instead of by walking a
+ * recurrence as Lehmer does. Threads and SIMD lanes that cover disjoint
+ * index ranges need no shared state and no coordination, and the result is
+ * bit-identical for any partitioning or thread count.
+ *
+ * A philox_key_t names one logical stream: the seed forms the 64-bit key and
+ * the stream fills the upper half of the counter. Word i of the stream is
+ * word i % 4 of the block at counter {i / 4, stream}.
+ */
+
+#ifndef ALT_PHILOX_H
+#define ALT_PHILOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PHILOX_ROUNDS     10         // Rounds recommended by the authors
+#define PHILOX_M0         0xD2511F53 // Round multipliers
+#define PHILOX_M1         0xCD9E8D57
+#define PHILOX_W0         0x9E3779B9 // Key schedule (golden ratio)
+#define PHILOX_W1         0xBB67AE85 // Key schedule (sqrt(3) - 1)
+#define PHILOX_BLOCK_SIZE 4          // 32-bit words per block
+
+typedef struct PhiloxKey {
+    uint32_t key[2];    // Seed words
+    uint32_t stream[2]; // Upper counter words; streams never overlap
+} philox_key_t;
+
+philox_key_t philox_create_key(uint64_t seed, uint64_t stream);
+
+// One raw block: out = Philox-4x32-10(counter, key)
+void philox_4x32_10(
+    const uint32_t counter[PHILOX_BLOCK_SIZE],
+    const uint32_t key[2],
+    uint32_t       out[PHILOX_BLOCK_SIZE]
+);
+
+// Word, uniform double in [0, 1) on a 2^-32 grid, and float in [0, 1) on a
+// 2^-23 grid (mantissa fill) at position index of the stream
+uint32_t philox_generate_bits(const philox_key_t* key, uint64_t index);
+double   philox_generate(const philox_key_t* key, uint64_t index);
+float    philox_generate_float(const philox_key_t* key, uint64_t index);
+
+// Positions [offset, offset + n) of the stream, identical to the scalar calls
+void philox_generate_batch_bits(
+    const philox_key_t* key, uint64_t offset, uint32_t* out, size_t n
+);
+void philox_generate_batch(
+    const philox_key_t* key, uint64_t offset, double* out, size_t n
+);
+void philox_generate_batch_float(
+    const philox_key_t* key, uint64_t offset, float* out, size_t n
+);
+
+#endif // ALT_PHILOX_H
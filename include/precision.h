@@ -6,8 +6,8 @@
  *
  * @brief A simple and easy-to-use API in C for handling various floating-point
  *        precisions, including 32-bit (float), 16-bit (half precision float:
- *        IEEE-754 & bfloat16), 16-bit Google Brain format, and extended 8-bit
- *        floats.
+ *        IEEE-754 & bfloat16), 16-bit Google Brain format, and 8-bit OCP
+ *        floats (E4M3 and E5M2).
  *
  * Only pure C is used with minimal dependencies on external libraries.
  *
@@ -21,6 +21,9 @@
  * @ref /usr/include/c10/util/half.h
  * @ref https://github.com/Maratyszcza/FP16
  * @ref https://github.com/pytorch/pytorch/blob/main/c10/util/Half.h
+ *
+ * @note 8-bit floating-point formats
+ * @ref https://www.opencompute.org/documents/ocp-8-bit-floating-point-specification-ofp8-revision-1-0-2023-12-01-pdf-1
  */
 
 #ifndef ALT_PRECISION_H
@@ -37,13 +40,14 @@
 
 // Enumeration of data types
 typedef enum {
-    TYPE_FLOAT_F32,  // IEEE-754 32-bit precision
-    TYPE_FLOAT_F16,  // IEEE-754 16-bit precision
-    TYPE_FLOAT_BF16, // Google Brain bfloat16 precision
-    TYPE_FLOAT_F8,   // Extended 8-bit precision
-    TYPE_QUANT_K8,   // k-bit precision
-    TYPE_QUANT_K4,   // k-bit precision
-    TYPE_MAX_COUNT,  // Number of data types
+    TYPE_FLOAT_F32,     // IEEE-754 32-bit precision
+    TYPE_FLOAT_F16,     // IEEE-754 16-bit precision
+    TYPE_FLOAT_BF16,    // Google Brain bfloat16 precision
+    TYPE_FLOAT_F8,      // OCP 8-bit E4M3 precision
+    TYPE_FLOAT_F8_E5M2, // OCP 8-bit E5M2 precision
+    TYPE_QUANT_K8,      // k-bit precision
+    TYPE_QUANT_K4,      // k-bit precision
+    TYPE_MAX_COUNT,     // Number of data types
 } data_type_t;
 
 // Data types for different precisions
@@ -86,13 +90,13 @@ typedef struct float_flex_t {
  *
  * @param[in]   a       The first floating-point value.
  * @param[in]   b       The second floating-point value.
- * @param[in]   tolerance Tolerance for comparing values (default:
- * FLOAT_TOLERANCE).
+ * @param[in]   significand Number of significant decimal digits used to derive
+ * the minimum tolerance, e.g. 4 -> 1e-4.
  *
  * @return true if the absolute difference between 'a' and 'b' is within the
  * tolerance bounds, false otherwise.
  */
-bool float_is_close(float a, float b, float tolerance);
+bool float_is_close(double a, double b, int64_t significand);
 
 /**
  * @brief Encodes a given float value into its corresponding 32-bit
@@ -140,6 +144,90 @@ float16_t encode_float16(float value);
  */
 float decode_float16(float16_t bits);
 
+/**
+ * @brief Decode paths for bulk 16-bit conversions
+ *
+ * - PRECISION_DECODE_AUTO: choose per call from the workload size, the cache
+ *   size, and any calibration result.
+ * - PRECISION_DECODE_ARITHMETIC: bit manipulation, no memory footprint.
+ * - PRECISION_DECODE_LUT: a 65536-entry (256 KiB) table covering every
+ *   float16_t value; one load per element.
+ * - PRECISION_DECODE_F16C: hardware conversion (requires F16C at compile time).
+ */
+typedef enum {
+    PRECISION_DECODE_AUTO,       // Heuristic selection
+    PRECISION_DECODE_ARITHMETIC, // Branch-free arithmetic decode
+    PRECISION_DECODE_LUT,        // 64K-entry lookup table
+    PRECISION_DECODE_F16C,       // x86 F16C hardware conversion
+} precision_decode_path_t;
+
+// Size of the float16_t decode table in bytes
+#define FLOAT16_LUT_BYTES        (65536 * sizeof(float))
+// Minimum number of elements before AUTO considers the lookup table
+#define FLOAT16_LUT_MIN_ELEMENTS 16384
+
+/**
+ * @brief Decodes a given 16-bit integer representation into its corresponding
+ * float value using the 64K-entry lookup table.
+ *
+ * The table is generated at compile time and lives in read-only data (see
+ * tables.h), so there is no first-use cost.
+ *
+ * @param[in] bits The encoded 16-bit integer bit representation of the
+ * floating-point number.
+ *
+ * @return The decoded 32-bit floating-point value, identical to
+ * decode_float16().
+ */
+float decode_float16_lut(float16_t bits);
+
+/**
+ * @brief Decodes an array of IEEE-754 half precision values.
+ *
+ * The decode path is chosen once per call, not per element.
+ *
+ * @param[in]  src The source array.
+ * @param[out] dst The destination array; must hold n elements.
+ * @param[in]  n   The number of elements to convert.
+ */
+void decode_float16_array(const float16_t* src, float* dst, size_t n);
+
+/**
+ * @brief Decodes an array of half precision values with a specific path.
+ *
+ * PRECISION_DECODE_F16C falls back to the arithmetic path when F16C support
+ * was not compiled in.
+ */
+void decode_float16_array_path(
+    const float16_t* src, float* dst, size_t n, precision_decode_path_t path
+);
+
+/**
+ * @brief Pins the path used by decode_float16_array().
+ *
+ * @param[in] path The path to use; PRECISION_DECODE_AUTO restores the
+ * heuristic.
+ */
+void float16_set_decode_path(precision_decode_path_t path);
+
+/**
+ * @brief Returns the path decode_float16_array() would use for n elements.
+ */
+precision_decode_path_t float16_get_decode_path(size_t n);
+
+/**
+ * @brief Benchmarks the arithmetic and lookup table decoders on a workload of
+ * n elements and pins the faster path.
+ *
+ * Hardware conversion always wins when F16C support was compiled in, so no
+ * measurement is done in that case.
+ *
+ * @param[in] n The representative number of elements per call.
+ *
+ * @return The selected path.
+ */
+precision_decode_path_t float16_calibrate_decode(size_t n);
+
 /**
  * @brief Encodes a given float value into its corresponding Google Brain
  * bfloat16 representation (half precision).
@@ -164,9 +252,112 @@ bfloat16_t encode_bfloat16(float value);
  */
 float decode_bfloat16(bfloat16_t bits);
 
+/**
+ * @brief Encodes an array of floats into IEEE-754 half precision values.
+ *
+ * Uses F16C hardware conversion when compiled in.
+ *
+ * @param[in]  src The source array.
+ * @param[out] dst The destination array; must hold n elements.
+ * @param[in]  n   The number of elements to convert.
+ */
+void encode_float16_array(const float* src, float16_t* dst, size_t n);
+
+/**
+ * @brief Encodes an array of floats into bfloat16 values with round to
+ * nearest even.
+ *
+ * @param[in]  src The source array.
+ * @param[out] dst The destination array; must hold n elements.
+ * @param[in]  n   The number of elements to convert.
+ */
+void encode_bfloat16_array(const float* src, bfloat16_t* dst, size_t n);
+
+/**
+ * @brief Decodes an array of bfloat16 values.
+ *
+ * bfloat16 is the upper half of a binary32, so decoding is a shift and no
+ * lookup table is needed. Subnormals flush to zero as in decode_bfloat16().
+ *
+ * @param[in]  src The source array.
+ * @param[out] dst The destination array; must hold n elements.
+ * @param[in]  n   The number of elements to convert.
+ */
+void decode_bfloat16_array(const bfloat16_t* src, float* dst, size_t n);
+
+/**
+ * @brief 8-bit floating-point formats
+ *
+ * Both formats follow the OCP 8-bit Floating Point Specification (OFP8).
+ *
+ * - E4M3: 1 sign bit, 4 exponent bits (bias 7), 3 mantissa bits. There are no
+ *   infinities and a single NaN encoding per sign (S.1111.111). The largest
+ *   finite magnitude is 448.
+ * - E5M2: 1 sign bit, 5 exponent bits (bias 15), 2 mantissa bits. This is the
+ *   IEEE-754 layout truncated to 8 bits, so infinities (S.11111.00) and NaNs
+ *   (S.11111.{01,10,11}) exist. The largest finite magnitude is 57344.
+ *
+ * Encoding rounds to nearest even and saturates: finite values and infinities
+ * beyond the largest finite magnitude clamp to it, while NaN stays NaN.
+ * Decoding reads a 256-entry lookup table generated at compile time.
+ */
+
+// Largest finite E4M3 encoding (448.0f)
+#define FLOAT8_E4M3_MAX 0x7E
+// Quiet NaN E4M3 encoding
+#define FLOAT8_E4M3_NAN 0x7F
+// Largest finite E5M2 encoding (57344.0f)
+#define FLOAT8_E5M2_MAX 0x7B
+// Quiet NaN E5M2 encoding
+#define FLOAT8_E5M2_NAN 0x7E
+
+/**
+ * @brief Encodes a given float value into its corresponding 8-bit E4M3
+ * representation.
+ *
+ * @param[in] value The floating point number to be encoded.
+ *
+ * @return The resulting encoded 8-bit integer representation of the input
+ * value, rounded to nearest even and saturated to +/-448.
+ */
+float8_t encode_float8_e4m3(float value);
+
+/**
+ * @brief Decodes a given 8-bit E4M3 representation into its corresponding
+ * float value.
+ *
+ * @param[in] bits The encoded 8-bit bit representation of the floating-point
+ * number.
+ *
+ * @return The decoded 32-bit floating-point value.
+ */
+float decode_float8_e4m3(float8_t bits);
+
+/**
+ * @brief Encodes a given float value into its corresponding 8-bit E5M2
+ * representation.
+ *
+ * @param[in] value The floating point number to be encoded.
+ *
+ * @return The resulting encoded 8-bit integer representation of the input
+ * value, rounded to nearest even and saturated to +/-57344.
+ */
+float8_t encode_float8_e5m2(float value);
+
+/**
+ * @brief Decodes a given 8-bit E5M2 representation into its corresponding
+ * float value.
+ *
+ * @param[in] bits The encoded 8-bit bit representation of the floating-point
+ * number.
+ *
+ * @return The decoded 32-bit floating-point value.
+ */
+float decode_float8_e5m2(float8_t bits);
+
 /**
  * @brief Encodes a given float value into its corresponding 8-bit
- * representation (Extended 8-bit floating point).
+ * representation (OCP E4M3).
  *
  * @param[in] value The floating point number to be encoded.
  *
@@ -177,14 +368,69 @@ float8_t encode_float8(float value);
 
 /**
  * @brief Decodes a given 8-bit integer representation into its corresponding
- * float value (Extended 8-bit floating point).
+ * float value (OCP E4M3).
  *
  * @param[in] bits The encoded 8-bit bit representation of the floating-point
  * number.
  *
- * @return The decoded actual extended 8-bit floating-point value represented by
- * this data structure.
+ * @return The decoded 32-bit floating-point value.
  */
 float decode_float8(float8_t bits);
 
+/**
+ * @brief Bulk 8-bit conversions
+ *
+ * These functions convert contiguous arrays between 32-bit floats and 8-bit
+ * floats. Decoding gathers from the 256-entry lookup table (AVX2 when
+ * available) and encoding is written branch-free so it vectorizes.
+ *
+ * @param[in]  src The source array.
+ * @param[out] dst The destination array; must hold n elements.
+ * @param[in]  n   The number of elements to convert.
+ */
+void encode_float8_e4m3_array(const float* src, float8_t* dst, size_t n);
+void decode_float8_e4m3_array(const float8_t* src, float* dst, size_t n);
+void encode_float8_e5m2_array(const float* src, float8_t* dst, size_t n);
+void decode_float8_e5m2_array(const float8_t* src, float* dst, size_t n);
+
+/**
+ * @brief Stochastic rounding
+ *
+ * Round-to-nearest discards any update smaller than half a step, so small
+ * gradients never reach low precision weights. Stochastic rounding rounds up
+ * with probability equal to the discarded fraction of a step, which makes the
+ * rounded value unbiased: E[decode(encode(x))] == x.
+ *
+ * The scalar variants take the random bits explicitly; only the low bits
+ * that are discarded by the format are used (16 for bfloat16, up to 31 for
+ * 8-bit floats). NaN and saturation behave as in the round-to-nearest
+ * encoders, and bfloat16 subnormals flush to zero.
+ *
+ * The array variants draw random bits from PRECISION_RANDOM_LANES consecutive
+ * streams of the given state, starting at the selected stream, and advance
+ * the lanes in lockstep so the generator vectorizes. The state is not locked:
+ * give each thread its own lehmer_state_t (or disjoint streams). A state
+ * with no streams supplies zero bits, so every value rounds toward zero.
+ */
+
+// Number of Lehmer streams advanced in lockstep by the array variants
+#define PRECISION_RANDOM_LANES 8
+
+// Defined in lehmer.h
+struct LehmerState;
+
+bfloat16_t encode_bfloat16_stochastic(float value, uint32_t random);
+float8_t   encode_float8_e4m3_stochastic(float value, uint32_t random);
+float8_t   encode_float8_e5m2_stochastic(float value, uint32_t random);
+
+void encode_bfloat16_stochastic_array(
+    const float* src, bfloat16_t* dst, size_t n, struct LehmerState* state
+);
+void encode_float8_e4m3_stochastic_array(
+    const float* src, float8_t* dst, size_t n, struct LehmerState* state
+);
+void encode_float8_e5m2_stochastic_array(
+    const float* src, float8_t* dst, size_t n, struct LehmerState* state
+);
+
 #endif // ALT_PRECISION_H
@@ -0,0 +1,69 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/tables.h
+ *
+ * @brief C accessors for lookup tables generated at compile time
+ *
+ * The tables live in read-only data built by source/tables.cpp from the
+ * constexpr generators in tables.hpp; every accessor returns a pointer to
+ * immutable storage and never fails. Decode tables hold IEEE-754 single
+ * precision bit patterns rather than floats so NaN payloads are exact; use
+ * decode_float32() or an integer gather to read them.
+ *
+ * Build: compile source/tables.cpp with a C++17 compiler and link the object
+ * with the C sources. It needs no C++ runtime library.
+ */
+
+#ifndef ALT_TABLES_H
+#define ALT_TABLES_H
+
+#include "fixed.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of samples over one period of the sin and cos tables
+#define TABLE_TRIG_SIZE 1024
+
+// Ziggurat strips, bits of the strip position, and the start of the tail
+#define TABLE_ZIGGURAT_SIZE 128
+#define TABLE_ZIGGURAT_BITS 23
+#define TABLE_ZIGGURAT_R    3.442619855899
+
+// Single precision bits for every half precision encoding (65536 entries)
+const uint32_t* table_float16_decode(void);
+
+// Single precision bits for every OCP 8-bit encoding (256 entries each)
+const uint32_t* table_float8_e4m3_decode(void);
+const uint32_t* table_float8_e5m2_decode(void);
+
+// Activation samples at LUT_MAX_SIZE points over [EXP_MIN, EXP_MAX]
+const float* table_exp(void);
+const float* table_sigmoid(void);
+const float* table_tanh(void);
+const float* table_gelu(void);
+
+// The same samples rounded to Q16.16
+const fixed16_t* table_exp_fixed(void);
+const fixed16_t* table_sigmoid_fixed(void);
+const fixed16_t* table_tanh_fixed(void);
+const fixed16_t* table_gelu_fixed(void);
+
+// sin and cos at 2 pi * i / TABLE_TRIG_SIZE for i < TABLE_TRIG_SIZE
+const float* table_sin(void);
+const float* table_cos(void);
+
+// Standard normal ziggurat (TABLE_ZIGGURAT_SIZE entries each, see tables.hpp)
+const uint32_t* table_ziggurat_k(void);
+const double*   table_ziggurat_w(void);
+const double*   table_ziggurat_f(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALT_TABLES_H
@@ -0,0 +1,323 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/tables.hpp
+ *
+ * @brief Compile-time generation of lookup tables
+ *
+ * Every table is produced by a constexpr generator and stored in a constexpr
+ * variable, so the compiler emits it into read-only data. Nothing is computed
+ * at startup, and processes mapping the same binary share the pages.
+ *
+ * The standard math functions are not constexpr in C++17, so exp, sin and
+ * cos are evaluated here with range reduction and Taylor series in double
+ * precision, accurate to a few double ulp, before rounding to the storage
+ * type.
+ *
+ * C code reaches the tables through the accessors declared in tables.h.
+ */
+
+#ifndef ALT_TABLES_HPP
+#define ALT_TABLES_HPP
+
+#include "fixed.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tables {
+
+/**
+ * @brief Table container and generator
+ */
+
+template <typename T, std::size_t N>
+struct Table {
+    T values[N];
+
+    constexpr const T& operator[](std::size_t i) const {
+        return values[i];
+    }
+};
+
+// table[i] = generator(i) for every i, evaluated at compile time
+template <typename T, std::size_t N, typename Generator>
+constexpr Table<T, N> generate(Generator generator) {
+    Table<T, N> table{};
+    for (std::size_t i = 0; i < N; i++) {
+        table.values[i] = generator(i);
+    }
+    return table;
+}
+
+/**
+ * @brief constexpr math
+ */
+
+constexpr double PI         = 3.14159265358979323846;
+constexpr double LN2_HI     = 6.93147180369123816490e-01; // exact in 32 bits
+constexpr double LN2_LO     = 1.90821492927058770002e-10;
+constexpr double SQRT_2_PI  = 0.79788456080286535588; // sqrt(2 / pi)
+constexpr double GELU_CUBIC = 0.044715;
+
+constexpr double power_of_two(int exponent) {
+    double result = 1.0;
+    for (; exponent > 0; exponent--) {
+        result *= 2.0;
+    }
+    for (; exponent < 0; exponent++) {
+        result *= 0.5;
+    }
+    return result;
+}
+
+// exp(x) = 2^k * exp(r) with |r| <= ln(2) / 2
+constexpr double exp(double x) {
+    double k = static_cast<double>(
+        static_cast<long long>(x / (LN2_HI + LN2_LO) + (x < 0 ? -0.5 : 0.5))
+    );
+    double r = (x - k * LN2_HI) - k * LN2_LO;
+
+    // Horner form of the Taylor series; 1/20! r^20 is far below 2^-53
+    double sum = 1.0;
+    for (int n = 20; n > 0; n--) {
+        sum = 1.0 + sum * r / n;
+    }
+    return sum * power_of_two(static_cast<int>(k));
+}
+
+constexpr double tanh(double x) {
+    double e = exp(2.0 * x);
+    return (e - 1.0) / (e + 1.0);
+}
+
+constexpr double sigmoid(double x) {
+    return 1.0 / (1.0 + exp(-x));
+}
+
+// 0.5 * (1 + tanh(u)) == 1 / (1 + exp(-2u)) avoids cancellation for x << 0
+constexpr double gelu(double x) {
+    return x / (1.0 + exp(-2.0 * SQRT_2_PI * (x + GELU_CUBIC * x * x * x)));
+}
+
+// Reduce to [-pi, pi], then sum the series; 1/31! pi^31 is below 2^-53
+constexpr double sin(double x) {
+    x -= 2.0 * PI * static_cast<double>(
+        static_cast<long long>(x / (2.0 * PI) + (x < 0 ? -0.5 : 0.5))
+    );
+
+    double term = x;
+    double sum  = x;
+    for (int n = 1; n < 16; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum  += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) {
+    return sin(x + PI / 2.0);
+}
+
+// Newton-Raphson for x > 0; converges from above once past the first step
+constexpr double sqrt(double x) {
+    double root = x > 1.0 ? x : 1.0;
+    for (int n = 0; n < 1024; n++) {
+        double next = 0.5 * (root + x / root);
+        if (next >= root) {
+            break;
+        }
+        root = next;
+    }
+    return root;
+}
+
+// log(x) = e * ln(2) + 2 atanh(s) with x = m * 2^e, s = (m - 1) / (m + 1)
+constexpr double log(double x) {
+    int exponent = 0;
+    for (; x > 1.4142135623730951; exponent++) {
+        x *= 0.5;
+    }
+    for (; x < 0.7071067811865476; exponent--) {
+        x *= 2.0;
+    }
+
+    // |s| <= 0.172, so s^2 shrinks each term by at least 34x
+    double s    = (x - 1.0) / (x + 1.0);
+    double term = s;
+    double sum  = 0.0;
+    for (int n = 1; n < 40; n += 2) {
+        sum  += term / n;
+        term *= s * s;
+    }
+    return exponent * (LN2_HI + LN2_LO) + 2.0 * sum;
+}
+
+/**
+ * @brief Storage conversions
+ */
+
+// Round half away from zero and saturate into Q16.16
+constexpr fixed16_t to_fixed(double x) {
+    double scaled = x * FIXED_VAL;
+    if (scaled >= static_cast<double>(FIXED_MAX)) {
+        return FIXED_MAX;
+    }
+    if (scaled <= static_cast<double>(FIXED_MIN)) {
+        return FIXED_MIN;
+    }
+    return static_cast<fixed16_t>(scaled + (scaled < 0 ? -0.5 : 0.5));
+}
+
+/*
+ * IEEE-754 half to single precision, as bits so NaN payloads survive. NaNs
+ * come out quiet, matching the arithmetic decoder and F16C.
+ */
+constexpr std::uint32_t float16_decode_bits(std::size_t index) {
+    const std::uint32_t half     = static_cast<std::uint32_t>(index);
+    const std::uint32_t sign     = (half & 0x8000u) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    std::uint32_t       mantissa = half & 0x3FFu;
+
+    if (0x1Fu == exponent) {
+        return sign | 0x7F800000u | (mantissa << 13)
+               | (mantissa ? 0x00400000u : 0u);
+    }
+    if (0 != exponent) {
+        return sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+    if (0 == mantissa) {
+        return sign;
+    }
+
+    // Subnormal: shift the leading one into the implicit bit position
+    std::uint32_t biased = 113u;
+    while (0 == (mantissa & 0x400u)) {
+        mantissa <<= 1;
+        biased--;
+    }
+    return sign | (biased << 23) | ((mantissa & 0x3FFu) << 13);
+}
+
+/*
+ * OCP 8-bit float to single precision bits. E5M2 (ieee) reserves the top
+ * exponent for infinities and NaNs; E4M3 only reserves S.1111.111 for NaN.
+ */
+constexpr std::uint32_t float8_decode_bits(
+    std::size_t index, std::uint32_t mantissa, int bias, bool ieee
+) {
+    const std::uint32_t bits     = static_cast<std::uint32_t>(index);
+    const std::uint32_t sign     = (bits & 0x80u) << 24;
+    const std::uint32_t exponent = (bits & 0x7Fu) >> mantissa;
+    std::uint32_t       fraction = bits & ((1u << mantissa) - 1);
+
+    if (ieee && exponent == (0x7Fu >> mantissa)) {
+        return sign | (fraction ? 0x7FC00000u : 0x7F800000u);
+    }
+    if (!ieee && 0x7Fu == (bits & 0x7Fu)) {
+        return sign | 0x7FC00000u;
+    }
+    if (0 == exponent && 0 == fraction) {
+        return sign;
+    }
+
+    int biased = static_cast<int>(exponent) - bias + 127;
+    if (0 == exponent) {
+        // Subnormal: normalize into the implicit bit
+        biased = 1 - bias + 127;
+        while (0 == (fraction & (1u << mantissa))) {
+            fraction <<= 1;
+            biased--;
+        }
+        fraction &= (1u << mantissa) - 1;
+    }
+    return sign | (static_cast<std::uint32_t>(biased) << 23)
+           | (fraction << (23 - mantissa));
+}
+
+/**
+ * @brief Activation tables over [EXP_MIN, EXP_MAX] (see fixed.h and lut.h)
+ */
+
+constexpr double lut_input(std::size_t i) {
+    return EXP_MIN
+           + static_cast<double>(i) * (EXP_MAX - EXP_MIN) / (LUT_MAX_SIZE - 1);
+}
+
+template <typename Function>
+constexpr Table<float, LUT_MAX_SIZE> lut_float(Function function) {
+    return generate<float, LUT_MAX_SIZE>([function](std::size_t i) {
+        return static_cast<float>(function(lut_input(i)));
+    });
+}
+
+template <typename Function>
+constexpr Table<fixed16_t, LUT_MAX_SIZE> lut_fixed(Function function) {
+    return generate<fixed16_t, LUT_MAX_SIZE>([function](std::size_t i) {
+        return to_fixed(function(lut_input(i)));
+    });
+}
+
+/**
+ * @brief Trigonometric tables over one period [0, 2 pi)
+ */
+
+constexpr std::size_t TRIG_SIZE = 1024; // keep in sync with TABLE_TRIG_SIZE
+
+constexpr double trig_input(std::size_t i) {
+    return 2.0 * PI * static_cast<double>(i) / TRIG_SIZE;
+}
+
+/**
+ * @brief Ziggurat for the standard normal distribution
+ *
+ * Marsaglia and Tsang, "The Ziggurat Method for Generating Random Variables"
+ * (2000): ZIGGURAT_SIZE strips of equal area ZIGGURAT_V cover the half
+ * density, the base strip includes the tail beyond ZIGGURAT_R. A sample
+ * draws a strip i and a ZIGGURAT_BITS-bit integer j, and x = j * w[i] is
+ * accepted immediately when j < k[i]; f[i] bounds the wedge test otherwise.
+ */
+
+constexpr std::size_t ZIGGURAT_SIZE = 128; // keep in sync with tables.h
+constexpr int         ZIGGURAT_BITS = 23;
+constexpr double      ZIGGURAT_R    = 3.442619855899;
+constexpr double      ZIGGURAT_V    = 9.91256303526217e-3;
+
+struct Ziggurat {
+    std::uint32_t k[ZIGGURAT_SIZE]; // acceptance bounds on j
+    double        w[ZIGGURAT_SIZE]; // x of the strip edge / 2^ZIGGURAT_BITS
+    double        f[ZIGGURAT_SIZE]; // density at the strip edge
+};
+
+constexpr double normal_density(double x) {
+    return exp(-0.5 * x * x);
+}
+
+// Strip edges walk inward from ZIGGURAT_R, each strip holding area V
+constexpr Ziggurat ziggurat() {
+    const double scale = power_of_two(ZIGGURAT_BITS);
+    const double q     = ZIGGURAT_V / normal_density(ZIGGURAT_R);
+
+    Ziggurat table{};
+    table.k[0] = static_cast<std::uint32_t>(ZIGGURAT_R / q * scale);
+    table.k[1] = 0;
+    table.w[0]                 = q / scale;
+    table.w[ZIGGURAT_SIZE - 1] = ZIGGURAT_R / scale;
+    table.f[0]                 = 1.0;
+    table.f[ZIGGURAT_SIZE - 1] = normal_density(ZIGGURAT_R);
+
+    double outer = ZIGGURAT_R;
+    for (std::size_t i = ZIGGURAT_SIZE - 2; i > 0; i--) {
+        double inner
+            = sqrt(-2.0 * log(ZIGGURAT_V / outer + normal_density(outer)));
+        table.k[i + 1] = static_cast<std::uint32_t>(inner / outer * scale);
+        table.w[i]     = inner / scale;
+        table.f[i]     = normal_density(inner);
+        outer          = inner;
+    }
+    return table;
+}
+
+} // namespace tables
+
+#endif // ALT_TABLES_HPP
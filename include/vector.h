@@ -20,6 +20,10 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Vector lifecycle management
 
 /**
@@ -325,4 +329,8 @@ vector_t* vector_polar_to_cartesian(const vector_t* polar_vector);
  */
 vector_t* vector_cartesian_to_polar(const vector_t* cartesian_vector);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ALT_VECTOR_H
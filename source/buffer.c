@@ -0,0 +1,520 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file source/buffer.c
+ *
+ * @brief Type-tagged buffers for mixed precision storage
+ *
+ * A buffer stores many elements of a single data type as raw, aligned bytes.
+ * Every public function switches on the type tag once and then runs a loop
+ * specialized for that type.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#define LOG_MODULE_ID LOG_MODULE_BUFFER
+
+#include "../include/buffer.h"
+#include "../include/logger.h"
+
+#include <math.h>
+#include <string.h>
+
+// Number of elements decoded onto the stack at a time by blockwise kernels
+#define BUFFER_CHUNK_SIZE 256
+
+// Number of independent accumulators; lets the compiler vectorize reductions
+#define BUFFER_LANES      8
+
+const char* buffer_type_name(data_type_t type) {
+    switch (type) {
+        case TYPE_FLOAT_F32:
+            return "f32";
+        case TYPE_FLOAT_F16:
+            return "f16";
+        case TYPE_FLOAT_BF16:
+            return "bf16";
+        case TYPE_FLOAT_F8:
+            return "f8_e4m3";
+        case TYPE_FLOAT_F8_E5M2:
+            return "f8_e5m2";
+        case TYPE_QUANT_K8:
+            return "q8";
+        case TYPE_QUANT_K4:
+            return "q4";
+        default:
+            return "unknown";
+    }
+}
+
+static size_t buffer_blocks(size_t count) {
+    return (count + BUFFER_BLOCK_SIZE - 1) / BUFFER_BLOCK_SIZE;
+}
+
+size_t buffer_type_size(data_type_t type, size_t count) {
+    switch (type) {
+        case TYPE_FLOAT_F32:
+            return count * sizeof(float);
+        case TYPE_FLOAT_F16:
+            return count * sizeof(float16_t);
+        case TYPE_FLOAT_BF16:
+            return count * sizeof(bfloat16_t);
+        case TYPE_FLOAT_F8:
+        case TYPE_FLOAT_F8_E5M2:
+            return count * sizeof(float8_t);
+        case TYPE_QUANT_K8:
+            return buffer_blocks(count) * sizeof(block_q8_t);
+        case TYPE_QUANT_K4:
+            return buffer_blocks(count) * sizeof(block_q4_t);
+        default:
+            return 0;
+    }
+}
+
+buffer_t* buffer_create(data_type_t type, size_t count) {
+    size_t size = buffer_type_size(type, count);
+    if (0 == size && count > 0) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "Invalid data type %d for struct Buffer.\n",
+            type);
+        return NULL;
+    }
+
+    buffer_t* buffer = (buffer_t*) malloc(sizeof(buffer_t));
+    if (NULL == buffer) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "Failed to allocate %zu bytes to struct Buffer.\n",
+            sizeof(buffer_t));
+        return NULL;
+    }
+
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size_t capacity = (size + BUFFER_ALIGNMENT - 1)
+                      & ~(size_t) (BUFFER_ALIGNMENT - 1);
+    if (0 == capacity) {
+        capacity = BUFFER_ALIGNMENT;
+    }
+
+    buffer->data = aligned_alloc(BUFFER_ALIGNMENT, capacity);
+    if (NULL == buffer->data) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "Failed to allocate %zu bytes to buffer->data.\n",
+            capacity);
+        free(buffer);
+        return NULL;
+    }
+
+    // Zero the padding as well so quantized tail blocks are well defined
+    memset(buffer->data, 0, capacity);
+
+    buffer->type  = type;
+    buffer->count = count;
+    buffer->size  = size;
+
+    return buffer;
+}
+
+void buffer_free(buffer_t* buffer) {
+    if (NULL == buffer) {
+        return;
+    }
+
+    free(buffer->data);
+    free(buffer);
+}
+
+/**
+ * @brief Quantized block kernels
+ *
+ * Scales are rounded to half precision before the quants are computed so that
+ * encoding and decoding use exactly the same scale. A scale is rounded up, so
+ * the largest value of a block never needs more than the widest quant, and
+ * held to the finite half range; blocks beyond it saturate.
+ */
+
+// Largest finite half precision value, 65504
+#define BUFFER_SCALE_MAX 0x7BFF
+
+static float buffer_block_absmax(const float* src, size_t n) {
+    float absmax = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float value = fabsf(src[i]);
+        absmax      = value > absmax ? value : absmax;
+    }
+    return absmax;
+}
+
+// Smallest finite half precision scale with absmax / scale <= levels
+static float16_t buffer_block_scale(float absmax, float levels) {
+    float target = absmax / levels;
+    if (!(target > 0.0f)) {
+        return 0;
+    }
+
+    float16_t bits = encode_float16(target);
+    if (bits >= BUFFER_SCALE_MAX) {
+        return BUFFER_SCALE_MAX;
+    }
+    // Positive halves order like their bits, so the next value up is bits + 1
+    return decode_float16(bits) < target ? (float16_t) (bits + 1) : bits;
+}
+
+static void quantize_q8(const float* src, block_q8_t* blocks, size_t count) {
+    for (size_t b = 0; b < buffer_blocks(count); b++) {
+        const float* x = src + b * BUFFER_BLOCK_SIZE;
+        size_t       n = count - b * BUFFER_BLOCK_SIZE;
+        n              = n < BUFFER_BLOCK_SIZE ? n : BUFFER_BLOCK_SIZE;
+
+        blocks[b].scale = buffer_block_scale(buffer_block_absmax(x, n), 127.0f);
+        float scale     = decode_float16(blocks[b].scale);
+        float inverse   = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+        for (size_t i = 0; i < BUFFER_BLOCK_SIZE; i++) {
+            long quant          = i < n ? lrintf(x[i] * inverse) : 0;
+            quant               = quant < -127 ? -127 : quant;
+            blocks[b].quants[i] = (int8_t) (quant > 127 ? 127 : quant);
+        }
+    }
+}
+
+static void dequantize_q8(const block_q8_t* blocks, float* dst, size_t count) {
+    for (size_t b = 0; b < buffer_blocks(count); b++) {
+        float* y = dst + b * BUFFER_BLOCK_SIZE;
+        size_t n = count - b * BUFFER_BLOCK_SIZE;
+        n        = n < BUFFER_BLOCK_SIZE ? n : BUFFER_BLOCK_SIZE;
+
+        float scale = decode_float16(blocks[b].scale);
+        for (size_t i = 0; i < n; i++) {
+            y[i] = scale * (float) blocks[b].quants[i];
+        }
+    }
+}
+
+static void quantize_q4(const float* src, block_q4_t* blocks, size_t count) {
+    for (size_t b = 0; b < buffer_blocks(count); b++) {
+        const float* x = src + b * BUFFER_BLOCK_SIZE;
+        size_t       n = count - b * BUFFER_BLOCK_SIZE;
+        n              = n < BUFFER_BLOCK_SIZE ? n : BUFFER_BLOCK_SIZE;
+
+        blocks[b].scale = buffer_block_scale(buffer_block_absmax(x, n), 7.0f);
+        float scale     = decode_float16(blocks[b].scale);
+        float inverse   = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+        for (size_t i = 0; i < BUFFER_BLOCK_SIZE; i += 2) {
+            long lo = i < n ? lrintf(x[i] * inverse) : 0;
+            long hi = i + 1 < n ? lrintf(x[i + 1] * inverse) : 0;
+            lo      = (lo < -8 ? -8 : lo > 7 ? 7 : lo) + 8;
+            hi      = (hi < -8 ? -8 : hi > 7 ? 7 : hi) + 8;
+            blocks[b].quants[i / 2] = (uint8_t) (lo | (hi << 4));
+        }
+    }
+}
+
+static void dequantize_q4(const block_q4_t* blocks, float* dst, size_t count) {
+    for (size_t b = 0; b < buffer_blocks(count); b++) {
+        float* y = dst + b * BUFFER_BLOCK_SIZE;
+        size_t n = count - b * BUFFER_BLOCK_SIZE;
+        n        = n < BUFFER_BLOCK_SIZE ? n : BUFFER_BLOCK_SIZE;
+
+        float scale = decode_float16(blocks[b].scale);
+        for (size_t i = 0; i < n; i++) {
+            uint8_t packed = blocks[b].quants[i / 2];
+            int     quant  = (i & 1) ? (packed >> 4) : (packed & 0x0F);
+            y[i]           = scale * (float) (quant - 8);
+        }
+    }
+}
+
+bool buffer_from_float(buffer_t* buffer, const float* src) {
+    const size_t n = buffer->count;
+
+    switch (buffer->type) {
+        case TYPE_FLOAT_F32:
+            memcpy(buffer->data, src, n * sizeof(float));
+            return true;
+        case TYPE_FLOAT_F16:
+            encode_float16_array(src, (float16_t*) buffer->data, n);
+            return true;
+        case TYPE_FLOAT_BF16:
+            encode_bfloat16_array(src, (bfloat16_t*) buffer->data, n);
+            return true;
+        case TYPE_FLOAT_F8:
+            encode_float8_e4m3_array(src, (float8_t*) buffer->data, n);
+            return true;
+        case TYPE_FLOAT_F8_E5M2:
+            encode_float8_e5m2_array(src, (float8_t*) buffer->data, n);
+            return true;
+        case TYPE_QUANT_K8:
+            quantize_q8(src, (block_q8_t*) buffer->data, n);
+            return true;
+        case TYPE_QUANT_K4:
+            quantize_q4(src, (block_q4_t*) buffer->data, n);
+            return true;
+        default:
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "Cannot encode to unsupported data type %d.\n",
+                buffer->type);
+            return false;
+    }
+}
+
+bool buffer_to_float(const buffer_t* buffer, float* dst) {
+    const size_t n = buffer->count;
+
+    switch (buffer->type) {
+        case TYPE_FLOAT_F32:
+            memcpy(dst, buffer->data, n * sizeof(float));
+            return true;
+        case TYPE_FLOAT_F16:
+            decode_float16_array((const float16_t*) buffer->data, dst, n);
+            return true;
+        case TYPE_FLOAT_BF16:
+            decode_bfloat16_array((const bfloat16_t*) buffer->data, dst, n);
+            return true;
+        case TYPE_FLOAT_F8:
+            decode_float8_e4m3_array((const float8_t*) buffer->data, dst, n);
+            return true;
+        case TYPE_FLOAT_F8_E5M2:
+            decode_float8_e5m2_array((const float8_t*) buffer->data, dst, n);
+            return true;
+        case TYPE_QUANT_K8:
+            dequantize_q8((const block_q8_t*) buffer->data, dst, n);
+            return true;
+        case TYPE_QUANT_K4:
+            dequantize_q4((const block_q4_t*) buffer->data, dst, n);
+            return true;
+        default:
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "Cannot decode from unsupported data type %d.\n",
+                buffer->type);
+            return false;
+    }
+}
+
+buffer_t* buffer_convert(const buffer_t* buffer, data_type_t type) {
+    buffer_t* result = buffer_create(type, buffer->count);
+    if (NULL == result) {
+        return NULL;
+    }
+
+    if (buffer->type == type) {
+        memcpy(result->data, buffer->data, buffer->size);
+        return result;
+    }
+
+    float* values = (float*) malloc(buffer->count * sizeof(float));
+    if (NULL == values && buffer->count > 0) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "Failed to allocate %zu bytes for buffer conversion.\n",
+            buffer->count * sizeof(float));
+        buffer_free(result);
+        return NULL;
+    }
+
+    bool ok = buffer_to_float(buffer, values)
+              && buffer_from_float(result, values);
+    free(values);
+
+    if (!ok) {
+        buffer_free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Dot product kernels
+ */
+
+static float dot_f32(const float* a, const float* b, size_t n) {
+    float  lanes[BUFFER_LANES] = {0};
+    size_t i                   = 0;
+
+    for (; i + BUFFER_LANES <= n; i += BUFFER_LANES) {
+        for (size_t j = 0; j < BUFFER_LANES; j++) {
+            lanes[j] += a[i + j] * b[i + j];
+        }
+    }
+
+    float sum = 0.0f;
+    for (size_t j = 0; j < BUFFER_LANES; j++) {
+        sum += lanes[j];
+    }
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+// Decode BUFFER_CHUNK_SIZE elements at a time and reduce against b
+static float dot_chunked(const buffer_t* buffer, const float* b) {
+    const uint8_t* data  = (const uint8_t*) buffer->data;
+    const size_t   width = buffer_type_size(buffer->type, 1);
+    float          chunk[BUFFER_CHUNK_SIZE];
+    float          sum = 0.0f;
+
+    for (size_t i = 0; i < buffer->count; i += BUFFER_CHUNK_SIZE) {
+        size_t      n   = buffer->count - i;
+        const void* src = data + i * width;
+        n               = n < BUFFER_CHUNK_SIZE ? n : BUFFER_CHUNK_SIZE;
+
+        switch (buffer->type) {
+            case TYPE_FLOAT_F16:
+                decode_float16_array((const float16_t*) src, chunk, n);
+                break;
+            case TYPE_FLOAT_BF16:
+                decode_bfloat16_array((const bfloat16_t*) src, chunk, n);
+                break;
+            case TYPE_FLOAT_F8:
+                decode_float8_e4m3_array((const float8_t*) src, chunk, n);
+                break;
+            default:
+                decode_float8_e5m2_array((const float8_t*) src, chunk, n);
+                break;
+        }
+
+        sum += dot_f32(chunk, b + i, n);
+    }
+
+    return sum;
+}
+
+static float dot_q8(const block_q8_t* blocks, const float* b, size_t count) {
+    float sum = 0.0f;
+
+    for (size_t k = 0; k < buffer_blocks(count); k++) {
+        const float* y = b + k * BUFFER_BLOCK_SIZE;
+        size_t       n = count - k * BUFFER_BLOCK_SIZE;
+        n              = n < BUFFER_BLOCK_SIZE ? n : BUFFER_BLOCK_SIZE;
+
+        float partial = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            partial += (float) blocks[k].quants[i] * y[i];
+        }
+        sum += decode_float16(blocks[k].scale) * partial;
+    }
+
+    return sum;
+}
+
+static float dot_q4(const block_q4_t* blocks, const float* b, size_t count) {
+    float sum = 0.0f;
+
+    for (size_t k = 0; k < buffer_blocks(count); k++) {
+        const float* y = b + k * BUFFER_BLOCK_SIZE;
+        size_t       n = count - k * BUFFER_BLOCK_SIZE;
+        n              = n < BUFFER_BLOCK_SIZE ? n : BUFFER_BLOCK_SIZE;
+
+        float partial = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            uint8_t packed = blocks[k].quants[i / 2];
+            int     quant  = (i & 1) ? (packed >> 4) : (packed & 0x0F);
+            partial       += (float) (quant - 8) * y[i];
+        }
+        sum += decode_float16(blocks[k].scale) * partial;
+    }
+
+    return sum;
+}
+
+float buffer_dot_float(const buffer_t* buffer, const float* b) {
+    switch (buffer->type) {
+        case TYPE_FLOAT_F32:
+            return dot_f32((const float*) buffer->data, b, buffer->count);
+        case TYPE_FLOAT_F16:
+        case TYPE_FLOAT_BF16:
+        case TYPE_FLOAT_F8:
+        case TYPE_FLOAT_F8_E5M2:
+            return dot_chunked(buffer, b);
+        case TYPE_QUANT_K8:
+            return dot_q8((const block_q8_t*) buffer->data, b, buffer->count);
+        case TYPE_QUANT_K4:
+            return dot_q4((const block_q4_t*) buffer->data, b, buffer->count);
+        default:
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "Cannot compute dot product of unsupported data type %d.\n",
+                buffer->type);
+            return NAN;
+    }
+}
+
+/**
+ * @brief Mixed precision storage for vectors and matrices
+ */
+
+buffer_t* vector_to_buffer(const vector_t* vector, data_type_t type) {
+    buffer_t* buffer = buffer_create(type, vector->dimensions);
+    if (NULL == buffer) {
+        return NULL;
+    }
+
+    if (!buffer_from_float(buffer, vector->elements)) {
+        buffer_free(buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+vector_t* vector_from_buffer(const buffer_t* buffer) {
+    vector_t* vector = vector_create(buffer->count);
+    if (NULL == vector) {
+        return NULL;
+    }
+
+    if (!buffer_to_float(buffer, vector->elements)) {
+        vector_free(vector);
+        return NULL;
+    }
+
+    return vector;
+}
+
+buffer_t* matrix_to_buffer(const matrix_t* matrix, data_type_t type) {
+    buffer_t* buffer = buffer_create(type, matrix_elements(matrix));
+    if (NULL == buffer) {
+        return NULL;
+    }
+
+    if (!buffer_from_float(buffer, matrix->elements)) {
+        buffer_free(buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+matrix_t* matrix_from_buffer(
+    const buffer_t* buffer, const size_t rows, const size_t columns
+) {
+    if (rows * columns != buffer->count) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "Buffer of %zu elements cannot back a %zux%zu matrix.\n",
+            buffer->count,
+            rows,
+            columns);
+        return NULL;
+    }
+
+    matrix_t* matrix = matrix_create(rows, columns);
+    if (NULL == matrix) {
+        return NULL;
+    }
+
+    if (!buffer_to_float(buffer, matrix->elements)) {
+        matrix_free(matrix);
+        return NULL;
+    }
+
+    return matrix;
+}
@@ -0,0 +1,574 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file source/fixed.c
+ *
+ * @brief Q16.16 fixed-point arithmetic kernels
+ *
+ * Every operation forms its exact result in a 64-bit intermediate, rounds
+ * once, and saturates to the fixed16_t range, so no caller has to reason
+ * about overflow in (a * b) >> 16. The dot product, whose sums outgrow 64
+ * bits, keeps the high and low words of its products apart instead.
+ *
+ * Division avoids the integer divider: the divisor is normalized to [0.5, 1)
+ * and its reciprocal refined with Newton-Raphson, which doubles the number
+ * of correct bits per step, then multiplied into the dividend. One residual
+ * check makes the quotient correctly rounded.
+ *
+ * The int16 GEMM packs B into panels of interleaved row pairs so that each
+ * _mm256_madd_epi16 multiplies two k-steps of eight columns at once, and
+ * requantizes the int32 results with a Q31 multiplier and a shift per
+ * output channel.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ *
+ * @ref https://en.wikipedia.org/wiki/Division_algorithm#Newton%E2%80%93Raphson_division
+ */
+
+#include "../include/fixed.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Newton-Raphson steps; the initial estimate is good to ~4 bits
+#define FIXED_NEWTON_STEPS 3
+
+// Elements of fixed_dot between folds of its low word sums
+#define FIXED_DOT_BLOCK (1u << 24)
+
+fixed16_t fixed_saturate(int64_t value) {
+    if (value > FIXED_MAX) {
+        return FIXED_MAX;
+    }
+    if (value < FIXED_MIN) {
+        return FIXED_MIN;
+    }
+    return (fixed16_t) value;
+}
+
+int64_t fixed_round_shift(int64_t value, int shift, fixed_rounding_t mode) {
+    const int64_t half  = INT64_C(1) << (shift - 1);
+    const int64_t mask  = (INT64_C(1) << shift) - 1;
+    const int64_t floor = value >> shift; // arithmetic shift on gcc and clang
+
+    switch (mode) {
+        case FIXED_ROUND_ZERO:
+            // floor() rounded negative values away from zero
+            return (value < 0 && (value & mask)) ? floor + 1 : floor;
+        case FIXED_ROUND_NEAREST:
+            return (value + half) >> shift;
+        case FIXED_ROUND_NEAREST_EVEN: {
+            int64_t remainder = value & mask;
+            if (remainder > half || (remainder == half && (floor & 1))) {
+                return floor + 1;
+            }
+            return floor;
+        }
+        case FIXED_ROUND_FLOOR:
+        default:
+            return floor;
+    }
+}
+
+fixed16_t fixed_add(fixed16_t a, fixed16_t b) {
+    return fixed_saturate((int64_t) a + b);
+}
+
+fixed16_t fixed_sub(fixed16_t a, fixed16_t b) {
+    return fixed_saturate((int64_t) a - b);
+}
+
+fixed16_t fixed_mul(fixed16_t a, fixed16_t b) {
+    return fixed_mul_round(a, b, FIXED_ROUND_NEAREST);
+}
+
+fixed16_t fixed_mul_round(fixed16_t a, fixed16_t b, fixed_rounding_t mode) {
+    return fixed_saturate(
+        fixed_round_shift((int64_t) a * b, FIXED_SIZE, mode)
+    );
+}
+
+/*
+ * Reciprocal of a normalized divisor. With m in [2^31, 2^32) representing
+ * x = m / 2^32 in [0.5, 1), returns r ~ 1 / x in (1, 2] as an unsigned Q2.30.
+ */
+static uint64_t fixed_normalized_reciprocal(uint64_t m) {
+    // r0 = 48/17 - 32/17 * x minimizes the worst case error over [0.5, 1)
+    const uint64_t c0 = UINT64_C(3031741620); // 48/17 * 2^30
+    const uint64_t c1 = UINT64_C(2021161080); // 32/17 * 2^30
+
+    uint64_t r = c0 - ((c1 * m) >> 32);
+    for (int step = 0; step < FIXED_NEWTON_STEPS; step++) {
+        uint64_t t = (m * r) >> 32;                     // x * r in Q2.30
+        r          = (r * ((UINT64_C(2) << 30) - t)) >> 30; // r * (2 - x * r)
+    }
+    return r;
+}
+
+fixed16_t fixed_div(fixed16_t a, fixed16_t b) {
+    const bool negative = (a < 0) != (b < 0);
+
+    if (0 == b) {
+        return 0 == a ? 0 : (a < 0 ? FIXED_MIN : FIXED_MAX);
+    }
+
+    uint64_t dividend = a < 0 ? (uint64_t) (-(int64_t) a) : (uint64_t) a;
+    uint64_t divisor  = b < 0 ? (uint64_t) (-(int64_t) b) : (uint64_t) b;
+
+    // |a / b| >= 2^15 saturates; past it the reciprocal error grows with the
+    // quotient and the corrections below would take up to 2^17 steps
+    if ((dividend << FIXED_SIZE) >= (divisor << 31)) {
+        return negative ? FIXED_MIN : FIXED_MAX;
+    }
+
+    // divisor = x * 2^(32 - shift) with x in [0.5, 1)
+    int      shift = __builtin_clzll(divisor) - 32;
+    uint64_t r     = fixed_normalized_reciprocal(divisor << shift);
+
+    // a / b in Q16.16 = dividend * r * 2^(shift - 16 - 30)
+    int     bits     = 46 - shift;
+    int64_t quotient = (int64_t) ((dividend * r) >> bits);
+
+    // Below 2^31 the estimate is within a few lsb; the exact residual of the
+    // scaled dividend settles it to the nearest quotient with multiplies only
+    int64_t residual = (int64_t) (dividend << FIXED_SIZE)
+                       - quotient * (int64_t) divisor;
+    while (2 * residual >= (int64_t) divisor) {
+        quotient++;
+        residual -= (int64_t) divisor;
+    }
+    while (2 * residual < -(int64_t) divisor) {
+        quotient--;
+        residual += (int64_t) divisor;
+    }
+
+    return fixed_saturate(negative ? -quotient : quotient);
+}
+
+fixed16_t fixed_reciprocal(fixed16_t a) {
+    return fixed_div(INT_TO_FIXED(1), a);
+}
+
+#if defined(__AVX2__)
+/*
+ * Signed 32-bit lanes cannot overflow-check in place, so each op computes the
+ * wrapped result and replaces lanes whose sign bit is wrong with the bound
+ * that matches the sign of the first operand.
+ */
+static inline __m256i fixed_saturate_epi32(
+    __m256i result, __m256i a, __m256i overflow
+) {
+    const __m256i max   = _mm256_set1_epi32(FIXED_MAX);
+    __m256i       bound = _mm256_xor_si256(_mm256_srai_epi32(a, 31), max);
+    return _mm256_castps_si256(_mm256_blendv_ps(
+        _mm256_castsi256_ps(result),
+        _mm256_castsi256_ps(bound),
+        _mm256_castsi256_ps(overflow)
+    ));
+}
+
+/*
+ * _mm256_mul_epi32 multiplies the even 32-bit lanes into 64-bit products.
+ * The odd lanes are shifted down, multiplied the same way, and the two
+ * rounded halves are interleaved back into eight 32-bit results.
+ */
+static inline __m256i fixed_mul_epi32(__m256i a, __m256i b) {
+    const __m256i half = _mm256_set1_epi64x(INT64_C(1) << (FIXED_SIZE - 1));
+    const __m256i ones = _mm256_set1_epi64x(0x1FFFF);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max  = _mm256_set1_epi32(FIXED_MAX);
+
+    __m256i even = _mm256_add_epi64(_mm256_mul_epi32(a, b), half);
+    __m256i odd  = _mm256_add_epi64(
+        _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)),
+        half
+    );
+
+    // A rounded product fits when bits 47..63 are all zeros or all ones
+    __m256i even_top = _mm256_srli_epi64(even, 47);
+    __m256i odd_top  = _mm256_srli_epi64(odd, 47);
+    __m256i even_ok  = _mm256_or_si256(
+        _mm256_cmpeq_epi64(even_top, zero), _mm256_cmpeq_epi64(even_top, ones)
+    );
+    __m256i odd_ok   = _mm256_or_si256(
+        _mm256_cmpeq_epi64(odd_top, zero), _mm256_cmpeq_epi64(odd_top, ones)
+    );
+
+    __m256i result   = _mm256_blend_epi32(
+        _mm256_srli_epi64(even, FIXED_SIZE),
+        _mm256_slli_epi64(_mm256_srli_epi64(odd, FIXED_SIZE), 32),
+        0xAA
+    );
+    __m256i overflow = _mm256_xor_si256(
+        _mm256_blend_epi32(even_ok, odd_ok, 0xAA), _mm256_set1_epi32(-1)
+    );
+
+    // Overflowing products are non-zero, so their sign is sign(a) ^ sign(b)
+    __m256i bound = _mm256_xor_si256(
+        _mm256_srai_epi32(_mm256_xor_si256(a, b), 31), max
+    );
+    return _mm256_castps_si256(_mm256_blendv_ps(
+        _mm256_castsi256_ps(result),
+        _mm256_castsi256_ps(bound),
+        _mm256_castsi256_ps(overflow)
+    ));
+}
+#endif
+
+void fixed_add_array(
+    const fixed16_t* a, const fixed16_t* b, fixed16_t* dst, size_t n
+) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i x   = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i y   = _mm256_loadu_si256((const __m256i*) (b + i));
+        __m256i sum = _mm256_add_epi32(x, y);
+        // Overflow iff the operands share a sign that the sum does not
+        __m256i overflow = _mm256_andnot_si256(
+            _mm256_xor_si256(x, y), _mm256_xor_si256(x, sum)
+        );
+        _mm256_storeu_si256(
+            (__m256i*) (dst + i), fixed_saturate_epi32(sum, x, overflow)
+        );
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = fixed_add(a[i], b[i]);
+    }
+}
+
+void fixed_sub_array(
+    const fixed16_t* a, const fixed16_t* b, fixed16_t* dst, size_t n
+) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i x          = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i y          = _mm256_loadu_si256((const __m256i*) (b + i));
+        __m256i difference = _mm256_sub_epi32(x, y);
+        // Overflow iff the operands differ in sign and the result flipped
+        __m256i overflow   = _mm256_and_si256(
+            _mm256_xor_si256(x, y), _mm256_xor_si256(x, difference)
+        );
+        _mm256_storeu_si256(
+            (__m256i*) (dst + i), fixed_saturate_epi32(difference, x, overflow)
+        );
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = fixed_sub(a[i], b[i]);
+    }
+}
+
+void fixed_mul_array(
+    const fixed16_t* a, const fixed16_t* b, fixed16_t* dst, size_t n
+) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+        _mm256_storeu_si256((__m256i*) (dst + i), fixed_mul_epi32(x, y));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = fixed_mul(a[i], b[i]);
+    }
+}
+
+void fixed_scale_array(
+    const fixed16_t* src, fixed16_t scalar, fixed16_t* dst, size_t n
+) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i y = _mm256_set1_epi32(scalar);
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (src + i));
+        _mm256_storeu_si256((__m256i*) (dst + i), fixed_mul_epi32(x, y));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = fixed_mul(src[i], scalar);
+    }
+}
+
+#if defined(__AVX2__)
+// Arithmetic p >> 32 of each 64-bit lane, which AVX2 has no instruction for
+static inline __m256i fixed_high_epi64(__m256i p) {
+    const __m256i bias = _mm256_set1_epi64x(INT64_C(0x80000000));
+    return _mm256_sub_epi64(
+        _mm256_xor_si256(_mm256_srli_epi64(p, 32), bias), bias
+    );
+}
+#endif
+
+/*
+ * A single product can reach 2^62, so two already overflow an int64. Each
+ * product is split into its signed high and unsigned low 32 bits, which are
+ * summed separately; the low sums are folded into the high one every block
+ * of FIXED_DOT_BLOCK elements, long before they could overflow.
+ */
+fixed16_t fixed_dot(const fixed16_t* a, const fixed16_t* b, size_t n) {
+    int64_t  high = 0; // Sum of p >> 32
+    uint64_t low  = 0; // Sum of p & 0xFFFFFFFF not yet folded into high
+
+    for (size_t start = 0; start < n; start += FIXED_DOT_BLOCK) {
+        size_t end = n - start < FIXED_DOT_BLOCK ? n : start + FIXED_DOT_BLOCK;
+        size_t i   = start;
+
+#if defined(__AVX2__)
+        const __m256i mask = _mm256_set1_epi64x(INT64_C(0xFFFFFFFF));
+        __m256i       hi   = _mm256_setzero_si256();
+        __m256i       lo   = _mm256_setzero_si256();
+        for (; i + 8 <= end; i += 8) {
+            __m256i x    = _mm256_loadu_si256((const __m256i*) (a + i));
+            __m256i y    = _mm256_loadu_si256((const __m256i*) (b + i));
+            __m256i even = _mm256_mul_epi32(x, y);
+            __m256i odd  = _mm256_mul_epi32(
+                _mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32)
+            );
+            hi = _mm256_add_epi64(hi, fixed_high_epi64(even));
+            hi = _mm256_add_epi64(hi, fixed_high_epi64(odd));
+            lo = _mm256_add_epi64(lo, _mm256_and_si256(even, mask));
+            lo = _mm256_add_epi64(lo, _mm256_and_si256(odd, mask));
+        }
+
+        int64_t  his[4];
+        uint64_t los[4];
+        _mm256_storeu_si256((__m256i*) his, hi);
+        _mm256_storeu_si256((__m256i*) los, lo);
+        high += his[0] + his[1] + his[2] + his[3];
+        low  += los[0] + los[1] + los[2] + los[3];
+#endif
+
+        for (; i < end; i++) {
+            // Arithmetic shift on gcc and clang
+            int64_t product  = (int64_t) a[i] * b[i];
+            high            += product >> 32;
+            low             += (uint32_t) product;
+        }
+
+        high += (int64_t) (low >> 32);
+        low  &= UINT64_C(0xFFFFFFFF);
+    }
+
+    // |sum| >= 2^47 saturates; below that the exact sum fits an int64
+    if (high >= INT64_C(1) << 15) {
+        return FIXED_MAX;
+    }
+    if (high < -(INT64_C(1) << 15)) {
+        return FIXED_MIN;
+    }
+
+    int64_t sum = high * (INT64_C(1) << 32) + (int64_t) low;
+    return fixed_saturate(
+        fixed_round_shift(sum, FIXED_SIZE, FIXED_ROUND_NEAREST)
+    );
+}
+
+fixed_requant_t fixed_requant_create(double scale) {
+    fixed_requant_t requant = {0, 0};
+    if (!(scale > 0.0)) {
+        return requant;
+    }
+
+    // scale = fraction * 2^exponent with fraction in [0.5, 1)
+    int     exponent;
+    double  fraction   = frexp(scale, &exponent);
+    int64_t multiplier = llround(fraction * (double) (INT64_C(1) << 31));
+    if (multiplier == (INT64_C(1) << 31)) {
+        multiplier /= 2; // fraction rounded up to 1.0
+        exponent++;
+    }
+
+    // Keep the total shift 31 + shift within (0, 63)
+    int shift = -exponent;
+    shift     = shift < -30 ? -30 : (shift > 31 ? 31 : shift);
+
+    requant.multiplier = (int32_t) multiplier;
+    requant.shift      = shift;
+    return requant;
+}
+
+int16_t fixed_requantize(int32_t value, fixed_requant_t requant) {
+    int64_t scaled = fixed_round_shift(
+        (int64_t) value * requant.multiplier,
+        31 + requant.shift,
+        FIXED_ROUND_NEAREST
+    );
+    return (int16_t) (scaled > INT16_MAX
+                          ? INT16_MAX
+                          : (scaled < -INT16_MAX ? -INT16_MAX : scaled));
+}
+
+/*
+ * Pack a kc x nb block of B (row stride n) as pairs of rows interleaved
+ * column by column: panel[(p * width + j) * 2 + r] = B[2p + r][j]. Rows past
+ * kc and columns past nb are zero so the kernel never needs a tail in k.
+ */
+static void fixed_gemm_pack(
+    const int16_t* b,
+    size_t         n,
+    int16_t*       panel,
+    size_t         kc,
+    size_t         nb,
+    size_t         width
+) {
+    const size_t pairs = (kc + 1) / 2;
+
+    for (size_t p = 0; p < pairs; p++) {
+        for (size_t j = 0; j < width; j++) {
+            for (size_t r = 0; r < 2; r++) {
+                size_t row = 2 * p + r;
+                panel[(p * width + j) * 2 + r]
+                    = (row < kc && j < nb) ? b[row * n + j] : 0;
+            }
+        }
+    }
+}
+
+/*
+ * Accumulate one row of A against a packed panel into nb columns of C. Each
+ * k pair of A is broadcast as one 32-bit lane and madd'ed against eight
+ * interleaved columns; four column groups share each broadcast.
+ */
+static void fixed_gemm_kernel(
+    const int16_t* a,
+    const int16_t* panel,
+    int32_t*       c,
+    size_t         kc,
+    size_t         nb,
+    size_t         width
+) {
+    const size_t pairs = (kc + 1) / 2;
+    uint32_t     a_pairs[FIXED_GEMM_BLOCK_K / 2];
+
+    for (size_t p = 0; p < pairs; p++) {
+        uint16_t lo = (uint16_t) a[2 * p];
+        uint16_t hi = 2 * p + 1 < kc ? (uint16_t) a[2 * p + 1] : 0;
+        a_pairs[p]  = (uint32_t) lo | ((uint32_t) hi << 16);
+    }
+
+    size_t j = 0;
+
+#if defined(__AVX2__)
+    for (; j + 32 <= width; j += 32) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256();
+        __m256i acc3 = _mm256_setzero_si256();
+
+        for (size_t p = 0; p < pairs; p++) {
+            const __m256i* row = (const __m256i*) (panel + (p * width + j) * 2);
+            __m256i        x   = _mm256_set1_epi32((int32_t) a_pairs[p]);
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x, row[0]));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(x, row[1]));
+            acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(x, row[2]));
+            acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(x, row[3]));
+        }
+
+        int32_t sums[32];
+        _mm256_storeu_si256((__m256i*) sums, acc0);
+        _mm256_storeu_si256((__m256i*) (sums + 8), acc1);
+        _mm256_storeu_si256((__m256i*) (sums + 16), acc2);
+        _mm256_storeu_si256((__m256i*) (sums + 24), acc3);
+        for (size_t l = 0; l < 32 && j + l < nb; l++) {
+            c[j + l] = (int32_t) ((uint32_t) c[j + l] + (uint32_t) sums[l]);
+        }
+    }
+
+    for (; j < width; j += 8) {
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t p = 0; p < pairs; p++) {
+            __m256i x   = _mm256_set1_epi32((int32_t) a_pairs[p]);
+            __m256i row = _mm256_load_si256(
+                (const __m256i*) (panel + (p * width + j) * 2)
+            );
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(x, row));
+        }
+
+        int32_t sums[8];
+        _mm256_storeu_si256((__m256i*) sums, acc);
+        for (size_t l = 0; l < 8 && j + l < nb; l++) {
+            c[j + l] = (int32_t) ((uint32_t) c[j + l] + (uint32_t) sums[l]);
+        }
+    }
+#endif
+
+    // Wrapping arithmetic in uint32_t matches the vector lanes exactly
+    for (; j < nb; j++) {
+        uint32_t sum = 0;
+        for (size_t p = 0; p < pairs; p++) {
+            const int16_t* pair = panel + (p * width + j) * 2;
+            int16_t        lo   = (int16_t) (a_pairs[p] & 0xFFFF);
+            int16_t        hi   = (int16_t) (a_pairs[p] >> 16);
+            sum += (uint32_t) (lo * pair[0]) + (uint32_t) (hi * pair[1]);
+        }
+        c[j] = (int32_t) ((uint32_t) c[j] + sum);
+    }
+}
+
+void fixed_gemm_s16(
+    const int16_t* a,
+    const int16_t* b,
+    int32_t*       c,
+    size_t         m,
+    size_t         n,
+    size_t         k
+) {
+    _Alignas(32) int16_t panel[FIXED_GEMM_BLOCK_K * FIXED_GEMM_BLOCK_N];
+
+    memset(c, 0, m * n * sizeof(int32_t));
+
+    for (size_t jb = 0; jb < n; jb += FIXED_GEMM_BLOCK_N) {
+        size_t nb    = n - jb;
+        nb           = nb < FIXED_GEMM_BLOCK_N ? nb : FIXED_GEMM_BLOCK_N;
+        size_t width = (nb + 7) & ~(size_t) 7; // whole vectors of columns
+
+        for (size_t kb = 0; kb < k; kb += FIXED_GEMM_BLOCK_K) {
+            size_t kc = k - kb;
+            kc        = kc < FIXED_GEMM_BLOCK_K ? kc : FIXED_GEMM_BLOCK_K;
+
+            // The panel stays hot in L1/L2 while every row of A streams past
+            fixed_gemm_pack(b + kb * n + jb, n, panel, kc, nb, width);
+            for (size_t i = 0; i < m; i++) {
+                fixed_gemm_kernel(
+                    a + i * k + kb, panel, c + i * n + jb, kc, nb, width
+                );
+            }
+        }
+    }
+}
+
+void fixed_gemm_requantize(
+    const int32_t*         c,
+    const int32_t*         bias,
+    const fixed_requant_t* requant,
+    int16_t*               dst,
+    size_t                 m,
+    size_t                 n
+) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            int32_t value = c[i * n + j];
+            if (NULL != bias) {
+                value = (int32_t) ((uint32_t) value + (uint32_t) bias[j]);
+            }
+            dst[i * n + j] = fixed_requantize(value, requant[j]);
+        }
+    }
+}
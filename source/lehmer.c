@@ -16,6 +16,32 @@
  */
 
 #include "lehmer.h"
+#include "tables.h"
+
+#include <math.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Mantissa fill: the top 23 seed bits under the exponent of 1.0f
+#define LEHMER_FLOAT_SHIFT 8
+#define LEHMER_FLOAT_ONE   0x3F800000u
+
+// Consecutive draws of one stream computed side by side by the batch fill
+#define LEHMER_LEAP 8
+
+// Bits form a float in [1, 2); subtracting one is exact
+static inline float lehmer_to_float(uint64_t seed) {
+    union {
+        uint32_t bits;
+        float    value;
+    } f32;
+
+    f32.bits = LEHMER_FLOAT_ONE | (uint32_t) (seed >> LEHMER_FLOAT_SHIFT);
+
+    return f32.value - 1.0f;
+}
 
 // Create and initialize the state with dynamic stream handling
 lehmer_state_t* lehmer_create_state(size_t size) {
@@ -60,9 +86,7 @@ void lehmer_select_stream(lehmer_state_t* state, size_t stream) {
 
 // Initialize the RNG state with seeds; decoupled from stream selection.
 void lehmer_seed_streams(lehmer_state_t* state, uint64_t value) {
-    const uint64_t quotient      = MODULUS / A256;
-    const uint64_t remainder     = MODULUS % A256;
-    const size_t   stream_backup = state->stream;
+    const size_t stream_backup = state->stream;
 
     // Select and set the initial stream
     lehmer_select_stream(state, 0);
@@ -72,10 +96,50 @@ void lehmer_seed_streams(lehmer_state_t* state, uint64_t value) {
 
     // Initialize remaining streams based on the first one
     for (size_t i = 1; i < state->size; i++) {
-        // Explicitly typecast signed results
-        state->seed[i]
-            = (uint64_t) (A256 * (state->seed[i - 1] % quotient)
-                          - remainder * (state->seed[i - 1] / quotient));
+        state->seed[i] = lehmer_reduce(state->seed[i - 1] * A256);
+    }
+
+    state->initialized = true;
+}
+
+/**
+ * @brief Jump-ahead
+ */
+
+// Both factors are below 2^31, so the product is below 2^62
+static inline uint64_t lehmer_mul_mod(uint64_t a, uint64_t b) {
+    return lehmer_reduce(a * b);
+}
+
+uint64_t lehmer_jump_multiplier(uint64_t k) {
+    uint64_t base   = MULTIPLIER;
+    uint64_t result = 1;
+
+    // The multiplicative group has order MODULUS - 1
+    for (k %= MODULUS - 1; k > 0; k >>= 1) {
+        if (k & 1) {
+            result = lehmer_mul_mod(result, base);
+        }
+        base = lehmer_mul_mod(base, base);
+    }
+
+    return result;
+}
+
+void lehmer_jump(lehmer_state_t* state, uint64_t k) {
+    state->seed[state->stream] = lehmer_mul_mod(
+        state->seed[state->stream], lehmer_jump_multiplier(k)
+    );
+}
+
+void lehmer_seed_streams_stride(
+    lehmer_state_t* state, uint64_t value, uint64_t stride
+) {
+    const uint64_t multiplier = lehmer_jump_multiplier(stride);
+
+    state->seed[0] = value % MODULUS;
+    for (size_t i = 1; i < state->size; i++) {
+        state->seed[i] = lehmer_mul_mod(state->seed[i - 1], multiplier);
     }
 
     state->initialized = true;
@@ -83,15 +147,429 @@ void lehmer_seed_streams(lehmer_state_t* state, uint64_t value) {
 
 // Generate the next random number
 double lehmer_generate(lehmer_state_t* state) {
-    const uint64_t quotient  = MODULUS / MULTIPLIER;
-    const uint64_t remainder = MODULUS % MULTIPLIER;
+    state->seed[state->stream] = lehmer_step(state->seed[state->stream]);
+    return ((double) state->seed[state->stream] / MODULUS);
+}
+
+float lehmer_generate_float(lehmer_state_t* state) {
+    state->seed[state->stream] = lehmer_step(state->seed[state->stream]);
+    return lehmer_to_float(state->seed[state->stream]);
+}
+
+/**
+ * @brief Batched generation
+ */
+
+#if defined(__AVX2__)
+// Four lanes of seed * multiplier % MODULUS for multipliers below 2^31
+static inline __m256i lehmer_step_epi64(__m256i seed, __m256i multiplier) {
+    const __m256i modulus = _mm256_set1_epi64x(MODULUS);
 
-    // Explicitly typecast signed results
-    uint64_t new_seed
-        = (uint64_t) (MULTIPLIER * (state->seed[state->stream] % quotient)
-                      - remainder * (state->seed[state->stream] / quotient));
+    __m256i product = _mm256_mul_epu32(seed, multiplier);
+    product         = _mm256_add_epi64(
+        _mm256_and_si256(product, modulus), _mm256_srli_epi64(product, 31)
+    );
+    return _mm256_add_epi64(
+        _mm256_and_si256(product, modulus), _mm256_srli_epi64(product, 31)
+    );
+}
 
-    state->seed[state->stream] = new_seed;
+// Seeds are below 2^31, so the low dword of each lane holds the whole seed
+static inline __m128i lehmer_pack_epi64(__m256i seed) {
+    const __m256i low = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(seed, low));
+}
 
-    return ((double) state->seed[state->stream] / MODULUS);
+static inline void lehmer_store_double(double* out, __m256i seed) {
+    __m256d value = _mm256_cvtepi32_pd(lehmer_pack_epi64(seed));
+    _mm256_storeu_pd(out, _mm256_div_pd(value, _mm256_set1_pd(MODULUS)));
+}
+
+static inline void lehmer_store_float(float* out, __m256i seed) {
+    __m128i bits = _mm_or_si128(
+        _mm_srli_epi32(lehmer_pack_epi64(seed), LEHMER_FLOAT_SHIFT),
+        _mm_set1_epi32(LEHMER_FLOAT_ONE)
+    );
+    _mm_storeu_ps(out, _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f)));
+}
+
+/*
+ * Leapfrog one stream: seed LEHMER_LEAP lanes with consecutive draws, then
+ * advance every lane by MULTIPLIER^LEHMER_LEAP so lane j keeps producing
+ * draws j, j + LEHMER_LEAP, ... and the output order matches the scalar
+ * loop. Returns the number of values written, a multiple of LEHMER_LEAP.
+ */
+static size_t lehmer_leap(
+    uint64_t* seed, double* out, float* out_float, size_t n
+) {
+    uint64_t first[LEHMER_LEAP];
+
+    if (n < 2 * LEHMER_LEAP) {
+        return 0;
+    }
+
+    for (size_t j = 0; j < LEHMER_LEAP; j++) {
+        *seed    = lehmer_step(*seed);
+        first[j] = *seed;
+    }
+
+    const __m256i leap
+        = _mm256_set1_epi64x((long long) lehmer_jump_multiplier(LEHMER_LEAP));
+    __m256i low  = _mm256_loadu_si256((const __m256i*) first);
+    __m256i high = _mm256_loadu_si256((const __m256i*) (first + 4));
+    size_t  i    = 0;
+
+    for (;;) {
+        if (out) {
+            lehmer_store_double(out + i, low);
+            lehmer_store_double(out + i + 4, high);
+        } else {
+            lehmer_store_float(out_float + i, low);
+            lehmer_store_float(out_float + i + 4, high);
+        }
+
+        i += LEHMER_LEAP;
+        if (i + LEHMER_LEAP > n) {
+            break;
+        }
+
+        low  = lehmer_step_epi64(low, leap);
+        high = lehmer_step_epi64(high, leap);
+    }
+
+    *seed = (uint64_t) _mm256_extract_epi64(high, 3);
+    return i;
+}
+#endif
+
+// Keep the seed in a register instead of reloading it through the state
+static uint64_t lehmer_fill(uint64_t seed, double* out, size_t n) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    i = lehmer_leap(&seed, out, NULL, n);
+#endif
+
+    for (; i < n; i++) {
+        seed   = lehmer_step(seed);
+        out[i] = (double) seed / MODULUS;
+    }
+    return seed;
+}
+
+static uint64_t lehmer_fill_float(uint64_t seed, float* out, size_t n) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    i = lehmer_leap(&seed, NULL, out, n);
+#endif
+
+    for (; i < n; i++) {
+        seed   = lehmer_step(seed);
+        out[i] = lehmer_to_float(seed);
+    }
+    return seed;
+}
+
+void lehmer_generate_batch(lehmer_state_t* state, double* out, size_t n) {
+    state->seed[state->stream]
+        = lehmer_fill(state->seed[state->stream], out, n);
+}
+
+void lehmer_generate_batch_float(lehmer_state_t* state, float* out, size_t n) {
+    state->seed[state->stream]
+        = lehmer_fill_float(state->seed[state->stream], out, n);
+}
+
+// Copy the lane seeds out of the state; returns the clamped lane count
+static size_t lehmer_lanes_load(
+    const lehmer_state_t* state, uint64_t* seed, size_t lanes
+) {
+    lanes = lanes < state->size ? lanes : state->size;
+    lanes = lanes < LEHMER_MAX_LANES ? lanes : LEHMER_MAX_LANES;
+    lanes = lanes > 0 ? lanes : 1;
+
+    for (size_t j = 0; j < lanes; j++) {
+        seed[j] = state->seed[(state->stream + j) % state->size];
+    }
+
+    return lanes;
+}
+
+static void lehmer_lanes_store(
+    lehmer_state_t* state, const uint64_t* seed, size_t lanes
+) {
+    for (size_t j = 0; j < lanes; j++) {
+        state->seed[(state->stream + j) % state->size] = seed[j];
+    }
+}
+
+#if defined(__AVX2__)
+// Whole rows of lanes, four streams per register; returns values written
+static size_t lehmer_lanes_vector(
+    uint64_t* seed, size_t lanes, double* out, float* out_float, size_t n
+) {
+    const __m256i multiplier = _mm256_set1_epi64x(MULTIPLIER);
+    const size_t  groups     = lanes / 4;
+    __m256i       vector[LEHMER_MAX_LANES / 4];
+    size_t        i = 0;
+
+    if (0 != lanes % 4) {
+        return 0;
+    }
+
+    for (size_t g = 0; g < groups; g++) {
+        vector[g] = _mm256_loadu_si256((const __m256i*) (seed + 4 * g));
+    }
+
+    for (; i + lanes <= n; i += lanes) {
+        for (size_t g = 0; g < groups; g++) {
+            vector[g] = lehmer_step_epi64(vector[g], multiplier);
+            if (out) {
+                lehmer_store_double(out + i + 4 * g, vector[g]);
+            } else {
+                lehmer_store_float(out_float + i + 4 * g, vector[g]);
+            }
+        }
+    }
+
+    for (size_t g = 0; g < groups; g++) {
+        _mm256_storeu_si256((__m256i*) (seed + 4 * g), vector[g]);
+    }
+
+    return i;
+}
+#endif
+
+void lehmer_generate_lanes(
+    lehmer_state_t* state, double* out, size_t n, size_t lanes
+) {
+    uint64_t seed[LEHMER_MAX_LANES];
+    size_t   i = 0;
+
+    lanes = lehmer_lanes_load(state, seed, lanes);
+
+#if defined(__AVX2__)
+    i = lehmer_lanes_vector(seed, lanes, out, NULL, n);
+#endif
+
+    // Scalar lanes and the final partial row
+    for (; i < n; i += lanes) {
+        size_t width = n - i < lanes ? n - i : lanes;
+        for (size_t j = 0; j < width; j++) {
+            seed[j]    = lehmer_step(seed[j]);
+            out[i + j] = (double) seed[j] / MODULUS;
+        }
+    }
+
+    lehmer_lanes_store(state, seed, lanes);
+}
+
+void lehmer_generate_lanes_float(
+    lehmer_state_t* state, float* out, size_t n, size_t lanes
+) {
+    uint64_t seed[LEHMER_MAX_LANES];
+    size_t   i = 0;
+
+    lanes = lehmer_lanes_load(state, seed, lanes);
+
+#if defined(__AVX2__)
+    i = lehmer_lanes_vector(seed, lanes, NULL, out, n);
+#endif
+
+    for (; i < n; i += lanes) {
+        size_t width = n - i < lanes ? n - i : lanes;
+        for (size_t j = 0; j < width; j++) {
+            seed[j]    = lehmer_step(seed[j]);
+            out[i + j] = lehmer_to_float(seed[j]);
+        }
+    }
+
+    lehmer_lanes_store(state, seed, lanes);
+}
+
+/**
+ * @brief Samplers
+ */
+
+// Uniform double in (0, 1) for the ziggurat wedge and tail tests
+static inline double lehmer_open(uint64_t* seed) {
+    *seed = lehmer_step(*seed);
+    return (double) *seed / MODULUS;
+}
+
+static double lehmer_normal_seed(uint64_t* seed) {
+    const uint32_t* k = table_ziggurat_k();
+    const double*   w = table_ziggurat_w();
+    const double*   f = table_ziggurat_f();
+
+    for (;;) {
+        // Low 7 bits pick the strip, bit 7 the sign, the top 23 the position
+        *seed         = lehmer_step(*seed);
+        uint32_t u    = (uint32_t) (*seed - 1);
+        uint32_t i    = u & (TABLE_ZIGGURAT_SIZE - 1);
+        uint32_t j    = u >> (31 - TABLE_ZIGGURAT_BITS);
+        double   x    = j * w[i];
+        double   sign = (u & TABLE_ZIGGURAT_SIZE) ? -1.0 : 1.0;
+
+        if (j < k[i]) {
+            return sign * x;
+        }
+
+        // Base strip overflow: sample the tail beyond R (Marsaglia 1964)
+        if (0 == i) {
+            double y;
+            do {
+                x = -log(lehmer_open(seed)) / TABLE_ZIGGURAT_R;
+                y = -log(lehmer_open(seed));
+            } while (y + y < x * x);
+            return sign * (TABLE_ZIGGURAT_R + x);
+        }
+
+        // Wedge between the strip core and the density
+        if (f[i] + lehmer_open(seed) * (f[i - 1] - f[i]) < exp(-0.5 * x * x)) {
+            return sign * x;
+        }
+    }
+}
+
+/*
+ * Lemire, "Fast Random Integer Generation in an Interval" (2019), with the
+ * power-of-two source replaced by the LEHMER_RANGE_MAX outputs: x * range
+ * splits into range buckets of LEHMER_RANGE_MAX products, and rejecting the
+ * lowest LEHMER_RANGE_MAX % range remainders leaves every bucket the same
+ * size. The divisions are by a constant, and the threshold is only computed
+ * when the remainder is below range.
+ */
+static uint32_t lehmer_bounded_seed(uint64_t* seed, uint32_t range) {
+    if (0 == range) {
+        return 0;
+    }
+
+    *seed              = lehmer_step(*seed);
+    uint64_t product   = (*seed - 1) * range;
+    uint64_t remainder = product % LEHMER_RANGE_MAX;
+
+    if (remainder < range) {
+        const uint64_t threshold = LEHMER_RANGE_MAX % range;
+        while (remainder < threshold) {
+            *seed     = lehmer_step(*seed);
+            product   = (*seed - 1) * range;
+            remainder = product % LEHMER_RANGE_MAX;
+        }
+    }
+
+    return (uint32_t) (product / LEHMER_RANGE_MAX);
+}
+
+double lehmer_normal(lehmer_state_t* state) {
+    return lehmer_normal_seed(&state->seed[state->stream]);
+}
+
+void lehmer_normal_batch(
+    lehmer_state_t* state, float* out, size_t n, float mean, float stddev
+) {
+    uint64_t seed = state->seed[state->stream];
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (float) (mean + stddev * lehmer_normal_seed(&seed));
+    }
+
+    state->seed[state->stream] = seed;
+}
+
+void lehmer_uniform_batch(
+    lehmer_state_t* state, float* out, size_t n, float low, float high
+) {
+    const float span = high - low;
+
+    state->seed[state->stream]
+        = lehmer_fill_float(state->seed[state->stream], out, n);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = low + span * out[i];
+    }
+}
+
+uint32_t lehmer_bounded(lehmer_state_t* state, uint32_t range) {
+    return lehmer_bounded_seed(&state->seed[state->stream], range);
+}
+
+void lehmer_bounded_batch(
+    lehmer_state_t* state, uint32_t* out, size_t n, uint32_t range
+) {
+    uint64_t seed = state->seed[state->stream];
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = lehmer_bounded_seed(&seed, range);
+    }
+
+    state->seed[state->stream] = seed;
+}
+
+/**
+ * @brief Per-thread stream handles
+ */
+
+void lehmer_stream_checkout(
+    const lehmer_state_t* state, lehmer_stream_t* handle, size_t stream
+) {
+    handle->stream = stream % state->size;
+    handle->seed   = state->seed[handle->stream];
+}
+
+void lehmer_stream_commit(
+    lehmer_state_t* state, const lehmer_stream_t* handle
+) {
+    state->seed[handle->stream] = handle->seed;
+}
+
+double lehmer_stream_generate(lehmer_stream_t* handle) {
+    handle->seed = lehmer_step(handle->seed);
+    return ((double) handle->seed / MODULUS);
+}
+
+float lehmer_stream_generate_float(lehmer_stream_t* handle) {
+    handle->seed = lehmer_step(handle->seed);
+    return lehmer_to_float(handle->seed);
+}
+
+void lehmer_stream_generate_batch(
+    lehmer_stream_t* handle, double* out, size_t n
+) {
+    handle->seed = lehmer_fill(handle->seed, out, n);
+}
+
+void lehmer_stream_generate_batch_float(
+    lehmer_stream_t* handle, float* out, size_t n
+) {
+    handle->seed = lehmer_fill_float(handle->seed, out, n);
+}
+
+// The owning state is NULL while the thread is unbound
+static _Thread_local lehmer_stream_t lehmer_thread_stream;
+static _Thread_local lehmer_state_t* lehmer_thread_state;
+
+bool lehmer_thread_bind(lehmer_state_t* state, size_t stream) {
+    if (lehmer_thread_state) {
+        return false;
+    }
+
+    lehmer_stream_checkout(state, &lehmer_thread_stream, stream);
+    lehmer_thread_state = state;
+    return true;
+}
+
+void lehmer_thread_unbind(void) {
+    if (lehmer_thread_state) {
+        lehmer_stream_commit(lehmer_thread_state, &lehmer_thread_stream);
+        lehmer_thread_state = NULL;
+    }
+}
+
+double lehmer_thread_generate(void) {
+    return lehmer_stream_generate(&lehmer_thread_stream);
+}
+
+float lehmer_thread_generate_float(void) {
+    return lehmer_stream_generate_float(&lehmer_thread_stream);
 }
@@ -44,6 +44,24 @@
  *     - ∂e/∂b = 2/n * Σ(y' - (m * x + b)) (-1)
  *     - ∂e/∂b = -2/n * Σ(y' - (m * x) - b))
  *
+ * struct Gradient mean_square_error_gradient(const float X[], const float Y[], size_t size,
+ *                                            float m, float b)
+ *   - Calculates the MSE and both partial derivatives in one pass over X and Y.
+ *     - The residual r = y' - (m * x + b) is shared by all three sums: Σr^2, Σxr and Σr.
+ *
+ * struct Params fit_linear_ols(const float X[], const float Y[], size_t size, size_t threads)
+ *   - Solves for the least squares line directly from n, Σx, Σy, Σxx and Σxy.
+ *     - m = (Σxy - Σx * Σy / n) / (Σxx - Σx * Σx / n)
+ *     - b = (Σy - m * Σx) / n
+ *   - The sums are a struct LinearStats, which can also be updated as data arrives and merged
+ *     across threads or files with linear_stats_update and linear_stats_merge.
+ *
+ * struct Params fit_linear_minibatch(struct LinearModel* linear_model, size_t batch_size,
+ *                                    lehmer_state_t* state)
+ *   - Trains the model's params with mini-batch gradient descent, one step per batch.
+ *   - Every epoch visits the points in a fresh Fisher-Yates order drawn from state, and each
+ *     batch is gathered into contiguous buffers before the fused gradient pass.
+ *
  * IMPORTANT NOTES:
  *   - Differentiation is the process of finding derivatives.
  *   - The chain rule is used to differentiate composite functions, e.g., f(g(x)).
@@ -68,41 +86,45 @@
  *
  */
 
+#define LOG_MODULE_ID LOG_MODULE_LINEAR
+
+#include "../include/lehmer.h"
+#include "../include/linear.h"
 #include "../include/logger.h"
 #include "../include/vector.h"
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Points summed in plain double precision before joining the compensated sums
+#define LINEAR_BLOCK 256
+
+// Independent partial sums per block
+#define LINEAR_STATS_LANES 4
+
 // technically, we just have scalars, vectors, and matrices
 // so we only have a number (typically a float); a point on a line?
 // list of numbers; the standard vector, e.g. [i_1, i_2, i_3, ..., i_n]
 // a "grid" of numbers; the standard matrix, e.g. [[n_1, n_2], [n_3, n_4]]
 // the tricky part is managing the coordinates and dimensions
 
-struct Params {
-    float slope;
-    float intercept;
-};
-
-struct LinearModel {
-    struct Vector* X;
-    struct Vector* Y;
-    struct Params* params;
-    float          learning_rate;
-    size_t         iterations;
-};
-
 struct LinearModel* create_linear_model(size_t size, float learning_rate, size_t iterations) {
     struct LinearModel* linear_model = (struct LinearModel*) malloc(sizeof(struct LinearModel));
 
-    linear_model->X             = vector_create(size);
-    linear_model->Y             = vector_create(size);
-    linear_model->learning_rate = learning_rate; // 1 * 10^-5
-    linear_model->slope         = 1.0f;
-    linear_model->intercept     = 1.0f;
+    linear_model->X                 = vector_create(size);
+    linear_model->Y                 = vector_create(size);
+    linear_model->params            = (struct Params*) malloc(sizeof(struct Params));
+    linear_model->params->slope     = 1.0f;
+    linear_model->params->intercept = 1.0f;
+    linear_model->learning_rate     = learning_rate; // 1 * 10^-5
+    linear_model->iterations        = iterations;
 
     return linear_model;
 }
@@ -186,7 +208,7 @@ float mean_square_error(float X[], float Y[], size_t size, float m, float b) {
 float partial_derivative_m(float X[], float Y[], size_t size, float m, float b) {
     float sum = 0.0f;
     for (size_t i = 0; i < size; i++) {
-        sum += X[i] * (slope_intercept_form(X[i], m, b) - Y[i]);
+        sum += X[i] * (Y[i] - slope_intercept_form(X[i], m, b));
     }
     return -2.0f / size * sum;
 }
@@ -208,28 +230,413 @@ float partial_derivative_m(float X[], float Y[], size_t size, float m, float b)
 float partial_derivative_b(float X[], float Y[], size_t size, float m, float b) {
     float sum = 0.0f;
     for (size_t i = 0; i < size; i++) {
-        sum += (slope_intercept_form(X[i], m, b) - Y[i]);
+        sum += (Y[i] - slope_intercept_form(X[i], m, b));
     }
     return -2.0f / size * sum;
 }
 
-float fit_linear_regression(
-    float X[], float Y[], size_t size, float learning_rate, size_t iterations
+/**
+ * @brief Calculates the mean squared error and its partial derivatives in one pass.
+ *
+ * Equivalent to mean_square_error, partial_derivative_m and partial_derivative_b, but
+ * reads X and Y once and evaluates the line once per point. The sums are split across
+ * LINEAR_LANES independent accumulators, which also keeps rounding error lower than a
+ * single running sum.
+ *
+ * @param X An array of x-values.
+ * @param Y An array of corresponding y-values.
+ * @param size The size of the arrays.
+ * @param m The slope of the line.
+ * @param b The y-intercept of the line.
+ * @return The mean squared error and the partial derivatives with respect to m and b.
+ */
+struct Gradient mean_square_error_gradient(
+    const float X[], const float Y[], size_t size, float m, float b
 ) {
-    float  m = 1.0f;
-    float  b = 1.0f;
-    size_t n = size;
+    struct Gradient gradient = {0.0f, 0.0f, 0.0f};
+    if (0 == size) {
+        return gradient; // Guard against division by zero
+    }
+
+    float  error[LINEAR_LANES] = {0.0f}; // Σr^2
+    float  slope[LINEAR_LANES] = {0.0f}; // Σxr
+    float  shift[LINEAR_LANES] = {0.0f}; // Σr
+    size_t i                   = 0;
+
+#if defined(__AVX2__)
+    __m256 m8     = _mm256_set1_ps(m);
+    __m256 b8     = _mm256_set1_ps(b);
+    __m256 error8 = _mm256_setzero_ps();
+    __m256 slope8 = _mm256_setzero_ps();
+    __m256 shift8 = _mm256_setzero_ps();
+
+    for (; i + LINEAR_LANES <= size; i += LINEAR_LANES) {
+        __m256 x = _mm256_loadu_ps(X + i);
+        __m256 r = _mm256_sub_ps(_mm256_loadu_ps(Y + i), _mm256_add_ps(_mm256_mul_ps(m8, x), b8));
+
+        error8 = _mm256_add_ps(error8, _mm256_mul_ps(r, r));
+        slope8 = _mm256_add_ps(slope8, _mm256_mul_ps(x, r));
+        shift8 = _mm256_add_ps(shift8, r);
+    }
+
+    _mm256_storeu_ps(error, error8);
+    _mm256_storeu_ps(slope, slope8);
+    _mm256_storeu_ps(shift, shift8);
+#else
+    for (; i + LINEAR_LANES <= size; i += LINEAR_LANES) {
+        for (size_t j = 0; j < LINEAR_LANES; j++) {
+            float r   = Y[i + j] - slope_intercept_form(X[i + j], m, b);
+            error[j] += r * r;
+            slope[j] += X[i + j] * r;
+            shift[j] += r;
+        }
+    }
+#endif
+
+    // Remaining points go to the first lanes
+    for (size_t j = 0; i < size; i++, j++) {
+        float r   = Y[i] - slope_intercept_form(X[i], m, b);
+        error[j] += r * r;
+        slope[j] += X[i] * r;
+        shift[j] += r;
+    }
+
+    for (size_t j = 0; j < LINEAR_LANES; j++) {
+        gradient.mse  += error[j];
+        gradient.dedm += slope[j];
+        gradient.dedb += shift[j];
+    }
+
+    gradient.mse  /= size;
+    gradient.dedm *= -2.0f / size;
+    gradient.dedb *= -2.0f / size;
+    return gradient;
+}
 
-    float mse, dedm, dedb;
+/**
+ * @brief Fits a line to a set of points with gradient descent.
+ *
+ * Starts from m = b = 1 and takes iterations steps of learning_rate against the
+ * gradient of the mean squared error, one fused pass over the data per step.
+ *
+ * @param X An array of x-values.
+ * @param Y An array of corresponding y-values.
+ * @param size The size of the arrays.
+ * @param learning_rate The step size.
+ * @param iterations The number of steps.
+ * @return The fitted slope and intercept.
+ */
+struct Params fit_linear_regression(
+    float X[], float Y[], size_t size, float learning_rate, size_t iterations
+) {
+    struct Params   params   = {1.0f, 1.0f};
+    struct Gradient gradient = {0.0f, 0.0f, 0.0f};
 
     for (size_t i = 0; i < iterations; i++) {
-        mse  = mean_square_error(X, Y, size, m, b);
-        dedm = partial_derivative_m(X, Y, size, m, b);
-        dedb = partial_derivative_b(X, Y, size, m, b);
+        gradient = mean_square_error_gradient(X, Y, size, params.slope, params.intercept);
+
+        params.slope     -= learning_rate * gradient.dedm;
+        params.intercept -= learning_rate * gradient.dedb;
+    }
+
+    LOG(&global_logger,
+        LOG_LEVEL_DEBUG,
+        "fit: %zu iterations, mse %f\n",
+        iterations,
+        (double) gradient.mse);
+
+    return params;
+}
+
+/**
+ * @brief Adds value to a sum, accumulating the rounding error in compensation.
+ *
+ * Neumaier's variant of Kahan summation: the lost low-order bits of whichever operand
+ * is smaller are kept, so sum + compensation stays accurate for any order of magnitudes.
+ */
+static inline void linear_sum_add(double* sum, double* compensation, double value) {
+    double total = *sum + value;
+    if ((*sum < 0 ? -*sum : *sum) >= (value < 0 ? -value : value)) {
+        *compensation += (*sum - total) + value;
+    } else {
+        *compensation += (value - total) + *sum;
+    }
+    *sum = total;
+}
 
-        m = m - learning_rate * dedm;
-        b = b - learning_rate * dedb;
+/**
+ * @brief Adds a set of points to the sufficient statistics of a line.
+ *
+ * A product of two floats is exact in double precision, so the only rounding is in the
+ * sums. Points are summed in blocks of LINEAR_BLOCK across LINEAR_STATS_LANES partial
+ * sums, and each partial sum joins the running totals through a compensated add.
+ *
+ * @param stats The statistics to update.
+ * @param X An array of x-values.
+ * @param Y An array of corresponding y-values.
+ * @param size The size of the arrays.
+ */
+void linear_stats_update(struct LinearStats* stats, const float X[], const float Y[], size_t size) {
+    for (size_t i = 0; i < size; i += LINEAR_BLOCK) {
+        size_t end                    = size - i < LINEAR_BLOCK ? size : i + LINEAR_BLOCK;
+        double x[LINEAR_STATS_LANES]  = {0.0};
+        double y[LINEAR_STATS_LANES]  = {0.0};
+        double xx[LINEAR_STATS_LANES] = {0.0};
+        double xy[LINEAR_STATS_LANES] = {0.0};
+        size_t j                      = i;
+
+        // Independent lanes, so the adds need not wait on each other
+        for (; j + LINEAR_STATS_LANES <= end; j += LINEAR_STATS_LANES) {
+            for (size_t k = 0; k < LINEAR_STATS_LANES; k++) {
+                double xk  = X[j + k];
+                double yk  = Y[j + k];
+                x[k]      += xk;
+                y[k]      += yk;
+                xx[k]     += xk * xk;
+                xy[k]     += xk * yk;
+            }
+        }
+        for (size_t k = 0; j < end; j++, k++) {
+            double xj  = X[j];
+            double yj  = Y[j];
+            x[k]      += xj;
+            y[k]      += yj;
+            xx[k]     += xj * xj;
+            xy[k]     += xj * yj;
+        }
+
+        for (size_t k = 0; k < LINEAR_STATS_LANES; k++) {
+            linear_sum_add(&stats->x, &stats->x_c, x[k]);
+            linear_sum_add(&stats->y, &stats->y_c, y[k]);
+            linear_sum_add(&stats->xx, &stats->xx_c, xx[k]);
+            linear_sum_add(&stats->xy, &stats->xy_c, xy[k]);
+        }
     }
+    stats->n += size;
+}
+
+/**
+ * @brief Combines the statistics of two disjoint sets of points.
+ *
+ * @param stats The statistics to update.
+ * @param other The statistics to add; unchanged.
+ */
+void linear_stats_merge(struct LinearStats* stats, const struct LinearStats* other) {
+    linear_sum_add(&stats->x, &stats->x_c, other->x);
+    linear_sum_add(&stats->y, &stats->y_c, other->y);
+    linear_sum_add(&stats->xx, &stats->xx_c, other->xx);
+    linear_sum_add(&stats->xy, &stats->xy_c, other->xy);
+
+    stats->x_c  += other->x_c;
+    stats->y_c  += other->y_c;
+    stats->xx_c += other->xx_c;
+    stats->xy_c += other->xy_c;
+    stats->n    += other->n;
+}
+
+/**
+ * @brief Solves for the least squares line of the points in a set of statistics.
+ *
+ * Centers the sums on the mean of x before dividing, which keeps the variance accurate
+ * when the mean is large compared to the spread.
+ *
+ * @param stats The statistics of the points.
+ * @param params Receives the slope and intercept. If x does not vary, the slope is 0
+ *               and the intercept is the mean of y.
+ * @return True if the line is unique, false otherwise.
+ */
+bool linear_stats_solve(const struct LinearStats* stats, struct Params* params) {
+    params->slope     = 0.0f;
+    params->intercept = 0.0f;
+    if (0 == stats->n) {
+        return false;
+    }
+
+    double n  = (double) stats->n;
+    double x  = stats->x + stats->x_c;
+    double y  = stats->y + stats->y_c;
+    double xx = stats->xx + stats->xx_c;
+    double xy = stats->xy + stats->xy_c;
+
+    double mean_x = x / n;
+    double sxx    = xx - mean_x * x; // n * variance of x
+    double sxy    = xy - mean_x * y; // n * covariance of x and y
+
+    params->intercept = (float) (y / n);
+    if (!(sxx > 0.0)) {
+        return false;
+    }
+
+    double slope      = sxy / sxx;
+    params->slope     = (float) slope;
+    params->intercept = (float) ((y - slope * x) / n);
+    return true;
+}
+
+struct LinearWorker {
+    const float*       X;
+    const float*       Y;
+    size_t             size;
+    struct LinearStats stats;
+};
+
+static void* linear_stats_worker(void* argument) {
+    struct LinearWorker* worker = (struct LinearWorker*) argument;
+    linear_stats_update(&worker->stats, worker->X, worker->Y, worker->size);
+    return NULL;
+}
+
+/**
+ * @brief Fits a line to a set of points with ordinary least squares.
+ *
+ * One pass over the data, split into contiguous chunks with one thread per chunk. The
+ * chunk statistics are merged in order, so the result does not depend on scheduling.
+ * A chunk whose thread cannot be started is summed by the caller.
+ *
+ * @param X An array of x-values.
+ * @param Y An array of corresponding y-values.
+ * @param size The size of the arrays.
+ * @param threads The number of threads; 0 or 1 sums on the calling thread.
+ * @return The fitted slope and intercept.
+ */
+struct Params fit_linear_ols(const float X[], const float Y[], size_t size, size_t threads) {
+    struct Params params = {0.0f, 0.0f};
+
+    if (threads < 2 || size < threads * LINEAR_BLOCK) {
+        threads = 1;
+    }
+
+    struct LinearWorker* workers
+        = (struct LinearWorker*) calloc(threads, sizeof(struct LinearWorker));
+    pthread_t* handles = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    bool*      started = (bool*) calloc(threads, sizeof(bool));
+
+    for (size_t t = 0; t < threads; t++) {
+        size_t start    = size * t / threads;
+        size_t end      = size * (t + 1) / threads;
+        workers[t].X    = X + start;
+        workers[t].Y    = Y + start;
+        workers[t].size = end - start;
+
+        // The caller takes the first chunk
+        if (t > 0) {
+            started[t] = 0 == pthread_create(&handles[t], NULL, linear_stats_worker, &workers[t]);
+        }
+    }
+
+    for (size_t t = 0; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(handles[t], NULL);
+        } else {
+            linear_stats_worker(&workers[t]);
+        }
+        if (t > 0) {
+            linear_stats_merge(&workers[0].stats, &workers[t].stats);
+        }
+    }
+
+    if (!linear_stats_solve(&workers[0].stats, &params)) {
+        LOG(&global_logger,
+            LOG_LEVEL_WARN,
+            "fit_linear_ols: x does not vary over %zu points\n",
+            size);
+    }
+
+    free(workers);
+    free(handles);
+    free(started);
+    return params;
+}
+
+/**
+ * @brief Fills order with a uniformly random permutation of 0 .. n - 1.
+ *
+ * Fisher-Yates: each position from the back swaps with a position drawn from those not
+ * yet fixed. lehmer_bounded is unbiased, so every permutation is equally likely.
+ *
+ * @param order Receives the permutation.
+ * @param n The number of indices, at most LEHMER_RANGE_MAX.
+ * @param state The generator to draw from, on its selected stream.
+ */
+void linear_shuffle(uint32_t* order, size_t n, lehmer_state_t* state) {
+    for (size_t i = 0; i < n; i++) {
+        order[i] = (uint32_t) i;
+    }
+    for (size_t i = n; i > 1; i--) {
+        uint32_t j   = lehmer_bounded(state, (uint32_t) i);
+        uint32_t t   = order[i - 1];
+        order[i - 1] = order[j];
+        order[j]     = t;
+    }
+}
+
+/**
+ * @brief Trains a model with mini-batch stochastic gradient descent.
+ *
+ * Runs linear_model->iterations epochs from the current params. Each epoch shuffles the
+ * points and walks them in batches of batch_size: the batch is gathered into two
+ * contiguous buffers, then one fused pass gives the gradient for one step of
+ * linear_model->learning_rate. The last batch of an epoch may be smaller.
+ *
+ * @param linear_model The model, whose params are updated in place.
+ * @param batch_size Points per step; 0 uses every point, i.e. full-batch descent.
+ * @param state The generator for the shuffles; the same seed gives the same params.
+ * @return The trained slope and intercept.
+ */
+struct Params fit_linear_minibatch(
+    struct LinearModel* linear_model, size_t batch_size, lehmer_state_t* state
+) {
+    struct Params* params = linear_model->params;
+    size_t         n      = linear_model->X->dimensions;
+
+    if (n > LEHMER_RANGE_MAX) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "fit_linear_minibatch: %zu points exceed the shuffle range\n",
+            n);
+        return *params;
+    }
+    if (0 == batch_size || batch_size > n) {
+        batch_size = n;
+    }
+
+    uint32_t* order   = (uint32_t*) malloc(sizeof(uint32_t) * n);
+    float*    batch_x = (float*) malloc(sizeof(float) * batch_size);
+    float*    batch_y = (float*) malloc(sizeof(float) * batch_size);
+
+    const float*    X        = linear_model->X->elements;
+    const float*    Y        = linear_model->Y->elements;
+    struct Gradient gradient = {0.0f, 0.0f, 0.0f};
+
+    for (size_t epoch = 0; epoch < linear_model->iterations; epoch++) {
+        linear_shuffle(order, n, state);
+
+        for (size_t start = 0; start < n; start += batch_size) {
+            size_t count = n - start < batch_size ? n - start : batch_size;
+
+            for (size_t i = 0; i < count; i++) {
+                uint32_t k = order[start + i];
+                batch_x[i] = X[k];
+                batch_y[i] = Y[k];
+            }
+
+            gradient = mean_square_error_gradient(
+                batch_x, batch_y, count, params->slope, params->intercept
+            );
+            params->slope     -= linear_model->learning_rate * gradient.dedm;
+            params->intercept -= linear_model->learning_rate * gradient.dedb;
+        }
+    }
+
+    LOG(&global_logger,
+        LOG_LEVEL_DEBUG,
+        "fit_linear_minibatch: %zu epochs of batch %zu, last batch mse %f\n",
+        linear_model->iterations,
+        batch_size,
+        (double) gradient.mse);
 
-    return {m, b}; // we need to create a struct to track everything the right way
+    free(order);
+    free(batch_x);
+    free(batch_y);
+    return *params;
 }
@@ -0,0 +1,38 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file source/log_decoder.c
+ *
+ * @brief Renders binary logs written by logger_start_binary as text
+ *
+ * Build:
+ *   gcc -O2 -o log_decoder source/log_decoder.c source/logger.c -lpthread
+ *
+ * Usage:
+ *   ./log_decoder [binary.log] > text.log
+ *
+ * Reads standard input when no file is given. Decode on the platform that
+ * wrote the log; records use its byte order and type sizes.
+ */
+
+#include "../include/logger.h"
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [binary.log]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* input = 2 == argc ? fopen(argv[1], "rb") : stdin;
+    if (NULL == input) {
+        fprintf(stderr, "Failed to open %s: %s\n", argv[1], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    bool result = logger_decode(input, stdout);
+
+    if (stdin != input) {
+        fclose(input);
+    }
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
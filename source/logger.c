@@ -6,8 +6,518 @@
 
 #include "../include/logger.h"
 
+#include <fcntl.h>
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
 const char* LOG_TYPE_NAME[] = {"unknown", "stream", "file"};
 
+/**
+ * @brief Formats the level prefix of a message, e.g. "[ERROR:No such file] ".
+ *
+ * @return The number of characters written, excluding the terminator.
+ */
+static int logger_format_prefix(char* buffer, size_t size, log_level_t log_level, int err) {
+    switch (log_level) {
+        case LOG_LEVEL_DEBUG:
+            return snprintf(buffer, size, "[DEBUG] ");
+        case LOG_LEVEL_INFO:
+            return snprintf(buffer, size, "[INFO] ");
+        case LOG_LEVEL_WARN:
+            if (err != 0) {
+                return snprintf(buffer, size, "[WARN:%s] ", strerror(err));
+            }
+            return snprintf(buffer, size, "[WARN] ");
+        case LOG_LEVEL_ERROR:
+            if (err != 0) {
+                return snprintf(buffer, size, "[ERROR:%s] ", strerror(err));
+            }
+            return snprintf(buffer, size, "[ERROR] ");
+    }
+    return 0;
+}
+
+static uint64_t log_clock(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * @brief Per-thread copy of the time and thread ID as last formatted.
+ *
+ * The coarse clock only advances once per kernel tick, so most lines reuse
+ * the text instead of converting digits again.
+ */
+typedef struct LogStamp {
+    uint64_t millis;          /**< Milliseconds since the epoch of time. */
+    int32_t  thread;          /**< Kernel thread ID, 0 until looked up. */
+    uint8_t  time_length;     /**< Bytes in time. */
+    uint8_t  thread_length;   /**< Bytes in thread_text. */
+    char     time[24];        /**< "seconds.millis" */
+    char     thread_text[12]; /**< Decimal thread ID. */
+} log_stamp_t;
+
+static pthread_once_t            log_clock_once = PTHREAD_ONCE_INIT;
+static uint64_t                  log_clock_offset; /**< CLOCK_REALTIME - CLOCK_MONOTONIC_COARSE */
+static _Thread_local log_stamp_t log_stamp;
+
+static void log_clock_calibrate(void) {
+    log_clock_offset = log_clock(CLOCK_REALTIME) - log_clock(CLOCK_MONOTONIC_COARSE);
+}
+
+uint64_t logger_timestamp(void) {
+    pthread_once(&log_clock_once, log_clock_calibrate);
+    return log_clock(CLOCK_MONOTONIC_COARSE) + log_clock_offset;
+}
+
+/**
+ * @brief A message being formatted, apart from its format arguments.
+ */
+typedef struct LogEntry {
+    log_format_t       format; /**< Line layout. */
+    log_level_t        level;  /**< Level of the message. */
+    int                err;    /**< errno when the message was logged. */
+    const log_field_t* fields; /**< Structured fields, NULL if count is 0. */
+    size_t             count;  /**< Number of fields. */
+} log_entry_t;
+
+/**
+ * @brief A line under construction in a fixed buffer.
+ *
+ * Appends that do not fit are cut short and set truncated; used never
+ * exceeds size - 1, leaving room for the terminator.
+ */
+typedef struct LogText {
+    char*  data;      /**< Destination buffer. */
+    size_t size;      /**< Capacity of data in bytes. */
+    size_t used;      /**< Bytes written, excluding the terminator. */
+    bool   truncated; /**< Something did not fit. */
+} log_text_t;
+
+static const char* const LOG_LEVEL_NAME[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+static void log_text_append(log_text_t* text, const char* data, size_t length) {
+    size_t room = text->size - 1 - text->used;
+    if (length > room) {
+        length          = room;
+        text->truncated = true;
+    }
+
+    // Most pieces are a few bytes, where a loop beats a call to memcpy
+    char* next = text->data + text->used;
+    if (length <= 16) {
+        for (size_t i = 0; i < length; i++) {
+            next[i] = data[i];
+        }
+    } else {
+        memcpy(next, data, length);
+    }
+    text->used += length;
+}
+
+static void log_text_char(log_text_t* text, char c) {
+    log_text_append(text, &c, 1);
+}
+
+static void log_text_string(log_text_t* text, const char* string) {
+    log_text_append(text, string, strlen(string));
+}
+
+// Decimal digits without snprintf, zero-padded to at least width
+static void log_text_unsigned(log_text_t* text, unsigned long long value, int width) {
+    char  digits[24];
+    char* end  = digits + sizeof(digits);
+    char* next = end;
+    do {
+        *--next  = (char) ('0' + value % 10);
+        value   /= 10;
+    } while (0 != value || end - next < width);
+    log_text_append(text, next, (size_t) (end - next));
+}
+
+static void log_text_signed(log_text_t* text, long long value) {
+    if (value < 0) {
+        log_text_char(text, '-');
+        log_text_unsigned(text, 0ull - (unsigned long long) value, 1);
+    } else {
+        log_text_unsigned(text, (unsigned long long) value, 1);
+    }
+}
+
+static void log_text_vformat(log_text_t* text, const char* format, va_list args) {
+    size_t room   = text->size - text->used;
+    int    length = vsnprintf(text->data + text->used, room, format, args);
+    if (length < 0) {
+        return;
+    }
+    if ((size_t) length >= room) {
+        length          = (int) room - 1;
+        text->truncated = true;
+    }
+    text->used += (size_t) length;
+}
+
+static void log_text_format(log_text_t* text, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_text_vformat(text, format, args);
+    va_end(args);
+}
+
+// A JSON string body: quotes, backslashes and control characters escaped
+static void log_text_escaped(log_text_t* text, const char* string, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+
+    size_t run = 0; // start of the pending unescaped bytes
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char) string[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        log_text_append(text, string + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':
+                log_text_string(text, "\\\"");
+                break;
+            case '\\':
+                log_text_string(text, "\\\\");
+                break;
+            case '\n':
+                log_text_string(text, "\\n");
+                break;
+            case '\t':
+                log_text_string(text, "\\t");
+                break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                log_text_append(text, escape, sizeof(escape));
+            }
+        }
+    }
+    log_text_append(text, string + run, length - run);
+}
+
+// Plain values are quoted only when they would not read back as one token
+static bool log_field_needs_quotes(const char* string) {
+    if ('\0' == *string) {
+        return true;
+    }
+    for (; '\0' != *string; string++) {
+        unsigned char c = (unsigned char) *string;
+        if (c <= ' ' || c == '"' || c == '=' || c == '\\') {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void log_text_field(log_text_t* text, const log_field_t* field, bool json) {
+    if (json) {
+        log_text_string(text, ",\"");
+        log_text_escaped(text, field->key, strlen(field->key));
+        log_text_string(text, "\":");
+    } else {
+        log_text_char(text, ' ');
+        log_text_string(text, field->key);
+        log_text_char(text, '=');
+    }
+
+    switch (field->type) {
+        case LOG_FIELD_INT:
+            log_text_signed(text, field->value.integer);
+            break;
+        case LOG_FIELD_DOUBLE:
+            // JSON has no literal for NaN or infinity
+            if (json && (isnan(field->value.real) || isinf(field->value.real))) {
+                log_text_format(text, "\"%g\"", field->value.real);
+            } else {
+                log_text_format(text, "%.15g", field->value.real);
+            }
+            break;
+        case LOG_FIELD_STRING: {
+            const char* string = field->value.string;
+            if (NULL == string) {
+                log_text_string(text, json ? "null" : "(null)");
+            } else if (json || log_field_needs_quotes(string)) {
+                log_text_char(text, '"');
+                log_text_escaped(text, string, strlen(string));
+                log_text_char(text, '"');
+            } else {
+                log_text_string(text, string);
+            }
+            break;
+        }
+        case LOG_FIELD_BOOL:
+            log_text_string(text, field->value.boolean ? "true" : "false");
+            break;
+    }
+}
+
+/**
+ * @brief Appends the message and its fields as plain text.
+ *
+ * Without fields the message is copied as formatted. Otherwise the fields
+ * go between the message and its trailing newline.
+ */
+static void log_text_body(
+    log_text_t* text, const log_entry_t* entry, const char* format, va_list args
+) {
+    log_text_vformat(text, format, args);
+    if (0 == entry->count) {
+        return;
+    }
+
+    if (text->used > 0 && '\n' == text->data[text->used - 1]) {
+        text->used--;
+    }
+    for (size_t i = 0; i < entry->count; i++) {
+        log_text_field(text, &entry->fields[i], false);
+    }
+    log_text_char(text, '\n');
+}
+
+// Seconds since the epoch with milliseconds, the resolution of the coarse clock
+static void log_text_time(log_text_t* text) {
+    log_stamp_t* stamp  = &log_stamp;
+    uint64_t     millis = logger_timestamp() / 1000000ull;
+
+    if (millis != stamp->millis || 0 == stamp->time_length) {
+        log_text_t cache = {stamp->time, sizeof(stamp->time), 0, false};
+        log_text_unsigned(&cache, millis / 1000, 1);
+        log_text_char(&cache, '.');
+        log_text_unsigned(&cache, millis % 1000, 3);
+        stamp->millis      = millis;
+        stamp->time_length = (uint8_t) cache.used;
+    }
+    log_text_append(text, stamp->time, stamp->time_length);
+}
+
+static void log_text_thread(log_text_t* text) {
+    log_stamp_t* stamp = &log_stamp;
+
+    if (0 == stamp->thread) {
+        log_text_t cache = {stamp->thread_text, sizeof(stamp->thread_text), 0, false};
+        stamp->thread    = (int32_t) syscall(SYS_gettid);
+        log_text_signed(&cache, stamp->thread);
+        stamp->thread_length = (uint8_t) cache.used;
+    }
+    log_text_append(text, stamp->thread_text, stamp->thread_length);
+}
+
+// Bytes a character takes once escaped inside a JSON string
+static size_t log_escaped_width(unsigned char c) {
+    if (c >= 0x20 && c != '"' && c != '\\') {
+        return 1;
+    }
+    return (c == '"' || c == '\\' || c == '\n' || c == '\t') ? 2 : 6;
+}
+
+/**
+ * @brief Escapes the message formatted at start in place, keeping only the
+ * characters whose escapes fit whole.
+ *
+ * Escapes never shrink, so writing from the back never overtakes the bytes
+ * still to be read. A message cut inside a multibyte character loses all of
+ * that character.
+ */
+static void log_text_escape_message(log_text_t* text, size_t start) {
+    static const char hex[] = "0123456789abcdef";
+
+    unsigned char* message = (unsigned char*) text->data + start;
+    size_t         length  = text->used - start;
+    size_t         room    = text->size - 1 - start;
+    size_t         width   = 0;
+    size_t         count   = 0;
+    for (; count < length; count++) {
+        size_t next = log_escaped_width(message[count]);
+        if (width + next > room) {
+            text->truncated = true;
+            break;
+        }
+        width += next;
+    }
+
+    // Back up to the lead byte of the last character and drop it if cut short
+    if (text->truncated) {
+        size_t lead = count;
+        while (lead > 0 && count - lead < 3 && 0x80 == (message[lead - 1] & 0xC0)) {
+            lead--;
+        }
+        if (lead > 0 && message[lead - 1] >= 0xC0) {
+            unsigned char c    = message[lead - 1];
+            size_t        need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            if (count - lead + 1 < need) {
+                width -= count - lead + 1;
+                count  = lead - 1;
+            }
+        }
+    }
+
+    text->used = start + width;
+    if (width == count) {
+        return;
+    }
+
+    unsigned char* out = message + width;
+    for (size_t i = count; i-- > 0;) {
+        unsigned char c = message[i];
+        switch (log_escaped_width(c)) {
+            case 1:
+                *--out = c;
+                break;
+            case 2:
+                *--out = c == '\n' ? 'n' : c == '\t' ? 't' : c;
+                *--out = '\\';
+                break;
+            default:
+                out    -= 6;
+                out[0]  = '\\';
+                out[1]  = 'u';
+                out[2]  = '0';
+                out[3]  = '0';
+                out[4]  = (unsigned char) hex[c >> 4];
+                out[5]  = (unsigned char) hex[c & 0xF];
+        }
+    }
+}
+
+/**
+ * @brief Appends a whole line as one JSON object.
+ *
+ * The closing quote and the fields are formatted first and parked at the end
+ * of the buffer, so the message only gets the room they leave. A field that
+ * does not fit is dropped whole, and a cut line says so with a truncated
+ * member rather than losing its closing brace.
+ */
+static void log_text_json(
+    log_text_t* text, const log_entry_t* entry, const uint64_t* sequence, const char* format,
+    va_list args
+) {
+    static const char truncated[] = ",\"truncated\":true";
+    const size_t      closing     = sizeof(truncated) - 1 + 2; // and "}\n"
+
+    log_text_string(text, "{\"ts\":");
+    log_text_time(text);
+    log_text_string(text, ",\"tid\":");
+    log_text_thread(text);
+    log_text_string(text, ",\"level\":\"");
+    log_text_string(text, LOG_LEVEL_NAME[entry->level]);
+    log_text_char(text, '"');
+    if (0 != entry->err && entry->level >= LOG_LEVEL_WARN) {
+        log_text_string(text, ",\"error\":\"");
+        log_text_string(text, strerror(entry->err));
+        log_text_char(text, '"');
+    }
+    if (NULL != sequence) {
+        log_text_string(text, ",\"seq\":");
+        log_text_unsigned(text, *sequence, 1);
+    }
+    log_text_string(text, ",\"msg\":\"");
+
+    size_t start = text->used;
+    size_t size  = text->size;
+    if (start + closing + 2 > size) {
+        return; // Too small for any object; the caller still ends the line
+    }
+
+    log_text_t tail = {text->data + start, size - start - closing, 0, false};
+    log_text_char(&tail, '"');
+    for (size_t i = 0; i < entry->count; i++) {
+        size_t mark = tail.used;
+        log_text_field(&tail, &entry->fields[i], true);
+        if (tail.truncated) {
+            tail.used       = mark;
+            tail.truncated  = false;
+            text->truncated = true;
+        }
+    }
+    char* parked = text->data + size - tail.used;
+    memmove(parked, tail.data, tail.used);
+
+    // Format in place in what is left, then escape in place if needed
+    bool dropped    = text->truncated;
+    text->truncated = false;
+    text->size      = size - tail.used - closing;
+    log_text_vformat(text, format, args);
+    while (text->used > start && '\n' == text->data[text->used - 1]) {
+        text->used--;
+    }
+    log_text_escape_message(text, start);
+    text->size       = size;
+    text->truncated |= dropped;
+
+    memmove(text->data + text->used, parked, tail.used);
+    text->used += tail.used;
+    if (text->truncated) {
+        log_text_string(text, truncated);
+    }
+    log_text_string(text, "}\n");
+}
+
+/**
+ * @brief Terminates a line, keeping the trailing newline of a truncated one
+ * so lines stay separate.
+ *
+ * @return The number of bytes in the line, excluding the terminator.
+ */
+static size_t log_text_finish(log_text_t* text) {
+    if (text->truncated && text->used > 0) {
+        text->data[text->used - 1] = '\n';
+    }
+    text->data[text->used] = '\0';
+    return text->used;
+}
+
+/**
+ * @brief Formats a whole line into text in the entry's layout, truncating it
+ * to fit.
+ *
+ * @param sequence The message number to include, or NULL for none.
+ *
+ * @return The number of bytes in the line, excluding the terminator.
+ */
+static size_t logger_format_message(
+    log_text_t* text, const log_entry_t* entry, const uint64_t* sequence, const char* format,
+    va_list args
+) {
+    if (LOG_FORMAT_JSON == entry->format) {
+        log_text_json(text, entry, sequence, format, args);
+        return log_text_finish(text);
+    }
+
+    if (NULL != sequence) {
+        log_text_unsigned(text, *sequence, 1);
+        log_text_char(text, ' ');
+    }
+    if (LOG_FORMAT_STAMPED == entry->format) {
+        log_text_time(text);
+        log_text_char(text, ' ');
+        log_text_thread(text);
+        log_text_char(text, ' ');
+    }
+
+    int prefix = logger_format_prefix(
+        text->data + text->used, text->size - text->used, entry->level, entry->err
+    );
+    if (prefix > 0) {
+        text->used += (size_t) prefix < text->size - text->used ? (size_t) prefix
+                                                                : text->size - text->used - 1;
+    }
+
+    log_text_body(text, entry, format, args);
+    return log_text_finish(text);
+}
+
 /**
  * @brief Sets the logger type and name.
  *
@@ -108,6 +618,9 @@ struct Logger* logger_new(log_type_t log_type) {
 
     logger->file_path   = NULL;
     logger->file_stream = NULL;
+    logger->async       = NULL;
+    logger->buffered    = NULL;
+    logger->log_format  = LOG_FORMAT_PLAIN;
 
     // Initialize the mutex for thread safety
     int error_code = pthread_mutex_init(&logger->thread_lock, NULL);
@@ -169,11 +682,16 @@ struct Logger* logger_create(log_level_t log_level, log_type_t log_type, const c
     return logger;
 }
 
+// Limited sites of a logger, defined with rate-limited logging below
+static void log_limit_release(struct Logger* logger);
+static void log_limit_tick(struct Logger* logger, uint64_t* due);
+
 /**
  * @brief Destroys a logger instance and releases associated resources.
  *
- * This function closes the log file associated with the logger, if any,
- * and frees the memory allocated for the logger instance.
+ * This function reports and unregisters the logger's limited sites, closes
+ * the log file associated with the logger, if any, and frees the memory
+ * allocated for the logger instance.
  *
  * @param logger A pointer to the logger instance to be destroyed.
  * @return True if the logger was successfully destroyed, false otherwise.
@@ -183,6 +701,14 @@ bool logger_destroy(struct Logger* logger) {
         return false;
     }
 
+    // Report suppressed counts while the logger can still write them, and
+    // keep its sites from reporting to it once it is gone
+    log_limit_release(logger);
+
+    // Drain queued and buffered messages before the stream goes away
+    logger_stop_async(logger);
+    logger_stop_buffered(logger);
+
     // Close the log file if it's a file logger
     if (LOG_TYPE_FILE == logger->log_type && NULL != logger->file_stream) {
         if (fclose(logger->file_stream) != 0) {
@@ -204,69 +730,2107 @@ bool logger_destroy(struct Logger* logger) {
 }
 
 /**
- * @brief Logs a message with the specified log level to the logger's file.
+ * @brief Asynchronous logging
  *
- * This function logs a message with the specified log level to the logger's
- * file. If the logger's log level is lower than the specified log level, the
- * message will not be logged.
- *
- * @param logger A pointer to the logger instance to use for logging.
- * @param log_level The log level of the message to be logged.
- * @param format The format string of the message to be logged.
- * @param ... Additional arguments for formatting the message (optional).
+ * The queue is a bounded ring of slots with per-slot sequence numbers
+ * (Vyukov's bounded queue). A producer claims the slot at the enqueue
+ * position with one compare-and-swap, formats into it, and publishes it by
+ * storing the next sequence number. The writer thread pops published slots
+ * in order, copies them into a batch buffer, and issues one write(2) per
+ * batch. Producers with the overwrite policy pop and discard the oldest slot
+ * the same way, which is why popping also uses compare-and-swap.
  *
- * @return true if the message was successfully logged, false otherwise.
+ * The writer sleeps on a condition variable only when the queue is empty, and
+ * producers signal it only when it is asleep; the timed wait bounds the delay
+ * of a wakeup that races with the writer going to sleep.
  */
-bool logger_message(struct Logger* logger, log_level_t log_level, const char* format, ...) {
-    // block if and only if the log_level is less than the logger->log_level
-    if (log_level < logger->log_level) {
-        return false; // Do not log messages below the current logger->log_level
+
+#define LOG_ASYNC_BATCH_SIZE (64 * 1024) // Bytes per write(2) call
+#define LOG_ASYNC_IDLE_NS    50000000    // Writer sleep between checks (50 ms)
+
+typedef struct LogSlot {
+    atomic_size_t sequence;                     /**< Position the slot is ready for. */
+    size_t        length;                       /**< Bytes of text in the slot. */
+    char          text[LOG_ASYNC_MESSAGE_SIZE]; /**< Formatted message. */
+} log_slot_t;
+
+struct LogAsync {
+    log_slot_t*         slots;    /**< Ring of capacity slots. */
+    size_t              mask;     /**< capacity - 1, capacity a power of two. */
+    log_policy_t        policy;   /**< Behavior when the ring is full. */
+    int                 fd;       /**< Descriptor written by the writer thread. */
+    struct Logger*      logger;   /**< Owning logger. */
+    struct LogAsync*    next;     /**< Next entry in the exit registry. */
+    struct LogSegments* segments; /**< Segment files replacing fd, or NULL. */
+    pthread_t           writer;   /**< Writer thread. */
+    pthread_mutex_t     lock;     /**< Guards sleeping and waking only. */
+    pthread_cond_t      wake;     /**< Signals the writer that work is queued. */
+    pthread_cond_t      drained;  /**< Signals flushers that the writer idled. */
+    atomic_bool         running;  /**< Cleared to stop the writer. */
+    atomic_bool         idle;     /**< True while the writer waits for work. */
+    atomic_size_t       dropped;  /**< Messages discarded by the policy. */
+    atomic_size_t       flushed;  /**< Every position below this is written. */
+    uint64_t            due;      /**< Next summary of limited sites, writer only. */
+
+    _Alignas(64) atomic_size_t enqueue; /**< Next position to claim. */
+    _Alignas(64) atomic_size_t dequeue; /**< Next position to pop. */
+};
+
+// Asynchronous loggers still running, drained by an exit handler
+static struct LogAsync* log_async_registry      = NULL;
+static pthread_mutex_t  log_async_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t   log_async_registry_once = PTHREAD_ONCE_INIT;
+
+// The logger whose writer is the calling thread, which must never wait for
+// room in its own queue
+static _Thread_local struct LogAsync* log_async_self = NULL;
+
+static void log_async_timeout(struct timespec* deadline, long nanoseconds) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_nsec += nanoseconds;
+    deadline->tv_sec  += deadline->tv_nsec / 1000000000L;
+    deadline->tv_nsec %= 1000000000L;
+}
+
+static void log_async_wake(struct LogAsync* async) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&async->idle, memory_order_relaxed)) {
+        pthread_mutex_lock(&async->lock);
+        pthread_cond_signal(&async->wake);
+        pthread_mutex_unlock(&async->lock);
     }
+}
 
-    int err = errno; // Capture errno at the start of the function to avoid changes
+// Pop the oldest published slot, or NULL if there is none yet
+static log_slot_t* log_async_pop(struct LogAsync* async, size_t* position) {
+    size_t pos = atomic_load_explicit(&async->dequeue, memory_order_relaxed);
+    for (;;) {
+        log_slot_t* slot     = &async->slots[pos & async->mask];
+        size_t      sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t    diff     = (intptr_t) sequence - (intptr_t) (pos + 1);
 
-    // Apply lazy initialization for global logger
-    if (NULL == logger->file_stream) {
-        logger->file_stream = stderr;
-        // WARN: DO NOT REINITIALIZE THE MUTEX
+        if (0 == diff) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &async->dequeue, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed
+                )) {
+                *position = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&async->dequeue, memory_order_relaxed);
+        }
     }
+}
 
-    // Only lock the thread if log_level is valid!
-    pthread_mutex_lock(&logger->thread_lock);
+// Hand a popped slot back to producers one lap later
+static void log_async_release(struct LogAsync* async, log_slot_t* slot, size_t position) {
+    atomic_store_explicit(&slot->sequence, position + async->mask + 1, memory_order_release);
+}
 
-    // Prefix log messages based on the level
-    switch (log_level) {
-        case LOG_LEVEL_DEBUG:
-            fprintf(logger->file_stream, "[DEBUG] ");
-            break;
-        case LOG_LEVEL_INFO:
-            fprintf(logger->file_stream, "[INFO] ");
-            break;
-        case LOG_LEVEL_WARN:
-            if (err != 0) {
-                fprintf(logger->file_stream, "[WARN:%s] ", strerror(err));
-            } else {
-                fprintf(logger->file_stream, "[WARN] ");
+// Claim a free slot, applying the policy while the ring is full
+static log_slot_t* log_async_claim(struct LogAsync* async, size_t* position) {
+    size_t pos = atomic_load_explicit(&async->enqueue, memory_order_relaxed);
+    for (;;) {
+        log_slot_t* slot     = &async->slots[pos & async->mask];
+        size_t      sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t    diff     = (intptr_t) sequence - (intptr_t) pos;
+
+        if (0 == diff) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &async->enqueue, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed
+                )) {
+                *position = pos;
+                return slot;
             }
-            break;
-        case LOG_LEVEL_ERROR:
-            if (err != 0) {
-                fprintf(logger->file_stream, "[ERROR:%s] ", strerror(err));
-            } else {
-                fprintf(logger->file_stream, "[ERROR] ");
+            continue;
+        }
+
+        if (diff < 0) {
+            size_t      oldest_position;
+            log_slot_t* oldest;
+
+            switch (log_async_self == async ? LOG_POLICY_DROP : async->policy) {
+                case LOG_POLICY_DROP:
+                    atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+                    return NULL;
+                case LOG_POLICY_OVERWRITE:
+                    oldest = log_async_pop(async, &oldest_position);
+                    if (NULL != oldest) {
+                        log_async_release(async, oldest, oldest_position);
+                        atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+                        break;
+                    }
+                    // The oldest slot is still being written; wait like BLOCK
+                    // fall through
+                case LOG_POLICY_BLOCK:
+                    log_async_wake(async);
+                    sched_yield();
+                    break;
             }
-            break;
+        }
+        pos = atomic_load_explicit(&async->enqueue, memory_order_relaxed);
     }
+}
 
-    va_list args;
-    va_start(args, format);
-    vfprintf(logger->file_stream, format, args);
-    va_end(args);
+static bool log_async_write(int fd, const char* buffer, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, buffer, size);
+        if (written < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        buffer += written;
+        size   -= (size_t) written;
+    }
+    return true;
+}
 
-    fflush(logger->file_stream); // Ensure the message is written immediately
+/**
+ * @brief Segment files
+ *
+ * The writer thread of a segmented logger copies each batch into a shared
+ * mapping of a preallocated file. Only opening and closing a segment make
+ * system calls. Segments are at least one batch long, so a batch is never
+ * split across two of them.
+ */
 
-    pthread_mutex_unlock(&logger->thread_lock);
+#define LOG_SEGMENT_PATH 4096 // Longest segment path
+
+typedef struct LogSegments {
+    log_segment_config_t config;  /**< Configuration; path is owned. */
+    char*                map;     /**< Mapping of the open segment, NULL if none. */
+    size_t               offset;  /**< Bytes written to the open segment. */
+    size_t               index;   /**< Number of the open or next segment. */
+    int                  fd;      /**< Descriptor of the open segment. */
+    time_t               opened;  /**< Monotonic seconds at opening. */
+    size_t               closed;  /**< Number of segments closed so far. */
+    char*                kept;    /**< Paths of the last config.keep closed segments. */
+} log_segments_t;
+
+static time_t log_segments_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return now.tv_sec;
+}
+
+static bool log_segments_open(log_segments_t* segments) {
+    char path[LOG_SEGMENT_PATH];
+    snprintf(path, sizeof(path), "%s.%06zu", segments->config.path, segments->index);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open log segment %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    // Reserve the blocks up front; a sparse file still works where that fails
+    off_t size = (off_t) segments->config.size;
+    if (0 != posix_fallocate(fd, 0, size) && 0 != ftruncate(fd, size)) {
+        fprintf(stderr, "Failed to size log segment %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(NULL, segments->config.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == map) {
+        fprintf(stderr, "Failed to map log segment %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    segments->map    = (char*) map;
+    segments->fd     = fd;
+    segments->offset = 0;
+    segments->opened = log_segments_now();
+    return true;
+}
+
+static void log_segments_close(log_segments_t* segments) {
+    if (NULL == segments->map) {
+        return;
+    }
+
+    char path[LOG_SEGMENT_PATH];
+    snprintf(path, sizeof(path), "%s.%06zu", segments->config.path, segments->index);
 
+    // Drop the unused preallocated tail
+    munmap(segments->map, segments->config.size);
+    if (0 != ftruncate(segments->fd, (off_t) segments->offset)) {
+        fprintf(stderr, "Failed to trim log segment %s: %s\n", path, strerror(errno));
+    }
+    close(segments->fd);
+    segments->map = NULL;
+    segments->index++;
+
+    char  compressed[LOG_SEGMENT_PATH] = "";
+    char* final                        = path;
+    if (NULL != segments->config.compress
+        && segments->config.compress(path, compressed, sizeof(compressed), segments->config.context)
+        && '\0' != compressed[0]) {
+        final = compressed;
+    }
+
+    // Delete the oldest kept segment once the ring is full
+    if (NULL != segments->kept) {
+        char* slot = segments->kept + segments->closed % segments->config.keep * LOG_SEGMENT_PATH;
+        if (segments->closed >= segments->config.keep) {
+            remove(slot);
+        }
+        snprintf(slot, LOG_SEGMENT_PATH, "%s", final);
+    }
+    segments->closed++;
+}
+
+static void log_segments_free(log_segments_t* segments) {
+    log_segments_close(segments);
+    free((char*) segments->config.path);
+    free(segments->kept);
+    free(segments);
+}
+
+static log_segments_t* log_segments_create(const log_segment_config_t* config) {
+    log_segments_t* segments = (log_segments_t*) calloc(1, sizeof(log_segments_t));
+    if (NULL == segments) {
+        fprintf(stderr, "Failed to allocate memory for log segments\n");
+        return NULL;
+    }
+
+    segments->config      = *config;
+    segments->config.path = strdup(config->path);
+    if (0 == segments->config.size) {
+        segments->config.size = LOG_SEGMENT_SIZE;
+    }
+    if (segments->config.size < LOG_ASYNC_BATCH_SIZE) {
+        segments->config.size = LOG_ASYNC_BATCH_SIZE;
+    }
+    if (segments->config.keep > 0) {
+        segments->kept = (char*) calloc(segments->config.keep, LOG_SEGMENT_PATH);
+    }
+
+    if (NULL == segments->config.path || (segments->config.keep > 0 && NULL == segments->kept)
+        || !log_segments_open(segments)) {
+        log_segments_free(segments);
+        return NULL;
+    }
+    return segments;
+}
+
+// Copy one batch into the open segment, rotating first if it does not fit
+static bool log_segments_write(log_segments_t* segments, const char* batch, size_t size) {
+    if (NULL != segments->map && segments->offset + size > segments->config.size) {
+        log_segments_close(segments);
+    }
+    if (NULL == segments->map && !log_segments_open(segments)) {
+        return false;
+    }
+
+    memcpy(segments->map + segments->offset, batch, size);
+    segments->offset += size;
+    return true;
+}
+
+// Close a segment that has been open for the configured interval
+static void log_segments_tick(log_segments_t* segments) {
+    if (NULL != segments->map && segments->offset > 0 && segments->config.interval > 0
+        && log_segments_now() - segments->opened >= segments->config.interval) {
+        log_segments_close(segments);
+    }
+}
+
+static void* log_async_writer(void* argument) {
+    struct LogAsync* async = (struct LogAsync*) argument;
+    char*            batch = (char*) malloc(LOG_ASYNC_BATCH_SIZE);
+
+    if (NULL == batch) {
+        fprintf(stderr, "Failed to allocate the log batch buffer\n");
+        return NULL;
+    }
+
+    log_async_self = async;
+    for (;;) {
+        size_t      used = 0;
+        size_t      position;
+        log_slot_t* slot = NULL;
+
+        while (used + LOG_ASYNC_MESSAGE_SIZE <= LOG_ASYNC_BATCH_SIZE
+               && NULL != (slot = log_async_pop(async, &position))) {
+            memcpy(batch + used, slot->text, slot->length);
+            used += slot->length;
+            log_async_release(async, slot, position);
+        }
+
+        // Everything below the snapshot was popped: written here or discarded
+        size_t drained = atomic_load_explicit(&async->dequeue, memory_order_acquire);
+        if (used > 0) {
+            bool written = NULL != async->segments
+                               ? log_segments_write(async->segments, batch, used)
+                               : log_async_write(async->fd, batch, used);
+            if (!written) {
+                fprintf(stderr, "Failed to write log batch: %s\n", strerror(errno));
+            }
+        }
+        if (NULL != async->segments) {
+            log_segments_tick(async->segments);
+        }
+        if (NULL != slot) {
+            continue; // The batch filled up; keep draining
+        }
+
+        // Queued behind the messages just written, and drained by the next pass
+        log_limit_tick(async->logger, &async->due);
+
+        pthread_mutex_lock(&async->lock);
+        atomic_store_explicit(&async->flushed, drained, memory_order_release);
+        pthread_cond_broadcast(&async->drained);
+
+        if (!atomic_load(&async->running)
+            && drained == atomic_load_explicit(&async->enqueue, memory_order_acquire)) {
+            pthread_mutex_unlock(&async->lock);
+            break;
+        }
+
+        atomic_store(&async->idle, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (drained == atomic_load_explicit(&async->enqueue, memory_order_relaxed)
+            && atomic_load(&async->running)) {
+            struct timespec deadline;
+            log_async_timeout(&deadline, LOG_ASYNC_IDLE_NS);
+            pthread_cond_timedwait(&async->wake, &async->lock, &deadline);
+        }
+        atomic_store(&async->idle, false);
+        pthread_mutex_unlock(&async->lock);
+    }
+
+    free(batch);
+    return NULL;
+}
+
+static bool logger_async_message(
+    struct LogAsync* async, const log_entry_t* entry, const char* format, va_list args
+) {
+    size_t      position;
+    log_slot_t* slot = log_async_claim(async, &position);
+    if (NULL == slot) {
+        return false;
+    }
+
+    log_text_t text = {slot->text, LOG_ASYNC_MESSAGE_SIZE, 0, false};
+    slot->length    = logger_format_message(&text, entry, NULL, format, args);
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    log_async_wake(async);
+    return true;
+}
+
+static void log_async_exit(void) {
+    for (;;) {
+        pthread_mutex_lock(&log_async_registry_lock);
+        struct LogAsync* async = log_async_registry;
+        pthread_mutex_unlock(&log_async_registry_lock);
+
+        if (NULL == async) {
+            return;
+        }
+        logger_stop_async(async->logger);
+    }
+}
+
+static void log_async_register_exit(void) {
+    atexit(log_async_exit);
+}
+
+static bool log_async_start(
+    struct Logger* logger, size_t capacity, log_policy_t policy, struct LogSegments* segments
+) {
+    if (NULL == logger || NULL != logger->async || NULL != logger->buffered) {
+        return false;
+    }
+
+    if (NULL == logger->file_stream) {
+        logger->file_stream = stderr;
+    }
+
+    size_t slots = 2;
+    capacity     = 0 == capacity ? LOG_ASYNC_CAPACITY : capacity;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    struct LogAsync* async = (struct LogAsync*) calloc(1, sizeof(struct LogAsync));
+    if (NULL == async) {
+        fprintf(stderr, "Failed to allocate memory for the async logger\n");
+        return false;
+    }
+
+    async->slots = (log_slot_t*) calloc(slots, sizeof(log_slot_t));
+    if (NULL == async->slots) {
+        fprintf(stderr, "Failed to allocate %zu log slots\n", slots);
+        free(async);
+        return false;
+    }
+
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&async->slots[i].sequence, i);
+    }
+
+    async->mask     = slots - 1;
+    async->policy   = policy;
+    async->logger   = logger;
+    async->segments = segments;
+    atomic_init(&async->running, true);
+    atomic_init(&async->idle, false);
+    atomic_init(&async->dropped, 0);
+    atomic_init(&async->flushed, 0);
+    atomic_init(&async->enqueue, 0);
+    atomic_init(&async->dequeue, 0);
+    pthread_mutex_init(&async->lock, NULL);
+    pthread_cond_init(&async->wake, NULL);
+    pthread_cond_init(&async->drained, NULL);
+
+    // Earlier stdio output must reach the descriptor first
+    fflush(logger->file_stream);
+    async->fd = fileno(logger->file_stream);
+
+    int error_code = pthread_create(&async->writer, NULL, log_async_writer, async);
+    if (0 != error_code) {
+        fprintf(stderr, "Failed to start the log writer thread with error: %d\n", error_code);
+        pthread_cond_destroy(&async->drained);
+        pthread_cond_destroy(&async->wake);
+        pthread_mutex_destroy(&async->lock);
+        free(async->slots);
+        free(async);
+        return false;
+    }
+
+    pthread_once(&log_async_registry_once, log_async_register_exit);
+    pthread_mutex_lock(&log_async_registry_lock);
+    async->next        = log_async_registry;
+    log_async_registry = async;
+    pthread_mutex_unlock(&log_async_registry_lock);
+
+    logger->async = async;
+    return true;
+}
+
+bool logger_start_async(struct Logger* logger, size_t capacity, log_policy_t policy) {
+    return log_async_start(logger, capacity, policy, NULL);
+}
+
+bool logger_start_segments(struct Logger* logger, const log_segment_config_t* config) {
+    if (NULL == logger || NULL == config || NULL == config->path || NULL != logger->async
+        || NULL != logger->buffered) {
+        return false;
+    }
+
+    log_segments_t* segments = log_segments_create(config);
+    if (NULL == segments) {
+        return false;
+    }
+
+    if (!log_async_start(logger, config->capacity, config->policy, segments)) {
+        log_segments_free(segments);
+        return false;
+    }
+    return true;
+}
+
+bool logger_stop_async(struct Logger* logger) {
+    if (NULL == logger || NULL == logger->async) {
+        return false;
+    }
+
+    struct LogAsync* async = logger->async;
+
+    pthread_mutex_lock(&log_async_registry_lock);
+    for (struct LogAsync** link = &log_async_registry; *link; link = &(*link)->next) {
+        if (*link == async) {
+            *link = async->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&log_async_registry_lock);
+
+    pthread_mutex_lock(&async->lock);
+    atomic_store(&async->running, false);
+    pthread_cond_signal(&async->wake);
+    pthread_mutex_unlock(&async->lock);
+
+    pthread_join(async->writer, NULL);
+    logger->async = NULL;
+
+    if (NULL != async->segments) {
+        log_segments_free(async->segments);
+    }
+
+    pthread_cond_destroy(&async->drained);
+    pthread_cond_destroy(&async->wake);
+    pthread_mutex_destroy(&async->lock);
+    free(async->slots);
+    free(async);
+    return true;
+}
+
+/**
+ * @brief Per-thread buffered logging
+ *
+ * Each thread finds its own buffer through a thread-local cache, falling
+ * back to a pthread key owned by the logger, and appends formatted lines to
+ * it as the only producer of a ring. The owner publishes what it appended
+ * with a release store of head and the flusher hands space back with one of
+ * tail, so the fast path takes no lock. Whoever writes a ring out holds its
+ * mutex: the flusher, or the owner when a line does not fit or is an error.
+ * Lines are numbered with one relaxed fetch-and-add on a logger-wide
+ * counter. A full ring goes out together with the line that did not fit as
+ * one writev(2), so the line is never copied; the flusher gathers every
+ * pending ring into as few writev(2) calls as possible.
+ */
+
+#define LOG_BUFFERED_IOV 64 // Thread buffers gathered per flusher writev(2)
+
+typedef struct LogThreadBuffer {
+    struct LogBuffered*     owner;  /**< Logger state the buffer belongs to. */
+    struct LogThreadBuffer* next;   /**< Next buffer of the same logger. */
+    pthread_mutex_t         lock;   /**< Held while the ring is written out. */
+    atomic_size_t           head;   /**< Bytes ever appended, stored by the owner. */
+    atomic_size_t           tail;   /**< Bytes ever written out, stored under lock. */
+    size_t                  end;    /**< head modulo owner->size, owner only. */
+    size_t                  start;  /**< tail modulo owner->size, under lock. */
+    _Alignas(8) char        data[]; /**< Pending lines, owner->size bytes. */
+} log_thread_buffer_t;
+
+struct LogBuffered {
+    uint64_t              id;       /**< Unique per start, keys the thread cache. */
+    size_t                size;     /**< Bytes per thread buffer. */
+    long                  interval; /**< Nanoseconds between timed flushes. */
+    int                   fd;       /**< Descriptor the buffers are written to. */
+    struct Logger*        logger;   /**< Owning logger. */
+    struct LogBuffered*   next;     /**< Next entry in the exit registry. */
+    pthread_key_t         key;      /**< Maps each thread to its buffer. */
+    pthread_t             flusher;  /**< Timed flusher thread. */
+    pthread_mutex_t       lock;     /**< Guards buffers and running. */
+    pthread_cond_t        wake;     /**< Signals the flusher to stop. */
+    bool                  running;  /**< Cleared to stop the flusher. */
+    uint64_t              due;      /**< Next summary of limited sites, flusher only. */
+    log_thread_buffer_t*  buffers;  /**< Buffers of every thread that logged. */
+    atomic_uint_fast64_t  sequence; /**< Number of the next line. */
+    bool                  binary;   /**< Records instead of text lines. */
+    atomic_uint_least32_t sites;    /**< Sites whose format records are written. */
+};
+
+// Buffered loggers still running, flushed by an exit handler
+static struct LogBuffered* log_buffered_registry      = NULL;
+static pthread_mutex_t     log_buffered_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t      log_buffered_registry_once = PTHREAD_ONCE_INIT;
+
+// Buffer of the buffered logger this thread used last, keyed by the ID of
+// that start so a stopped logger's freed buffer is never dereferenced
+static atomic_uint_fast64_t log_buffered_ids = 0;
+static _Thread_local struct {
+    uint64_t             id;
+    log_thread_buffer_t* buffer;
+} log_buffered_cache;
+
+static bool log_buffered_writev(int fd, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        // Skip what was written, resuming inside a partially written vector
+        while (count > 0 && (size_t) written >= iov->iov_len) {
+            written -= (ssize_t) iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base  = (char*) iov->iov_base + written;
+            iov->iov_len  -= (size_t) written;
+        }
+    }
+    return true;
+}
+
+/*
+ * Describe the published bytes of a ring as up to two vectors, the second
+ * after the wrap, and return how many there are; the caller holds its lock.
+ */
+static int log_buffered_pending(
+    struct LogBuffered* buffered, log_thread_buffer_t* buffer, struct iovec iov[2], size_t* bytes
+) {
+    size_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+    size_t used = head - tail;
+    size_t last = buffered->size - buffer->start;
+
+    *bytes = used;
+    if (0 == used) {
+        return 0;
+    }
+    if (used <= last) {
+        iov[0] = (struct iovec) {buffer->data + buffer->start, used};
+        return 1;
+    }
+    iov[0] = (struct iovec) {buffer->data + buffer->start, last};
+    iov[1] = (struct iovec) {buffer->data, used - last};
+    return 2;
+}
+
+// Hand bytes written out back to the owner; the caller holds the lock
+static void log_buffered_release(
+    struct LogBuffered* buffered, log_thread_buffer_t* buffer, size_t bytes
+) {
+    size_t tail    = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+    buffer->start += bytes;
+    if (buffer->start >= buffered->size) {
+        buffer->start -= buffered->size;
+    }
+    atomic_store_explicit(&buffer->tail, tail + bytes, memory_order_release);
+}
+
+// Write the pending lines of one buffer and an optional extra line
+static void log_buffered_drain(
+    struct LogBuffered* buffered, log_thread_buffer_t* buffer, char* line, size_t length
+) {
+    struct iovec iov[3];
+    size_t       bytes;
+    int          count = log_buffered_pending(buffered, buffer, iov, &bytes);
+
+    if (length > 0) {
+        iov[count++] = (struct iovec) {line, length};
+    }
+    if (count > 0 && !log_buffered_writev(buffered->fd, iov, count)) {
+        fprintf(stderr, "Failed to write log buffer: %s\n", strerror(errno));
+    }
+    log_buffered_release(buffered, buffer, bytes);
+}
+
+// Write every pending buffer; the caller holds buffered->lock
+static void log_buffered_flush_locked(struct LogBuffered* buffered) {
+    log_thread_buffer_t* buffer = buffered->buffers;
+
+    while (NULL != buffer) {
+        struct iovec         iov[2 * LOG_BUFFERED_IOV];
+        log_thread_buffer_t* held[LOG_BUFFERED_IOV];
+        size_t               bytes[LOG_BUFFERED_IOV];
+        int                  count   = 0;
+        int                  vectors = 0;
+
+        for (; NULL != buffer && count < LOG_BUFFERED_IOV; buffer = buffer->next) {
+            pthread_mutex_lock(&buffer->lock);
+            int pending = log_buffered_pending(buffered, buffer, iov + vectors, &bytes[count]);
+            if (0 == pending) {
+                pthread_mutex_unlock(&buffer->lock);
+                continue;
+            }
+            vectors     += pending;
+            held[count]  = buffer;
+            count++;
+        }
+
+        if (vectors > 0 && !log_buffered_writev(buffered->fd, iov, vectors)) {
+            fprintf(stderr, "Failed to write log buffers: %s\n", strerror(errno));
+        }
+        for (int i = 0; i < count; i++) {
+            log_buffered_release(buffered, held[i], bytes[i]);
+            pthread_mutex_unlock(&held[i]->lock);
+        }
+    }
+}
+
+static void* log_buffered_flusher(void* argument) {
+    struct LogBuffered* buffered = (struct LogBuffered*) argument;
+
+    pthread_mutex_lock(&buffered->lock);
+    while (buffered->running) {
+        struct timespec deadline;
+        log_async_timeout(&deadline, buffered->interval);
+        pthread_cond_timedwait(&buffered->wake, &buffered->lock, &deadline);
+
+        // Summaries go through this thread's own buffer, which attaching takes
+        // the lock for
+        pthread_mutex_unlock(&buffered->lock);
+        log_limit_tick(buffered->logger, &buffered->due);
+        pthread_mutex_lock(&buffered->lock);
+        log_buffered_flush_locked(buffered);
+    }
+    pthread_mutex_unlock(&buffered->lock);
+    return NULL;
+}
+
+// Key destructor: write out and release the buffer of an exiting thread
+static void log_buffered_detach(void* argument) {
+    log_thread_buffer_t* buffer   = (log_thread_buffer_t*) argument;
+    struct LogBuffered*  buffered = buffer->owner;
+
+    pthread_mutex_lock(&buffered->lock);
+    for (log_thread_buffer_t** link = &buffered->buffers; *link; link = &(*link)->next) {
+        if (*link == buffer) {
+            *link = buffer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buffered->lock);
+
+    if (log_buffered_cache.buffer == buffer) {
+        log_buffered_cache.id     = 0;
+        log_buffered_cache.buffer = NULL;
+    }
+
+    log_buffered_drain(buffered, buffer, NULL, 0);
+    pthread_mutex_destroy(&buffer->lock);
+    free(buffer);
+}
+
+static log_thread_buffer_t* log_buffered_attach(struct LogBuffered* buffered) {
+    log_thread_buffer_t* buffer
+        = (log_thread_buffer_t*) malloc(sizeof(log_thread_buffer_t) + buffered->size);
+    if (NULL == buffer) {
+        return NULL;
+    }
+
+    buffer->owner = buffered;
+    buffer->end   = 0;
+    buffer->start = 0;
+    atomic_init(&buffer->head, 0);
+    atomic_init(&buffer->tail, 0);
+    pthread_mutex_init(&buffer->lock, NULL);
+
+    pthread_mutex_lock(&buffered->lock);
+    buffer->next      = buffered->buffers;
+    buffered->buffers = buffer;
+    pthread_mutex_unlock(&buffered->lock);
+
+    pthread_setspecific(buffered->key, buffer);
+    return buffer;
+}
+
+/**
+ * @brief Binary record layout
+ *
+ * A binary log starts with a log_binary_header_t and continues with records
+ * in host byte order, each headed by its type and total size. A site record
+ * maps a site ID to its file, line and format string and is written before
+ * any event of that site. An event carries the site ID, level, errno,
+ * sequence number and coarse monotonic timestamp, which costs a fraction of a
+ * full clock read at the resolution of a kernel tick, followed by the raw
+ * argument bytes; a text record carries an already formatted message in
+ * place of a site. Event and text records are padded with zeros to a
+ * multiple of LOG_BINARY_ALIGN bytes so that events can be built in place
+ * in a thread's ring.
+ */
+
+#define LOG_BINARY_MAGIC       "ALTBLOG1"
+#define LOG_BINARY_RECORD_SIZE 1024 // Largest event or text record
+#define LOG_BINARY_ALIGN       8    // Alignment of event and text records
+#define LOG_SITE_TEXT          0xFF // log_site_t.count of sites formatted as text
+
+typedef enum LOG_RECORD {
+    LOG_RECORD_SITE = 1,
+    LOG_RECORD_EVENT,
+    LOG_RECORD_TEXT,
+} log_record_type_t;
+
+typedef struct LogBinaryHeader {
+    char     magic[8];  /**< LOG_BINARY_MAGIC without the terminator. */
+    uint64_t realtime;  /**< CLOCK_REALTIME at start, in nanoseconds. */
+    uint64_t monotonic; /**< CLOCK_MONOTONIC_COARSE at start, in nanoseconds. */
+} log_binary_header_t;
+
+typedef struct LogRecord {
+    uint32_t type; /**< log_record_type_t. */
+    uint32_t size; /**< Bytes in the record, this header included. */
+} log_record_t;
+
+typedef struct LogSiteRecord {
+    log_record_t record;
+    uint32_t     site; /**< Site ID. */
+    int32_t      line; /**< Source line, followed by file and format strings. */
+} log_site_record_t;
+
+typedef struct LogEventRecord {
+    log_record_t record;
+    uint32_t     site;      /**< Site ID, 0 for text records. */
+    int32_t      level;     /**< log_level_t. */
+    int32_t      err;       /**< errno when the message was logged. */
+    uint32_t     reserved;  /**< Zero. */
+    uint64_t     sequence;  /**< Logger-wide message number. */
+    uint64_t     timestamp; /**< CLOCK_MONOTONIC_COARSE in nanoseconds. */
+} log_event_record_t;
+
+// Zero-pad a record of length bytes to the next multiple of LOG_BINARY_ALIGN
+static size_t log_binary_pad(char* record, size_t length) {
+    size_t padded = (length + LOG_BINARY_ALIGN - 1) & ~(size_t) (LOG_BINARY_ALIGN - 1);
+    for (size_t i = length; i < padded; i++) {
+        record[i] = '\0';
+    }
+    return padded;
+}
+
+// Fill the common part of an event or text record
+static void log_binary_event(
+    struct LogBuffered* buffered, log_event_record_t* event, log_record_type_t type,
+    uint32_t site, log_level_t log_level, int err
+) {
+    event->record.type = type;
+    event->site        = site;
+    event->level       = (int32_t) log_level;
+    event->err         = err;
+    event->reserved    = 0;
+    event->sequence    = atomic_fetch_add_explicit(&buffered->sequence, 1, memory_order_relaxed);
+    event->timestamp   = log_clock(CLOCK_MONOTONIC_COARSE);
+}
+
+// The calling thread's buffer, attached on its first line
+static log_thread_buffer_t* log_buffered_thread(struct LogBuffered* buffered) {
+    if (log_buffered_cache.id == buffered->id) {
+        return log_buffered_cache.buffer;
+    }
+
+    log_thread_buffer_t* buffer = (log_thread_buffer_t*) pthread_getspecific(buffered->key);
+    if (NULL == buffer && NULL == (buffer = log_buffered_attach(buffered))) {
+        return NULL;
+    }
+    log_buffered_cache.id     = buffered->id;
+    log_buffered_cache.buffer = buffer;
+    return buffer;
+}
+
+// Free bytes of a ring as seen by its owner
+static size_t log_buffered_room(struct LogBuffered* buffered, log_thread_buffer_t* buffer) {
+    size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+    return buffered->size - (head - tail);
+}
+
+// Publish length bytes the owner wrote at the end of its ring
+static void log_buffered_commit(
+    struct LogBuffered* buffered, log_thread_buffer_t* buffer, size_t length
+) {
+    size_t head  = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    buffer->end += length;
+    if (buffer->end >= buffered->size) {
+        buffer->end -= buffered->size;
+    }
+    atomic_store_explicit(&buffer->head, head + length, memory_order_release);
+}
+
+/*
+ * The calling thread's buffer if a record of up to length bytes can be
+ * written in place at the end of its ring, NULL if it has to be appended.
+ */
+static log_thread_buffer_t* log_buffered_reserve(
+    struct LogBuffered* buffered, size_t length, log_level_t log_level
+) {
+    log_thread_buffer_t* buffer = log_buffered_thread(buffered);
+    if (NULL == buffer || LOG_LEVEL_ERROR <= log_level
+        || buffer->end + length > buffered->size || log_buffered_room(buffered, buffer) < length) {
+        return NULL;
+    }
+    return buffer;
+}
+
+// Append one line or record to the calling thread's buffer
+static bool log_buffered_append(
+    struct LogBuffered* buffered, char* data, size_t length, log_level_t log_level
+) {
+    log_thread_buffer_t* buffer = log_buffered_thread(buffered);
+    if (NULL == buffer) {
+        return false;
+    }
+
+    // Errors and lines that do not fit go out at once, behind what is pending
+    if (LOG_LEVEL_ERROR <= log_level || log_buffered_room(buffered, buffer) < length) {
+        pthread_mutex_lock(&buffer->lock);
+        log_buffered_drain(buffered, buffer, data, length);
+        pthread_mutex_unlock(&buffer->lock);
+        return true;
+    }
+
+    size_t last = buffered->size - buffer->end;
+    if (length <= last) {
+        memcpy(buffer->data + buffer->end, data, length);
+    } else {
+        memcpy(buffer->data + buffer->end, data, last);
+        memcpy(buffer->data, data + last, length - last);
+    }
+    log_buffered_commit(buffered, buffer, length);
+    return true;
+}
+
+static bool logger_buffered_message(
+    struct LogBuffered* buffered, const log_entry_t* entry, const char* format, va_list args
+) {
+    if (buffered->binary) {
+        char                record[sizeof(log_event_record_t) + LOG_ASYNC_MESSAGE_SIZE];
+        log_event_record_t* event = (log_event_record_t*) record;
+        log_text_t          text  = {record + sizeof(*event), LOG_ASYNC_MESSAGE_SIZE, 0, false};
+
+        log_text_body(&text, entry, format, args);
+        size_t length = log_binary_pad(record, sizeof(*event) + log_text_finish(&text));
+        log_binary_event(buffered, event, LOG_RECORD_TEXT, 0, entry->level, entry->err);
+        event->record.size = (uint32_t) length;
+        return log_buffered_append(buffered, record, event->record.size, entry->level);
+    }
+
+    char       line[LOG_ASYNC_MESSAGE_SIZE];
+    log_text_t text     = {line, sizeof(line), 0, false};
+    uint64_t   sequence = atomic_fetch_add_explicit(&buffered->sequence, 1, memory_order_relaxed);
+    size_t     length   = logger_format_message(&text, entry, &sequence, format, args);
+
+    return log_buffered_append(buffered, line, length, entry->level);
+}
+
+static void log_buffered_exit(void) {
+    for (;;) {
+        pthread_mutex_lock(&log_buffered_registry_lock);
+        struct LogBuffered* buffered = log_buffered_registry;
+        pthread_mutex_unlock(&log_buffered_registry_lock);
+
+        if (NULL == buffered) {
+            return;
+        }
+        logger_stop_buffered(buffered->logger);
+    }
+}
+
+static void log_buffered_register_exit(void) {
+    atexit(log_buffered_exit);
+}
+
+static bool log_buffered_start(struct Logger* logger, size_t size, long interval, bool binary) {
+    if (NULL == logger || NULL != logger->async || NULL != logger->buffered) {
+        return false;
+    }
+
+    if (NULL == logger->file_stream) {
+        logger->file_stream = stderr;
+    }
+
+    struct LogBuffered* buffered = (struct LogBuffered*) calloc(1, sizeof(struct LogBuffered));
+    if (NULL == buffered) {
+        fprintf(stderr, "Failed to allocate memory for the buffered logger\n");
+        return false;
+    }
+
+    // Every buffer must hold at least one whole line or record and be a whole
+    // number of LOG_BINARY_ALIGN units, so aligned records stay aligned
+    size_t minimum = binary ? LOG_BINARY_RECORD_SIZE : LOG_ASYNC_MESSAGE_SIZE;
+    size           = 0 == size ? LOG_BUFFERED_SIZE : size;
+    interval       = 0 >= interval ? LOG_BUFFERED_INTERVAL : interval;
+
+    buffered->id       = atomic_fetch_add_explicit(&log_buffered_ids, 1, memory_order_relaxed) + 1;
+    size               = size < minimum ? minimum : size;
+    buffered->size     = (size + LOG_BINARY_ALIGN - 1) & ~(size_t) (LOG_BINARY_ALIGN - 1);
+    buffered->interval = interval * 1000000L;
+    buffered->logger   = logger;
+    buffered->running  = true;
+    buffered->binary   = binary;
+    atomic_init(&buffered->sequence, 0);
+    atomic_init(&buffered->sites, 0);
+
+    int error_code = pthread_key_create(&buffered->key, log_buffered_detach);
+    if (0 != error_code) {
+        fprintf(stderr, "Failed to create the log buffer key with error: %d\n", error_code);
+        free(buffered);
+        return false;
+    }
+    pthread_mutex_init(&buffered->lock, NULL);
+    pthread_cond_init(&buffered->wake, NULL);
+
+    // Earlier stdio output must reach the descriptor first
+    fflush(logger->file_stream);
+    buffered->fd = fileno(logger->file_stream);
+
+    if (binary) {
+        log_binary_header_t header;
+        memcpy(header.magic, LOG_BINARY_MAGIC, sizeof(header.magic));
+        header.realtime  = log_clock(CLOCK_REALTIME);
+        header.monotonic = log_clock(CLOCK_MONOTONIC_COARSE);
+        log_async_write(buffered->fd, (const char*) &header, sizeof(header));
+    }
+
+    error_code = pthread_create(&buffered->flusher, NULL, log_buffered_flusher, buffered);
+    if (0 != error_code) {
+        fprintf(stderr, "Failed to start the log flusher thread with error: %d\n", error_code);
+        pthread_cond_destroy(&buffered->wake);
+        pthread_mutex_destroy(&buffered->lock);
+        pthread_key_delete(buffered->key);
+        free(buffered);
+        return false;
+    }
+
+    pthread_once(&log_buffered_registry_once, log_buffered_register_exit);
+    pthread_mutex_lock(&log_buffered_registry_lock);
+    buffered->next        = log_buffered_registry;
+    log_buffered_registry = buffered;
+    pthread_mutex_unlock(&log_buffered_registry_lock);
+
+    logger->buffered = buffered;
+    return true;
+}
+
+bool logger_start_buffered(struct Logger* logger, size_t size, long interval) {
+    return log_buffered_start(logger, size, interval, false);
+}
+
+bool logger_stop_buffered(struct Logger* logger) {
+    if (NULL == logger || NULL == logger->buffered) {
+        return false;
+    }
+
+    struct LogBuffered* buffered = logger->buffered;
+
+    pthread_mutex_lock(&log_buffered_registry_lock);
+    for (struct LogBuffered** link = &log_buffered_registry; *link; link = &(*link)->next) {
+        if (*link == buffered) {
+            *link = buffered->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&log_buffered_registry_lock);
+
+    pthread_mutex_lock(&buffered->lock);
+    buffered->running = false;
+    pthread_cond_signal(&buffered->wake);
+    pthread_mutex_unlock(&buffered->lock);
+    pthread_join(buffered->flusher, NULL);
+
+    // Exiting threads must no longer reach the buffers released below
+    pthread_key_delete(buffered->key);
+    logger->buffered = NULL;
+
+    pthread_mutex_lock(&buffered->lock);
+    log_buffered_flush_locked(buffered);
+    pthread_mutex_unlock(&buffered->lock);
+
+    while (NULL != buffered->buffers) {
+        log_thread_buffer_t* buffer = buffered->buffers;
+        buffered->buffers           = buffer->next;
+        pthread_mutex_destroy(&buffer->lock);
+        free(buffer);
+    }
+
+    pthread_cond_destroy(&buffered->wake);
+    pthread_mutex_destroy(&buffered->lock);
+    free(buffered);
+    return true;
+}
+
+/**
+ * @brief Binary logging
+ *
+ * Each LOG_BINARY call site owns a static log_site_t. The first call parses
+ * its format string once into the kinds of the arguments it consumes and
+ * assigns the site an ID; every later call copies the raw argument bytes
+ * into an event record without formatting anything. Strings are the only
+ * arguments copied by value, since the pointer would be meaningless later.
+ * Formats with conversions that cannot be replayed (%n, wide characters)
+ * or with more than LOG_BINARY_ARGUMENTS arguments are formatted as text.
+ */
+
+typedef enum LOG_ARGUMENT {
+    LOG_ARGUMENT_INT,         /**< int and everything promoted to it. */
+    LOG_ARGUMENT_LONG,        /**< long, l. */
+    LOG_ARGUMENT_LONG_LONG,   /**< long long, ll. */
+    LOG_ARGUMENT_SIZE,        /**< size_t, z. */
+    LOG_ARGUMENT_INTMAX,      /**< intmax_t, j. */
+    LOG_ARGUMENT_PTRDIFF,     /**< ptrdiff_t, t. */
+    LOG_ARGUMENT_DOUBLE,      /**< double and promoted float. */
+    LOG_ARGUMENT_LONG_DOUBLE, /**< long double, L. */
+    LOG_ARGUMENT_POINTER,     /**< void*, p. */
+    LOG_ARGUMENT_STRING,      /**< char*, stored as a length and the bytes. */
+    LOG_ARGUMENT_UNSUPPORTED  /**< Anything that cannot be replayed. */
+} log_argument_t;
+
+// Sites in ID order; site ID i is log_sites[i - 1]
+static const log_site_t** log_sites         = NULL;
+static uint32_t           log_site_count    = 0;
+static uint32_t           log_site_capacity = 0;
+static pthread_mutex_t    log_site_lock     = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Find the next conversion of a printf format. Returns its '%', or NULL when
+ * none is left, and sets end past it and kinds[0, count) to the arguments it
+ * consumes: a star width, a star precision, then the value. "%%" consumes
+ * nothing.
+ */
+static const char* log_format_conversion(
+    const char* format, const char** end, log_argument_t kinds[3], size_t* count
+) {
+    const char* start = strchr(format, '%');
+    if (NULL == start) {
+        return NULL;
+    }
+
+    const char* p = start + 1;
+    size_t      n = 0;
+
+    if ('%' == *p) {
+        *end   = p + 1;
+        *count = 0;
+        return start;
+    }
+
+    while ('\0' != *p && NULL != strchr("-+ #0'", *p)) {
+        p++;
+    }
+    if ('*' == *p) {
+        kinds[n++] = LOG_ARGUMENT_INT;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if ('.' == *p) {
+        p++;
+        if ('*' == *p) {
+            kinds[n++] = LOG_ARGUMENT_INT;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+
+    // Length modifier, folded into the kind of an integer conversion
+    log_argument_t integer = LOG_ARGUMENT_INT;
+    bool           wide    = false;
+    bool           extended = false;
+    switch (*p) {
+        case 'h':
+            p += 'h' == p[1] ? 2 : 1;
+            break;
+        case 'l':
+            wide    = 'l' != p[1];
+            integer = 'l' == p[1] ? LOG_ARGUMENT_LONG_LONG : LOG_ARGUMENT_LONG;
+            p      += 'l' == p[1] ? 2 : 1;
+            break;
+        case 'j':
+            integer = LOG_ARGUMENT_INTMAX;
+            p++;
+            break;
+        case 'z':
+            integer = LOG_ARGUMENT_SIZE;
+            p++;
+            break;
+        case 't':
+            integer = LOG_ARGUMENT_PTRDIFF;
+            p++;
+            break;
+        case 'L':
+            extended = true;
+            p++;
+            break;
+    }
+
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            kinds[n++] = integer;
+            break;
+        case 'c':
+            kinds[n++] = wide ? LOG_ARGUMENT_UNSUPPORTED : LOG_ARGUMENT_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            kinds[n++] = extended ? LOG_ARGUMENT_LONG_DOUBLE : LOG_ARGUMENT_DOUBLE;
+            break;
+        case 's':
+            kinds[n++] = wide ? LOG_ARGUMENT_UNSUPPORTED : LOG_ARGUMENT_STRING;
+            break;
+        case 'p':
+            kinds[n++] = LOG_ARGUMENT_POINTER;
+            break;
+        default:
+            kinds[n++] = LOG_ARGUMENT_UNSUPPORTED;
+            break;
+    }
+
+    *end   = '\0' == *p ? p : p + 1;
+    *count = n;
+    return start;
+}
+
+// Parse the format of a new site into its argument kinds
+static void log_site_parse(log_site_t* site) {
+    const char*    format = site->format;
+    const char*    end;
+    log_argument_t kinds[3];
+    size_t         count;
+    size_t         total = 0;
+
+    while (NULL != log_format_conversion(format, &end, kinds, &count)) {
+        for (size_t i = 0; i < count; i++) {
+            if (LOG_ARGUMENT_UNSUPPORTED == kinds[i] || total == LOG_BINARY_ARGUMENTS) {
+                site->count = LOG_SITE_TEXT;
+                return;
+            }
+            site->kinds[total++] = (unsigned char) kinds[i];
+        }
+        format = end;
+    }
+    site->count = (unsigned char) total;
+}
+
+// Assign the next ID to a site on its first call; returns 0 if out of memory
+static uint32_t log_site_register(log_site_t* site) {
+    pthread_mutex_lock(&log_site_lock);
+
+    uint32_t id = __atomic_load_n(&site->id, __ATOMIC_RELAXED);
+    if (0 == id) {
+        if (log_site_count == log_site_capacity) {
+            uint32_t           capacity = 0 == log_site_capacity ? 64 : 2 * log_site_capacity;
+            const log_site_t** sites
+                = (const log_site_t**) realloc(log_sites, capacity * sizeof(log_site_t*));
+            if (NULL == sites) {
+                pthread_mutex_unlock(&log_site_lock);
+                return 0;
+            }
+            log_sites         = sites;
+            log_site_capacity = capacity;
+        }
+
+        log_site_parse(site);
+        log_sites[log_site_count++] = site;
+        id                          = log_site_count;
+        __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&log_site_lock);
+    return id;
+}
+
+// Write the site records up to id that this log does not have yet
+static void log_binary_write_sites(struct LogBuffered* buffered, uint32_t id) {
+    pthread_mutex_lock(&buffered->lock);
+
+    uint32_t written = atomic_load_explicit(&buffered->sites, memory_order_relaxed);
+    for (; written < id; written++) {
+        pthread_mutex_lock(&log_site_lock);
+        const log_site_t* site = log_sites[written];
+        pthread_mutex_unlock(&log_site_lock);
+
+        size_t file   = strlen(site->file) + 1;
+        size_t format = strlen(site->format) + 1;
+        size_t size   = sizeof(log_site_record_t) + file + format;
+        char*  data   = (char*) malloc(size);
+        if (NULL == data) {
+            break;
+        }
+
+        log_site_record_t* record = (log_site_record_t*) data;
+        record->record.type       = LOG_RECORD_SITE;
+        record->record.size       = (uint32_t) size;
+        record->site              = written + 1;
+        record->line              = site->line;
+        memcpy(data + sizeof(*record), site->file, file);
+        memcpy(data + sizeof(*record) + file, site->format, format);
+
+        if (!log_async_write(buffered->fd, data, size)) {
+            fprintf(stderr, "Failed to write log site: %s\n", strerror(errno));
+        }
+        free(data);
+    }
+
+    atomic_store_explicit(&buffered->sites, written, memory_order_release);
+    pthread_mutex_unlock(&buffered->lock);
+}
+
+bool logger_start_binary(struct Logger* logger, size_t size, long interval) {
+    return log_buffered_start(logger, size, interval, true);
+}
+
+bool logger_binary_message(struct Logger* logger, log_level_t log_level, log_site_t* site, ...) {
+    if (log_level < logger->log_level) {
+        return false;
+    }
+
+    int      err = errno;
+    uint32_t id  = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (0 == id) {
+        id = log_site_register(site);
+    }
+
+    va_list args;
+    va_start(args, site);
+
+    struct LogBuffered* buffered = logger->buffered;
+    if (0 == id || NULL == buffered || !buffered->binary || LOG_SITE_TEXT == site->count) {
+        char body[LOG_ASYNC_MESSAGE_SIZE];
+        vsnprintf(body, sizeof(body), site->format, args);
+        va_end(args);
+
+        errno = err;
+        return logger_message(logger, log_level, "[%s:%d] %s", site->file, site->line, body);
+    }
+
+    if (id > atomic_load_explicit(&buffered->sites, memory_order_acquire)) {
+        log_binary_write_sites(buffered, id);
+    }
+
+    // Records are written straight into the ring unless it is about to wrap
+    char                 local[LOG_BINARY_RECORD_SIZE];
+    log_thread_buffer_t* buffer = log_buffered_reserve(buffered, sizeof(local), log_level);
+    char*                record = NULL != buffer ? buffer->data + buffer->end : local;
+    log_event_record_t*  event  = (log_event_record_t*) record;
+    size_t               offset = sizeof(*event);
+
+    // Fixed-size values are copied as they are; sizes never exceed 16 bytes
+    for (size_t i = 0; i < site->count; i++) {
+        switch ((log_argument_t) site->kinds[i]) {
+            case LOG_ARGUMENT_INT: {
+                int value = va_arg(args, int);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_LONG: {
+                long value = va_arg(args, long);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_LONG_LONG: {
+                long long value = va_arg(args, long long);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_SIZE: {
+                size_t value = va_arg(args, size_t);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_INTMAX: {
+                intmax_t value = va_arg(args, intmax_t);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_PTRDIFF: {
+                ptrdiff_t value = va_arg(args, ptrdiff_t);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_DOUBLE: {
+                double value = va_arg(args, double);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_LONG_DOUBLE: {
+                long double value = va_arg(args, long double);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_POINTER: {
+                void* value = va_arg(args, void*);
+                memcpy(record + offset, &value, sizeof(value));
+                offset += sizeof(value);
+                break;
+            }
+            case LOG_ARGUMENT_STRING: {
+                // Truncated to what is left after the remaining arguments
+                const char* value     = va_arg(args, const char*);
+                size_t      reserve   = (site->count - i - 1) * 16 + sizeof(uint32_t);
+                size_t      available = sizeof(local) - offset - reserve;
+                uint32_t    length;
+
+                value  = NULL == value ? "(null)" : value;
+                length = (uint32_t) strnlen(value, available);
+                memcpy(record + offset, &length, sizeof(length));
+                memcpy(record + offset + sizeof(length), value, length);
+                offset += sizeof(length) + length;
+                break;
+            }
+            case LOG_ARGUMENT_UNSUPPORTED:
+                break;
+        }
+    }
+    va_end(args);
+
+    offset = log_binary_pad(record, offset);
+    log_binary_event(buffered, event, LOG_RECORD_EVENT, id, log_level, err);
+    event->record.size = (uint32_t) offset;
+    if (NULL != buffer) {
+        log_buffered_commit(buffered, buffer, offset);
+        return true;
+    }
+    return log_buffered_append(buffered, record, offset, log_level);
+}
+
+/**
+ * @brief Binary log decoding
+ */
+
+typedef struct LogDecodedSite {
+    int   line;   /**< Source line. */
+    char* file;   /**< Source file. */
+    char* format; /**< Format string. */
+} log_decoded_site_t;
+
+typedef struct LogDecodedLine {
+    uint64_t sequence; /**< Sort key. */
+    char*    text;     /**< Rendered line. */
+} log_decoded_line_t;
+
+static int log_decoded_compare(const void* a, const void* b) {
+    uint64_t x = ((const log_decoded_line_t*) a)->sequence;
+    uint64_t y = ((const log_decoded_line_t*) b)->sequence;
+    return (x > y) - (x < y);
+}
+
+// Read size bytes of an argument from an event payload
+static bool log_decode_take(
+    const char** payload, const char* limit, void* value, size_t size
+) {
+    if ((size_t) (limit - *payload) < size) {
+        return false;
+    }
+    memcpy(value, *payload, size);
+    *payload += size;
+    return true;
+}
+
+// Print one value with the conversion spec and 0 to 2 star arguments
+#define LOG_DECODE_PRINT(text, size, spec, stars, star, value) \
+    (0 == (stars)   ? snprintf(text, size, spec, value) \
+     : 1 == (stars) ? snprintf(text, size, spec, (star)[0], value) \
+                    : snprintf(text, size, spec, (star)[0], (star)[1], value))
+
+// Render the message of an event by replaying its format conversion by conversion
+static void log_decode_event(
+    const log_decoded_site_t* site, const char* payload, const char* limit, char* text, size_t size
+) {
+    const char* format = site->format;
+    const char* start  = NULL;
+    const char* end;
+    size_t      used = 0;
+
+    log_argument_t kinds[3];
+    size_t         count;
+
+    while (used < size && NULL != (start = log_format_conversion(format, &end, kinds, &count))) {
+        // Literal text before the conversion
+        size_t literal = (size_t) (start - format);
+        literal        = literal < size - used ? literal : size - used - 1;
+        memcpy(text + used, format, literal);
+        used += literal;
+
+        char spec[64];
+        size_t length = (size_t) (end - start);
+        if (length >= sizeof(spec)) {
+            break;
+        }
+        memcpy(spec, start, length);
+        spec[length] = '\0';
+
+        int    star[2] = {0, 0};
+        size_t stars   = 0 == count ? 0 : count - 1;
+        bool   valid   = true;
+        for (size_t i = 0; i < stars; i++) {
+            valid &= log_decode_take(&payload, limit, &star[i], sizeof(int));
+        }
+
+        char*  out     = text + used;
+        size_t left    = size - used;
+        int    written = 0;
+
+        switch (0 == count ? LOG_ARGUMENT_UNSUPPORTED : kinds[count - 1]) {
+            case LOG_ARGUMENT_INT: {
+                int value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_LONG: {
+                long value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_LONG_LONG: {
+                long long value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_SIZE: {
+                size_t value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_INTMAX: {
+                intmax_t value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_PTRDIFF: {
+                ptrdiff_t value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_DOUBLE: {
+                double value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_LONG_DOUBLE: {
+                long double value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_POINTER: {
+                void* value;
+                valid   = valid && log_decode_take(&payload, limit, &value, sizeof(value));
+                written = valid ? LOG_DECODE_PRINT(out, left, spec, stars, star, value) : 0;
+                break;
+            }
+            case LOG_ARGUMENT_STRING: {
+                char     value[LOG_BINARY_RECORD_SIZE];
+                uint32_t length = 0;
+                valid           = valid && log_decode_take(&payload, limit, &length, sizeof(length))
+                        && length < sizeof(value)
+                        && log_decode_take(&payload, limit, value, length);
+                if (valid) {
+                    value[length] = '\0';
+                    written       = LOG_DECODE_PRINT(out, left, spec, stars, star, value);
+                }
+                break;
+            }
+            case LOG_ARGUMENT_UNSUPPORTED:
+                written = snprintf(out, left, "%s", 0 == count ? "%" : spec);
+                break;
+        }
+
+        if (!valid) {
+            written = snprintf(out, left, "<truncated>");
+        }
+        used   += written < 0 ? 0 : (size_t) written < left ? (size_t) written : left - 1;
+        format  = end;
+        if (!valid) {
+            break;
+        }
+    }
+
+    // Literal text after the last conversion
+    snprintf(text + used, size - used, "%s", NULL == start ? format : "");
+}
+
+bool logger_decode(FILE* input, FILE* output) {
+    log_binary_header_t header;
+    if (NULL == input || NULL == output || 1 != fread(&header, sizeof(header), 1, input)
+        || 0 != memcmp(header.magic, LOG_BINARY_MAGIC, sizeof(header.magic))) {
+        fprintf(stderr, "Not a binary log\n");
+        return false;
+    }
+
+    log_decoded_site_t* sites      = NULL;
+    size_t              site_count = 0;
+    log_decoded_line_t* lines      = NULL;
+    size_t              line_count = 0;
+    size_t              capacity   = 0;
+    char*               data       = (char*) malloc(LOG_BINARY_RECORD_SIZE);
+    size_t              data_size  = LOG_BINARY_RECORD_SIZE;
+    bool                result     = NULL != data;
+
+    log_record_t record;
+    while (result && 1 == fread(&record, sizeof(record), 1, input)) {
+        if (record.size < sizeof(record)) {
+            result = false;
+            break;
+        }
+        if (record.size > data_size) {
+            char* grown = (char*) realloc(data, record.size);
+            if (NULL == grown) {
+                result = false;
+                break;
+            }
+            data      = grown;
+            data_size = record.size;
+        }
+        memcpy(data, &record, sizeof(record));
+        size_t rest = record.size - sizeof(record);
+        if (rest > 0 && 1 != fread(data + sizeof(record), rest, 1, input)) {
+            break; // The log ends inside a record, e.g. after a crash
+        }
+
+        if (LOG_RECORD_SITE == record.type && record.size > sizeof(log_site_record_t)) {
+            const log_site_record_t* site = (const log_site_record_t*) data;
+            const char*              file   = data + sizeof(*site);
+            const char*              end    = data + record.size;
+            const char*              format = (const char*) memchr(file, '\0', (size_t) (end - file));
+            if (0 == site->site || NULL == format) {
+                continue; // Malformed site or file string
+            }
+            format++;
+            if (NULL == memchr(format, '\0', (size_t) (end - format))) {
+                continue; // Malformed format string
+            }
+            if (site->site > site_count) {
+                log_decoded_site_t* grown
+                    = (log_decoded_site_t*) realloc(sites, site->site * sizeof(*sites));
+                if (NULL == grown) {
+                    result = false;
+                    break;
+                }
+                memset(grown + site_count, 0, (site->site - site_count) * sizeof(*sites));
+                sites      = grown;
+                site_count = site->site;
+            }
+            log_decoded_site_t* entry = &sites[site->site - 1];
+            free(entry->file);
+            free(entry->format);
+            entry->line   = site->line;
+            entry->file   = strdup(file);
+            entry->format = strdup(format);
+            continue;
+        }
+
+        if ((LOG_RECORD_EVENT != record.type && LOG_RECORD_TEXT != record.type)
+            || record.size < sizeof(log_event_record_t)) {
+            continue; // Unknown records are skipped
+        }
+
+        const log_event_record_t* event   = (const log_event_record_t*) data;
+        const char*               payload = data + sizeof(*event);
+        const char*               limit   = data + record.size;
+
+        // Timestamp in UTC, then the same prefix a text logger writes
+        char            text[2 * LOG_BINARY_RECORD_SIZE];
+        uint64_t        realtime = header.realtime + (event->timestamp - header.monotonic);
+        time_t          seconds  = (time_t) (realtime / 1000000000ull);
+        struct tm       utc;
+        int             used;
+
+        gmtime_r(&seconds, &utc);
+        used  = (int) strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+        used += snprintf(
+            text + used,
+            sizeof(text) - (size_t) used,
+            ".%09lluZ ",
+            (unsigned long long) (realtime % 1000000000ull)
+        );
+        used += logger_format_prefix(
+            text + used, sizeof(text) - (size_t) used, (log_level_t) event->level, event->err
+        );
+
+        if (LOG_RECORD_TEXT == record.type) {
+            snprintf(
+                text + used, sizeof(text) - (size_t) used, "%.*s", (int) (limit - payload), payload
+            );
+        } else if (0 < event->site && event->site <= site_count && sites[event->site - 1].format) {
+            const log_decoded_site_t* site = &sites[event->site - 1];
+            used += snprintf(
+                text + used, sizeof(text) - (size_t) used, "[%s:%d] ", site->file, site->line
+            );
+            log_decode_event(site, payload, limit, text + used, sizeof(text) - (size_t) used);
+        } else {
+            snprintf(
+                text + used, sizeof(text) - (size_t) used, "<unknown site %u>\n", event->site
+            );
+        }
+
+        if (line_count == capacity) {
+            capacity                  = 0 == capacity ? 1024 : 2 * capacity;
+            log_decoded_line_t* grown = (log_decoded_line_t*) realloc(lines, capacity * sizeof(*lines));
+            if (NULL == grown) {
+                result = false;
+                break;
+            }
+            lines = grown;
+        }
+        lines[line_count].sequence = event->sequence;
+        lines[line_count].text     = strdup(text);
+        line_count++;
+    }
+
+    // Thread buffers reach the file out of order; the sequence restores it
+    qsort(lines, line_count, sizeof(*lines), log_decoded_compare);
+    for (size_t i = 0; i < line_count; i++) {
+        if (NULL != lines[i].text) {
+            fputs(lines[i].text, output);
+        }
+        free(lines[i].text);
+    }
+
+    for (size_t i = 0; i < site_count; i++) {
+        free(sites[i].file);
+        free(sites[i].format);
+    }
+    free(sites);
+    free(lines);
+    free(data);
+    return result;
+}
+
+/**
+ * @brief Rate-limited and sampled logging
+ *
+ * Each limited call site owns a static log_limit_t with lock-free counters.
+ * A suppressed message costs one increment and never reaches the logger
+ * mutex. Sites that suppressed something are kept in a registry, each with
+ * the logger it suppressed for, so counts that no later message reports
+ * still show up in the summary of that logger. The writer or flusher thread
+ * of a logger summarizes its sites periodically; synchronous loggers have no
+ * thread and summarize from a suppression once the interval is due. Flushing
+ * or destroying a logger and process exit report whatever is left.
+ */
+
+static log_limit_t*    log_limit_registry      = NULL;
+static pthread_mutex_t log_limit_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  log_limit_registry_once = PTHREAD_ONCE_INIT;
+static uint64_t        log_limit_due           = 0; // Next synchronous summary, accessed atomically
+
+bool logger_limit_first(log_limit_t* limit, uint64_t n) {
+    return __atomic_fetch_add(&limit->calls, 1, __ATOMIC_RELAXED) < n;
+}
+
+bool logger_limit_every(log_limit_t* limit, uint64_t k) {
+    uint64_t calls = __atomic_fetch_add(&limit->calls, 1, __ATOMIC_RELAXED);
+    return 0 == calls % (0 == k ? 1 : k);
+}
+
+bool logger_limit_interval(log_limit_t* limit, long interval) {
+    uint64_t now      = log_clock(CLOCK_MONOTONIC_COARSE);
+    uint64_t deadline = __atomic_load_n(&limit->deadline, __ATOMIC_RELAXED);
+
+    __atomic_fetch_add(&limit->calls, 1, __ATOMIC_RELAXED);
+
+    // Only the caller that moves the deadline logs
+    return now >= deadline
+           && __atomic_compare_exchange_n(
+               &limit->deadline,
+               &deadline,
+               now + (uint64_t) interval * 1000000ull,
+               false,
+               __ATOMIC_RELAXED,
+               __ATOMIC_RELAXED
+           );
+}
+
+static void log_limit_print(struct Logger* logger, log_level_t log_level, log_limit_t* limit) {
+    uint64_t suppressed = __atomic_exchange_n(&limit->suppressed, 0, __ATOMIC_RELAXED);
+    if (suppressed > 0) {
+        logger_message(
+            logger,
+            log_level,
+            "[%s:%d] %llu similar messages suppressed\n",
+            limit->file,
+            limit->line,
+            (unsigned long long) suppressed
+        );
+    }
+}
+
+static void log_limit_exit(void) {
+    pthread_mutex_lock(&log_limit_registry_lock);
+    for (log_limit_t* limit = log_limit_registry; NULL != limit; limit = limit->next) {
+        log_limit_print(limit->logger, (log_level_t) limit->level, limit);
+    }
+    pthread_mutex_unlock(&log_limit_registry_lock);
+}
+
+static void log_limit_register_exit(void) {
+    atexit(log_limit_exit);
+}
+
+static void log_limit_register(struct Logger* logger, log_level_t log_level, log_limit_t* limit) {
+    uint32_t expected = 0;
+    if (!__atomic_compare_exchange_n(
+            &limit->registered, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED
+        )) {
+        return;
+    }
+
+    pthread_once(&log_limit_registry_once, log_limit_register_exit);
+    pthread_mutex_lock(&log_limit_registry_lock);
+    limit->level       = (int) log_level;
+    limit->logger      = logger;
+    limit->next        = log_limit_registry;
+    log_limit_registry = limit;
+    pthread_mutex_unlock(&log_limit_registry_lock);
+}
+
+// Report the sites of a logger and drop them from the registry
+static void log_limit_release(struct Logger* logger) {
+    pthread_mutex_lock(&log_limit_registry_lock);
+    for (log_limit_t** link = &log_limit_registry; NULL != *link;) {
+        log_limit_t* limit = *link;
+        if (limit->logger != logger) {
+            link = &limit->next;
+            continue;
+        }
+        log_limit_print(logger, (log_level_t) limit->level, limit);
+        *link         = limit->next;
+        limit->logger = NULL;
+        limit->next   = NULL;
+        __atomic_store_n(&limit->registered, 0, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&log_limit_registry_lock);
+}
+
+// Print the counts of every site of a logger; the caller holds the registry lock
+static void log_limit_summary_locked(struct Logger* logger) {
+    for (log_limit_t* limit = log_limit_registry; NULL != limit; limit = limit->next) {
+        if (limit->logger == logger) {
+            log_limit_print(logger, (log_level_t) limit->level, limit);
+        }
+    }
+}
+
+/*
+ * Summarize the sites of a logger once its interval is due; due is private
+ * to the calling writer or flusher thread. A thread reporting under the
+ * registry lock may be waiting for this writer to make room, so a busy
+ * registry postpones the summary to the next tick instead of blocking.
+ */
+static void log_limit_tick(struct Logger* logger, uint64_t* due) {
+    uint64_t now = log_clock(CLOCK_MONOTONIC_COARSE);
+    if (now < *due) {
+        return;
+    }
+    if (0 == *due) {
+        *due = now + LOG_LIMIT_SUMMARY_INTERVAL * 1000000ull;
+        return;
+    }
+    if (0 == pthread_mutex_trylock(&log_limit_registry_lock)) {
+        log_limit_summary_locked(logger);
+        pthread_mutex_unlock(&log_limit_registry_lock);
+        *due = now + LOG_LIMIT_SUMMARY_INTERVAL * 1000000ull;
+    }
+}
+
+void logger_limit_suppress(struct Logger* logger, log_level_t log_level, log_limit_t* limit) {
+    __atomic_fetch_add(&limit->suppressed, 1, __ATOMIC_RELAXED);
+    if (!__atomic_load_n(&limit->registered, __ATOMIC_ACQUIRE)) {
+        log_limit_register(logger, log_level, limit);
+    }
+
+    // Loggers with a writer or flusher thread summarize from it
+    if (NULL != logger->async || NULL != logger->buffered) {
+        return;
+    }
+
+    // The first synchronous suppression starts the summary clock
+    uint64_t now  = log_clock(CLOCK_MONOTONIC_COARSE);
+    uint64_t due  = __atomic_load_n(&log_limit_due, __ATOMIC_RELAXED);
+    uint64_t next = now + LOG_LIMIT_SUMMARY_INTERVAL * 1000000ull;
+
+    if (now >= due
+        && __atomic_compare_exchange_n(
+            &log_limit_due, &due, next, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+        )
+        && 0 != due) {
+        logger_limit_summary(logger);
+    }
+}
+
+void logger_limit_report(struct Logger* logger, log_level_t log_level, log_limit_t* limit) {
+    if (0 != __atomic_load_n(&limit->suppressed, __ATOMIC_RELAXED)) {
+        log_limit_print(logger, log_level, limit);
+    }
+}
+
+void logger_limit_summary(struct Logger* logger) {
+    pthread_mutex_lock(&log_limit_registry_lock);
+    log_limit_summary_locked(logger);
+    pthread_mutex_unlock(&log_limit_registry_lock);
+}
+
+bool logger_flush(struct Logger* logger) {
+    if (NULL == logger) {
+        return false;
+    }
+
+    logger_limit_summary(logger);
+
+    struct LogBuffered* buffered = logger->buffered;
+    if (NULL != buffered) {
+        pthread_mutex_lock(&buffered->lock);
+        log_buffered_flush_locked(buffered);
+        pthread_mutex_unlock(&buffered->lock);
+        return true;
+    }
+
+    struct LogAsync* async = logger->async;
+    if (NULL == async) {
+        if (NULL != logger->file_stream) {
+            fflush(logger->file_stream);
+        }
+        return true;
+    }
+
+    size_t target = atomic_load_explicit(&async->enqueue, memory_order_acquire);
+
+    pthread_mutex_lock(&async->lock);
+    while (atomic_load_explicit(&async->flushed, memory_order_acquire) < target) {
+        struct timespec deadline;
+        log_async_timeout(&deadline, LOG_ASYNC_IDLE_NS);
+        pthread_cond_signal(&async->wake);
+        pthread_cond_timedwait(&async->drained, &async->lock, &deadline);
+    }
+    pthread_mutex_unlock(&async->lock);
+    return true;
+}
+
+size_t logger_dropped(const struct Logger* logger) {
+    if (NULL == logger || NULL == logger->async) {
+        return 0;
+    }
+    return atomic_load_explicit(&logger->async->dropped, memory_order_relaxed);
+}
+
+int log_module_levels[LOG_MODULE_COUNT] = {LOG_LEVEL_DEBUG};
+
+bool logger_set_module_level(log_module_t module, log_level_t log_level) {
+    if ((int) module < 0 || module >= LOG_MODULE_COUNT) {
+        return false;
+    }
+    __atomic_store_n(&log_module_levels[module], (int) log_level, __ATOMIC_RELAXED);
+    return true;
+}
+
+log_level_t logger_get_module_level(log_module_t module) {
+    if ((int) module < 0 || module >= LOG_MODULE_COUNT) {
+        return LOG_LEVEL_DEBUG;
+    }
+    return (log_level_t) __atomic_load_n(&log_module_levels[module], __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Writes a message in the mode the logger is in: queued, buffered or
+ * directly to the stream. Level filtering is up to the caller.
+ */
+static bool logger_vmessage(
+    struct Logger* logger, const log_entry_t* entry, const char* format, va_list args
+) {
+    // Apply lazy initialization for global logger
+    if (NULL == logger->file_stream) {
+        logger->file_stream = stderr;
+        // WARN: DO NOT REINITIALIZE THE MUTEX
+    }
+
+    if (NULL != logger->async) {
+        return logger_async_message(logger->async, entry, format, args);
+    }
+
+    if (NULL != logger->buffered) {
+        return logger_buffered_message(logger->buffered, entry, format, args);
+    }
+
+    if (LOG_FORMAT_PLAIN != entry->format || 0 != entry->count) {
+        // Format outside the lock, then write the line with one call
+        char       line[2 * LOG_ASYNC_MESSAGE_SIZE];
+        log_text_t text   = {line, sizeof(line), 0, false};
+        size_t     length = logger_format_message(&text, entry, NULL, format, args);
+
+        pthread_mutex_lock(&logger->thread_lock);
+        fwrite(line, 1, length, logger->file_stream);
+        fflush(logger->file_stream);
+        pthread_mutex_unlock(&logger->thread_lock);
+        return true;
+    }
+
+    char prefix[128];
+    logger_format_prefix(prefix, sizeof(prefix), entry->level, entry->err);
+
+    // Only lock the thread if log_level is valid!
+    pthread_mutex_lock(&logger->thread_lock);
+
+    // Prefix log messages based on the level
+    fputs(prefix, logger->file_stream);
+
+    vfprintf(logger->file_stream, format, args);
+
+    fflush(logger->file_stream); // Ensure the message is written immediately
+
+    pthread_mutex_unlock(&logger->thread_lock);
+
+    return true;
+}
+
+/**
+ * @brief Logs a message with the specified log level to the logger's file.
+ *
+ * This function logs a message with the specified log level to the logger's
+ * file. If the logger's log level is lower than the specified log level, the
+ * message will not be logged.
+ *
+ * @param logger A pointer to the logger instance to use for logging.
+ * @param log_level The log level of the message to be logged.
+ * @param format The format string of the message to be logged.
+ * @param ... Additional arguments for formatting the message (optional).
+ *
+ * @return true if the message was successfully logged, false otherwise.
+ */
+bool logger_message(struct Logger* logger, log_level_t log_level, const char* format, ...) {
+    // block if and only if the log_level is less than the logger->log_level
+    if (log_level < logger->log_level) {
+        return false; // Do not log messages below the current logger->log_level
+    }
+
+    // Capture errno at the start of the function to avoid changes
+    log_entry_t entry = {logger->log_format, log_level, errno, NULL, 0};
+
+    va_list args;
+    va_start(args, format);
+    bool logged = logger_vmessage(logger, &entry, format, args);
+    va_end(args);
+    return logged;
+}
+
+bool logger_fields_message(
+    struct Logger*     logger,
+    log_level_t        log_level,
+    const log_field_t* fields,
+    size_t             count,
+    const char*        format,
+    ...
+) {
+    if (log_level < logger->log_level) {
+        return false;
+    }
+
+    log_entry_t entry = {logger->log_format, log_level, errno, fields, count};
+
+    va_list args;
+    va_start(args, format);
+    bool logged = logger_vmessage(logger, &entry, format, args);
+    va_end(args);
+    return logged;
+}
+
+bool logger_set_format(struct Logger* logger, log_format_t log_format) {
+    if (NULL == logger || (int) log_format < 0 || log_format > LOG_FORMAT_JSON) {
+        return false;
+    }
+    logger->log_format = log_format;
     return true;
 }
 
@@ -297,12 +2861,15 @@ bool logger_message(struct Logger* logger, log_level_t log_level, const char* fo
  * the mutex after initialization can lead to undefined behavior.
  */
 struct Logger global_logger = {
-    LOG_LEVEL_DEBUG,          /**< Logging level */
-    LOG_TYPE_STREAM,          /**< Logger type */
-    "stream",                 /**< Logger type name */
-    NULL,                     /**< File stream */
-    NULL,                     /**< File path */
-    PTHREAD_MUTEX_INITIALIZER /**< Mutex for thread safety */
+    LOG_LEVEL_DEBUG,           /**< Logging level */
+    LOG_TYPE_STREAM,           /**< Logger type */
+    "stream",                  /**< Logger type name */
+    NULL,                      /**< File stream */
+    NULL,                      /**< File path */
+    PTHREAD_MUTEX_INITIALIZER, /**< Mutex for thread safety */
+    NULL,                      /**< Asynchronous writer */
+    NULL,                      /**< Per-thread buffers */
+    LOG_FORMAT_PLAIN           /**< Line layout */
 };
 
 /**
@@ -0,0 +1,337 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file source/lut.c
+ *
+ * @brief Lookup table evaluation of exp, sigmoid, tanh, and GELU
+ *
+ * The samples are generated at compile time in double precision (see
+ * tables.hpp), so they carry no error beyond their storage format. Evaluation
+ * clamps the input into the table, splits it into an index and a fraction,
+ * and interpolates between the two neighbouring samples. Inputs outside the
+ * table are patched afterwards according to each function's asymptote.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "../include/lut.h"
+#include "../include/tables.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Samples per unit of input, 999 / 20 = 49.95
+#define LUT_INVERSE_STEP ((float) (LUT_MAX_SIZE - 1) / (EXP_MAX - EXP_MIN))
+
+// LUT_INVERSE_STEP in Q16.16, so a Q16.16 offset maps to a Q16.16 index
+#define LUT_FIXED_INVERSE_STEP \
+    ((int64_t) ((double) (LUT_MAX_SIZE - 1) / (EXP_MAX - EXP_MIN) * FIXED_VAL \
+                + 0.5))
+
+// Table bounds in Q16.16
+#define LUT_FIXED_MIN    ((int64_t) EXP_MIN * FIXED_VAL)
+#define LUT_FIXED_MAX    ((int64_t) EXP_MAX * FIXED_VAL)
+
+typedef enum LutFunction {
+    LUT_EXP,
+    LUT_SIGMOID,
+    LUT_TANH,
+    LUT_GELU,
+    LUT_FUNCTION_COUNT,
+} lut_function_t;
+
+static const float* lut_float_samples(lut_function_t function) {
+    switch (function) {
+        case LUT_EXP:
+            return table_exp();
+        case LUT_SIGMOID:
+            return table_sigmoid();
+        case LUT_TANH:
+            return table_tanh();
+        case LUT_GELU:
+        default:
+            return table_gelu();
+    }
+}
+
+static const fixed16_t* lut_fixed_samples(lut_function_t function) {
+    switch (function) {
+        case LUT_EXP:
+            return table_exp_fixed();
+        case LUT_SIGMOID:
+            return table_sigmoid_fixed();
+        case LUT_TANH:
+            return table_tanh_fixed();
+        case LUT_GELU:
+        default:
+            return table_gelu_fixed();
+    }
+}
+
+/**
+ * @brief Float evaluation
+ */
+
+static float lut_evaluate(lut_function_t function, float x) {
+    const float* table = lut_float_samples(function);
+
+    if (isnan(x)) {
+        return x;
+    }
+
+    // Clamp into the table, then split into an index and a fraction
+    float t = (x - EXP_MIN) * LUT_INVERSE_STEP;
+    t       = fminf(fmaxf(t, 0.0f), (float) (LUT_MAX_SIZE - 1));
+    int i   = (int) t;
+    i       = i < LUT_MAX_SIZE - 2 ? i : LUT_MAX_SIZE - 2;
+
+    float fraction = t - (float) i;
+    float y        = table[i] + fraction * (table[i + 1] - table[i]);
+
+    if (LUT_EXP == function) {
+        y = x < EXP_MIN ? 0.0f : (x > EXP_MAX ? expf(x) : y);
+    } else if (LUT_GELU == function) {
+        y = x < EXP_MIN ? 0.0f : (x > EXP_MAX ? x : y);
+    }
+    return y;
+}
+
+static void lut_evaluate_array(
+    lut_function_t function, const float* src, float* dst, size_t n
+) {
+    const float* table = lut_float_samples(function);
+    size_t       i     = 0;
+
+#if defined(__AVX2__)
+    const __m256  lower = _mm256_set1_ps((float) EXP_MIN);
+    const __m256  upper = _mm256_set1_ps((float) EXP_MAX);
+    const __m256  scale = _mm256_set1_ps(LUT_INVERSE_STEP);
+    const __m256  zero  = _mm256_setzero_ps();
+    const __m256  last  = _mm256_set1_ps((float) (LUT_MAX_SIZE - 1));
+    const __m256i limit = _mm256_set1_epi32(LUT_MAX_SIZE - 2);
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(src + i);
+
+        // max/min return their second operand for NaN, so t stays in range
+        __m256 t = _mm256_mul_ps(_mm256_sub_ps(x, lower), scale);
+        t        = _mm256_min_ps(_mm256_max_ps(t, zero), last);
+
+        __m256i index    = _mm256_min_epi32(_mm256_cvttps_epi32(t), limit);
+        __m256  fraction = _mm256_sub_ps(t, _mm256_cvtepi32_ps(index));
+        __m256  y0       = _mm256_i32gather_ps(table, index, 4);
+        __m256  y1       = _mm256_i32gather_ps(table + 1, index, 4);
+        __m256  y        = _mm256_add_ps(
+            y0, _mm256_mul_ps(fraction, _mm256_sub_ps(y1, y0))
+        );
+
+        __m256 below = _mm256_cmp_ps(x, lower, _CMP_LT_OQ);
+        __m256 above = _mm256_cmp_ps(x, upper, _CMP_GT_OQ);
+        if (LUT_EXP == function || LUT_GELU == function) {
+            y = _mm256_andnot_ps(below, y);
+        }
+        if (LUT_GELU == function) {
+            y = _mm256_blendv_ps(y, x, above);
+        }
+        y = _mm256_blendv_ps(y, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+
+        int overflow = LUT_EXP == function ? _mm256_movemask_ps(above) : 0;
+        if (overflow) {
+            // Rare: large exponents leave the table and go through libm
+            float inputs[8];
+            _mm256_storeu_ps(inputs, x);
+            _mm256_storeu_ps(dst + i, y);
+            for (int lane = 0; lane < 8; lane++) {
+                if (overflow & (1 << lane)) {
+                    dst[i + lane] = expf(inputs[lane]);
+                }
+            }
+        } else {
+            _mm256_storeu_ps(dst + i, y);
+        }
+    }
+#endif
+
+    (void) table;
+    for (; i < n; i++) {
+        dst[i] = lut_evaluate(function, src[i]);
+    }
+}
+
+/**
+ * @brief Fixed-point evaluation
+ *
+ * The index is computed with one 64-bit multiply by LUT_FIXED_INVERSE_STEP,
+ * and the interpolation product of a sample difference and a 16-bit fraction
+ * is rounded to nearest. The vector path performs the same integer steps, so
+ * both produce identical results.
+ */
+
+static fixed16_t lut_evaluate_fixed(lut_function_t function, fixed16_t x) {
+    const fixed16_t* table = lut_fixed_samples(function);
+
+    int64_t clamped = x < LUT_FIXED_MIN ? LUT_FIXED_MIN : x;
+    clamped         = clamped > LUT_FIXED_MAX ? LUT_FIXED_MAX : clamped;
+
+    // Q16.16 index into the table
+    int64_t t = ((clamped - LUT_FIXED_MIN) * LUT_FIXED_INVERSE_STEP)
+                >> FIXED_SIZE;
+    int64_t i = t >> FIXED_SIZE;
+    i         = i < LUT_MAX_SIZE - 2 ? i : LUT_MAX_SIZE - 2;
+
+    int64_t fraction   = t - (i << FIXED_SIZE);
+    int64_t difference = (int64_t) table[i + 1] - table[i];
+    int64_t step       = (difference * fraction + (1 << (FIXED_SIZE - 1)))
+                   >> FIXED_SIZE;
+    fixed16_t y = table[i] + (fixed16_t) step;
+
+    if (LUT_EXP == function) {
+        y = x < LUT_FIXED_MIN ? 0 : (x > LUT_FIXED_MAX ? FIXED_MAX : y);
+    } else if (LUT_GELU == function) {
+        y = x < LUT_FIXED_MIN ? 0 : (x > LUT_FIXED_MAX ? x : y);
+    }
+    return y;
+}
+
+#if defined(__AVX2__)
+// Signed 32 x 32 -> 64-bit products shifted right by 16, for all eight lanes
+static inline __m256i lut_mul_shift_epi32(__m256i a, __m256i b, __m256i bias) {
+    __m256i even = _mm256_add_epi64(_mm256_mul_epi32(a, b), bias);
+    __m256i odd  = _mm256_add_epi64(
+        _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)),
+        bias
+    );
+    // The results fit in 32 bits, so logical and arithmetic shifts agree
+    return _mm256_blend_epi32(
+        _mm256_srli_epi64(even, FIXED_SIZE),
+        _mm256_slli_epi64(_mm256_srli_epi64(odd, FIXED_SIZE), 32),
+        0xAA
+    );
+}
+#endif
+
+static void lut_evaluate_fixed_array(
+    lut_function_t function, const fixed16_t* src, fixed16_t* dst, size_t n
+) {
+    const fixed16_t* table = lut_fixed_samples(function);
+    size_t           i     = 0;
+
+#if defined(__AVX2__)
+    const __m256i lower = _mm256_set1_epi32((int32_t) LUT_FIXED_MIN);
+    const __m256i upper = _mm256_set1_epi32((int32_t) LUT_FIXED_MAX);
+    const __m256i scale = _mm256_set1_epi32((int32_t) LUT_FIXED_INVERSE_STEP);
+    const __m256i limit = _mm256_set1_epi32(LUT_MAX_SIZE - 2);
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i half  = _mm256_set1_epi64x(1 << (FIXED_SIZE - 1));
+    const __m256i max   = _mm256_set1_epi32(FIXED_MAX);
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i x       = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i clamped = _mm256_min_epi32(_mm256_max_epi32(x, lower), upper);
+        __m256i t       = lut_mul_shift_epi32(
+            _mm256_sub_epi32(clamped, lower), scale, zero
+        );
+
+        __m256i index = _mm256_min_epi32(
+            _mm256_srli_epi32(t, FIXED_SIZE), limit
+        );
+        __m256i fraction = _mm256_sub_epi32(
+            t, _mm256_slli_epi32(index, FIXED_SIZE)
+        );
+        __m256i y0       = _mm256_i32gather_epi32(table, index, 4);
+        __m256i y1       = _mm256_i32gather_epi32(table + 1, index, 4);
+        __m256i y        = _mm256_add_epi32(
+            y0, lut_mul_shift_epi32(_mm256_sub_epi32(y1, y0), fraction, half)
+        );
+
+        __m256i below = _mm256_cmpgt_epi32(lower, x);
+        __m256i above = _mm256_cmpgt_epi32(x, upper);
+        if (LUT_EXP == function) {
+            y = _mm256_andnot_si256(below, y);
+            y = _mm256_blendv_epi8(y, max, above);
+        } else if (LUT_GELU == function) {
+            y = _mm256_andnot_si256(below, y);
+            y = _mm256_blendv_epi8(y, x, above);
+        }
+
+        _mm256_storeu_si256((__m256i*) (dst + i), y);
+    }
+#endif
+
+    (void) table;
+    for (; i < n; i++) {
+        dst[i] = lut_evaluate_fixed(function, src[i]);
+    }
+}
+
+/**
+ * @brief Public entry points
+ */
+
+float lut_exp(float x) {
+    return lut_evaluate(LUT_EXP, x);
+}
+
+float lut_sigmoid(float x) {
+    return lut_evaluate(LUT_SIGMOID, x);
+}
+
+float lut_tanh(float x) {
+    return lut_evaluate(LUT_TANH, x);
+}
+
+float lut_gelu(float x) {
+    return lut_evaluate(LUT_GELU, x);
+}
+
+fixed16_t lut_exp_fixed(fixed16_t x) {
+    return lut_evaluate_fixed(LUT_EXP, x);
+}
+
+fixed16_t lut_sigmoid_fixed(fixed16_t x) {
+    return lut_evaluate_fixed(LUT_SIGMOID, x);
+}
+
+fixed16_t lut_tanh_fixed(fixed16_t x) {
+    return lut_evaluate_fixed(LUT_TANH, x);
+}
+
+fixed16_t lut_gelu_fixed(fixed16_t x) {
+    return lut_evaluate_fixed(LUT_GELU, x);
+}
+
+void lut_exp_array(const float* src, float* dst, size_t n) {
+    lut_evaluate_array(LUT_EXP, src, dst, n);
+}
+
+void lut_sigmoid_array(const float* src, float* dst, size_t n) {
+    lut_evaluate_array(LUT_SIGMOID, src, dst, n);
+}
+
+void lut_tanh_array(const float* src, float* dst, size_t n) {
+    lut_evaluate_array(LUT_TANH, src, dst, n);
+}
+
+void lut_gelu_array(const float* src, float* dst, size_t n) {
+    lut_evaluate_array(LUT_GELU, src, dst, n);
+}
+
+void lut_exp_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n) {
+    lut_evaluate_fixed_array(LUT_EXP, src, dst, n);
+}
+
+void lut_sigmoid_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n) {
+    lut_evaluate_fixed_array(LUT_SIGMOID, src, dst, n);
+}
+
+void lut_tanh_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n) {
+    lut_evaluate_fixed_array(LUT_TANH, src, dst, n);
+}
+
+void lut_gelu_fixed_array(const fixed16_t* src, fixed16_t* dst, size_t n) {
+    lut_evaluate_fixed_array(LUT_GELU, src, dst, n);
+}
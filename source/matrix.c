@@ -14,6 +14,8 @@
  * Only pure C is used with minimal dependencies on external libraries.
  */
 
+#define LOG_MODULE_ID LOG_MODULE_MATRIX
+
 #include "../include/matrix.h"
 #include "../include/logger.h"
 
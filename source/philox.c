@@ -0,0 +1,263 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file source/philox.c
+ *
+ * @brief Philox-4x32-10 counter-based RNG in pure C
+ *
+ * Title: Parallel random numbers: as easy as 1, 2, 3
+ * Paper: https://dl.acm.org/doi/10.1145/2063384.2063405
+ * Source: https://github.com/DEShawResearch/random123
+ */
+
+#include "../include/philox.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+// Mantissa fill: the top 23 bits of a word under the exponent of 1.0f
+#define PHILOX_FLOAT_SHIFT 9
+#define PHILOX_FLOAT_ONE   0x3F800000u
+
+// Words converted per stack buffer by the floating-point batches
+#define PHILOX_CHUNK 256
+
+philox_key_t philox_create_key(uint64_t seed, uint64_t stream) {
+    philox_key_t key;
+    key.key[0]    = (uint32_t) seed;
+    key.key[1]    = (uint32_t) (seed >> 32);
+    key.stream[0] = (uint32_t) stream;
+    key.stream[1] = (uint32_t) (stream >> 32);
+    return key;
+}
+
+/**
+ * @brief Block function
+ */
+
+// One round: two 32x32 -> 64-bit products mixed with the other words
+static inline void philox_round(uint32_t x[4], const uint32_t k[2]) {
+    uint64_t p0 = (uint64_t) PHILOX_M0 * x[0];
+    uint64_t p1 = (uint64_t) PHILOX_M1 * x[2];
+
+    uint32_t y0 = (uint32_t) (p1 >> 32) ^ x[1] ^ k[0];
+    uint32_t y2 = (uint32_t) (p0 >> 32) ^ x[3] ^ k[1];
+
+    x[0] = y0;
+    x[1] = (uint32_t) p1;
+    x[2] = y2;
+    x[3] = (uint32_t) p0;
+}
+
+void philox_4x32_10(
+    const uint32_t counter[PHILOX_BLOCK_SIZE],
+    const uint32_t key[2],
+    uint32_t       out[PHILOX_BLOCK_SIZE]
+) {
+    uint32_t k[2] = {key[0], key[1]};
+
+    for (size_t i = 0; i < PHILOX_BLOCK_SIZE; i++) {
+        out[i] = counter[i];
+    }
+
+    for (size_t r = 0; r < PHILOX_ROUNDS; r++) {
+        if (r > 0) {
+            k[0] += PHILOX_W0;
+            k[1] += PHILOX_W1;
+        }
+        philox_round(out, k);
+    }
+}
+
+// The block at a 64-bit block index of the stream
+static inline void philox_block(
+    const philox_key_t* key, uint64_t block, uint32_t out[PHILOX_BLOCK_SIZE]
+) {
+    const uint32_t counter[PHILOX_BLOCK_SIZE] = {
+        (uint32_t) block,
+        (uint32_t) (block >> 32),
+        key->stream[0],
+        key->stream[1],
+    };
+    philox_4x32_10(counter, key->key, out);
+}
+
+#if defined(__AVX2__)
+// High and low halves of eight 32x32 -> 64-bit products
+static inline void philox_mulhilo_epi32(
+    __m256i a, __m256i x, __m256i* hi, __m256i* lo
+) {
+    __m256i even = _mm256_mul_epu32(a, x);
+    __m256i odd  = _mm256_mul_epu32(a, _mm256_srli_epi64(x, 32));
+
+    *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/*
+ * Eight consecutive blocks starting at block, one block per lane with word
+ * w of every block in x[w]. The 32-bit block counter of a lane may carry
+ * into the next word independently of the others.
+ */
+static void philox_block_x8(
+    const philox_key_t* key, uint64_t block, uint32_t* out
+) {
+    const __m256i m0 = _mm256_set1_epi32((int) PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi32((int) PHILOX_M1);
+
+    uint32_t low[8];
+    uint32_t high[8];
+    for (size_t j = 0; j < 8; j++) {
+        low[j]  = (uint32_t) (block + j);
+        high[j] = (uint32_t) ((block + j) >> 32);
+    }
+
+    __m256i  x0 = _mm256_loadu_si256((const __m256i*) low);
+    __m256i  x1 = _mm256_loadu_si256((const __m256i*) high);
+    __m256i  x2 = _mm256_set1_epi32((int) key->stream[0]);
+    __m256i  x3 = _mm256_set1_epi32((int) key->stream[1]);
+    uint32_t k0 = key->key[0];
+    uint32_t k1 = key->key[1];
+
+    for (size_t r = 0; r < PHILOX_ROUNDS; r++) {
+        if (r > 0) {
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        __m256i hi0, lo0, hi1, lo1;
+        philox_mulhilo_epi32(m0, x0, &hi0, &lo0);
+        philox_mulhilo_epi32(m1, x2, &hi1, &lo1);
+
+        x0 = _mm256_xor_si256(
+            _mm256_xor_si256(hi1, x1), _mm256_set1_epi32((int) k0)
+        );
+        x1 = lo1;
+        x2 = _mm256_xor_si256(
+            _mm256_xor_si256(hi0, x3), _mm256_set1_epi32((int) k1)
+        );
+        x3 = lo0;
+    }
+
+    // Transpose words-by-lane into blocks in memory order
+    __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    __m256i t1 = _mm256_unpackhi_epi32(x0, x1);
+    __m256i t2 = _mm256_unpacklo_epi32(x2, x3);
+    __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2); // blocks 0 and 4
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2); // blocks 1 and 5
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3); // blocks 2 and 6
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3); // blocks 3 and 7
+
+    __m256i* dst = (__m256i*) out;
+    _mm256_storeu_si256(dst + 0, _mm256_permute2x128_si256(u0, u1, 0x20));
+    _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(u2, u3, 0x20));
+    _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(u0, u1, 0x31));
+    _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(u2, u3, 0x31));
+}
+#endif
+
+/**
+ * @brief Scalar access
+ */
+
+static inline float philox_to_float(uint32_t bits) {
+    union {
+        uint32_t bits;
+        float    value;
+    } f32;
+
+    f32.bits = PHILOX_FLOAT_ONE | (bits >> PHILOX_FLOAT_SHIFT);
+
+    return f32.value - 1.0f;
+}
+
+static inline double philox_to_double(uint32_t bits) {
+    return (double) bits * 0x1p-32;
+}
+
+uint32_t philox_generate_bits(const philox_key_t* key, uint64_t index) {
+    uint32_t block[PHILOX_BLOCK_SIZE];
+    philox_block(key, index / PHILOX_BLOCK_SIZE, block);
+    return block[index % PHILOX_BLOCK_SIZE];
+}
+
+double philox_generate(const philox_key_t* key, uint64_t index) {
+    return philox_to_double(philox_generate_bits(key, index));
+}
+
+float philox_generate_float(const philox_key_t* key, uint64_t index) {
+    return philox_to_float(philox_generate_bits(key, index));
+}
+
+/**
+ * @brief Batched access
+ */
+
+void philox_generate_batch_bits(
+    const philox_key_t* key, uint64_t offset, uint32_t* out, size_t n
+) {
+    uint32_t block[PHILOX_BLOCK_SIZE];
+    uint64_t index = offset / PHILOX_BLOCK_SIZE;
+    size_t   skip  = offset % PHILOX_BLOCK_SIZE;
+    size_t   i     = 0;
+
+    // Leading partial block
+    if (skip && n) {
+        philox_block(key, index++, block);
+        for (; skip < PHILOX_BLOCK_SIZE && i < n; skip++) {
+            out[i++] = block[skip];
+        }
+    }
+
+#if defined(__AVX2__)
+    for (; i + 8 * PHILOX_BLOCK_SIZE <= n; i += 8 * PHILOX_BLOCK_SIZE) {
+        philox_block_x8(key, index, out + i);
+        index += 8;
+    }
+#endif
+
+    for (; i + PHILOX_BLOCK_SIZE <= n; i += PHILOX_BLOCK_SIZE) {
+        philox_block(key, index++, out + i);
+    }
+
+    // Trailing partial block
+    if (i < n) {
+        philox_block(key, index, block);
+        for (size_t j = 0; i < n; j++) {
+            out[i++] = block[j];
+        }
+    }
+}
+
+void philox_generate_batch(
+    const philox_key_t* key, uint64_t offset, double* out, size_t n
+) {
+    uint32_t bits[PHILOX_CHUNK];
+
+    for (size_t i = 0; i < n; i += PHILOX_CHUNK) {
+        size_t width = n - i < PHILOX_CHUNK ? n - i : PHILOX_CHUNK;
+
+        philox_generate_batch_bits(key, offset + i, bits, width);
+        for (size_t j = 0; j < width; j++) {
+            out[i + j] = philox_to_double(bits[j]);
+        }
+    }
+}
+
+void philox_generate_batch_float(
+    const philox_key_t* key, uint64_t offset, float* out, size_t n
+) {
+    uint32_t bits[PHILOX_CHUNK];
+
+    for (size_t i = 0; i < n; i += PHILOX_CHUNK) {
+        size_t width = n - i < PHILOX_CHUNK ? n - i : PHILOX_CHUNK;
+
+        philox_generate_batch_bits(key, offset + i, bits, width);
+        for (size_t j = 0; j < width; j++) {
+            out[i + j] = philox_to_float(bits[j]);
+        }
+    }
+}
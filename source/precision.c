@@ -10,7 +10,7 @@
  *   - 32-bit (float)
  *   - 16-bit (IEEE-754 Half Precision)
  *   - 16-bit (Google Brain Precision)
- *   - 8-bit (Extended IEEE-754 Quarter Precision)
+ *   - 8-bit (OCP E4M3 and E5M2)
  *
  * Only pure C is used with minimal dependencies on external libraries.
  *
@@ -24,12 +24,24 @@
  * @ref /usr/include/c10/util/half.h
  * @ref https://github.com/Maratyszcza/FP16
  * @ref https://github.com/pytorch/pytorch/blob/main/c10/util/Half.h
+ *
+ * @note 8-bit floating-point formats
+ * @ref https://www.opencompute.org/documents/ocp-8-bit-floating-point-specification-ofp8-revision-1-0-2023-12-01-pdf-1
  */
 
 #include "../include/precision.h"
+#include "../include/lehmer.h"
+#include "../include/tables.h"
 
 #include <math.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__AVX2__) || defined(__F16C__)
+    #include <immintrin.h>
+#endif
 
 // Determines if two floating-point values are approximately equal within
 // specified tolerances.
@@ -154,6 +166,176 @@ float decode_float16(float16_t bits) {
     return decode_float32(result);
 }
 
+// NOTE: Written once by calibration or by the user; a stale read only picks a
+// slower path, never a wrong result.
+static volatile precision_decode_path_t float16_decode_path
+    = PRECISION_DECODE_AUTO;
+
+// The decode table is generated at compile time; see source/tables.cpp
+float decode_float16_lut(float16_t bits) {
+    return decode_float32(table_float16_decode()[bits]);
+}
+
+#if !defined(__F16C__)
+// True if the decode table and the streamed data are likely to stay in L2
+static bool float16_lut_fits_cache(void) {
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    long cache_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (cache_size > 0) {
+        return (size_t) cache_size >= 2 * FLOAT16_LUT_BYTES;
+    }
+#endif
+    return false; // unknown cache size; prefer the path without a footprint
+}
+#endif
+
+static void float16_decode_arithmetic(
+    const float16_t* src, float* dst, size_t n
+) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = decode_float16(src[i]);
+    }
+}
+
+static void float16_decode_lut(const float16_t* src, float* dst, size_t n) {
+    const uint32_t* table = table_float16_decode();
+    size_t          i     = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i halves  = _mm_loadu_si128((const __m128i*) (src + i));
+        __m256i indices = _mm256_cvtepu16_epi32(halves);
+        __m256i bits
+            = _mm256_i32gather_epi32((const int*) table, indices, 4);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(bits));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = decode_float32(table[src[i]]);
+    }
+}
+
+static void float16_decode_f16c(const float16_t* src, float* dst, size_t n) {
+#if defined(__F16C__)
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i halves = _mm_loadu_si128((const __m128i*) (src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(halves));
+    }
+    float16_decode_arithmetic(src + i, dst + i, n - i);
+#else
+    float16_decode_arithmetic(src, dst, n);
+#endif
+}
+
+void float16_set_decode_path(precision_decode_path_t path) {
+    float16_decode_path = path;
+}
+
+precision_decode_path_t float16_get_decode_path(size_t n) {
+    precision_decode_path_t path = float16_decode_path;
+    if (PRECISION_DECODE_AUTO != path) {
+        return path;
+    }
+
+#if defined(__F16C__)
+    (void) n;
+    return PRECISION_DECODE_F16C;
+#else
+    if (n >= FLOAT16_LUT_MIN_ELEMENTS && float16_lut_fits_cache()) {
+        return PRECISION_DECODE_LUT;
+    }
+    return PRECISION_DECODE_ARITHMETIC;
+#endif
+}
+
+void decode_float16_array_path(
+    const float16_t* src, float* dst, size_t n, precision_decode_path_t path
+) {
+    if (PRECISION_DECODE_AUTO == path) {
+        path = float16_get_decode_path(n);
+    }
+
+    switch (path) {
+        case PRECISION_DECODE_LUT:
+            float16_decode_lut(src, dst, n);
+            break;
+        case PRECISION_DECODE_F16C:
+            float16_decode_f16c(src, dst, n);
+            break;
+        case PRECISION_DECODE_ARITHMETIC:
+        default:
+            float16_decode_arithmetic(src, dst, n);
+            break;
+    }
+}
+
+void decode_float16_array(const float16_t* src, float* dst, size_t n) {
+    decode_float16_array_path(src, dst, n, PRECISION_DECODE_AUTO);
+}
+
+#if !defined(__F16C__)
+// Seconds spent decoding the workload with the given path, best of a few runs
+static double float16_time_decode(
+    const float16_t* src, float* dst, size_t n, precision_decode_path_t path
+) {
+    double best = INFINITY;
+    for (int run = 0; run < 5; run++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        decode_float16_array_path(src, dst, n, path);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double elapsed = (double) (end.tv_sec - start.tv_sec)
+                         + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+#endif
+
+precision_decode_path_t float16_calibrate_decode(size_t n) {
+#if defined(__F16C__)
+    (void) n;
+    float16_set_decode_path(PRECISION_DECODE_F16C);
+    return PRECISION_DECODE_F16C;
+#else
+    if (0 == n) {
+        n = FLOAT16_LUT_MIN_ELEMENTS;
+    }
+
+    float16_t* src = (float16_t*) malloc(n * sizeof(float16_t));
+    float*     dst = (float*) malloc(n * sizeof(float));
+    if (NULL == src || NULL == dst) {
+        free(src);
+        free(dst);
+        return float16_get_decode_path(n);
+    }
+
+    // Spread the inputs over the whole table so the measurement includes
+    // realistic cache behavior rather than a handful of hot lines.
+    uint32_t x = UINT32_C(0x9E3779B9);
+    for (size_t i = 0; i < n; i++) {
+        x      = x * UINT32_C(1664525) + UINT32_C(1013904223);
+        src[i] = (float16_t) (x >> 16);
+    }
+
+    double arithmetic
+        = float16_time_decode(src, dst, n, PRECISION_DECODE_ARITHMETIC);
+    double lut = float16_time_decode(src, dst, n, PRECISION_DECODE_LUT);
+
+    free(src);
+    free(dst);
+
+    precision_decode_path_t path = lut < arithmetic
+                                       ? PRECISION_DECODE_LUT
+                                       : PRECISION_DECODE_ARITHMETIC;
+    float16_set_decode_path(path);
+    return path;
+#endif
+}
+
 bfloat16_t encode_bfloat16(float value) {
     float_data_t f32;
     f32.value = value;
@@ -171,10 +353,9 @@ bfloat16_t encode_bfloat16(float value) {
         return (bits >> 16) & 0x8000;
     }
 
-    // Rounding: round to nearest even
-    uint32_t rounding_bias = (bits & 0x0000ffff) > 0x00007fff    ? 1
-                             : (bits & 0x00018000) == 0x00018000 ? 1
-                                                                 : 0;
+    // Rounding: round to nearest even. Half an ulp less one is added, plus
+    // one more when the retained lsb is odd so that ties round to even.
+    uint32_t rounding_bias = 0x00007fff + ((bits >> 16) & 1);
     return (bits + rounding_bias) >> 16;
 }
 
@@ -193,8 +374,8 @@ float decode_bfloat16(bfloat16_t bits) {
 
     // Check for NaN or infinity
     if ((result & 0x7f800000) == 0x7f800000) {
-        // NaN or infinity case
-        return result & 0x00400000 ? NAN : INFINITY;
+        // NaN or infinity case; sign and payload carry over unchanged
+        return decode_float32(result);
     }
 
     // Subnormal or zero
@@ -205,59 +386,374 @@ float decode_bfloat16(bfloat16_t bits) {
     return decode_float32(result);
 }
 
+void encode_float16_array(const float* src, float16_t* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i halves = _mm256_cvtps_ph(
+            _mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT
+        );
+        _mm_storeu_si128((__m128i*) (dst + i), halves);
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = encode_float16(src[i]);
+    }
+}
+
+void encode_bfloat16_array(const float* src, bfloat16_t* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = encode_bfloat16(src[i]);
+    }
+}
+
+void decode_bfloat16_array(const bfloat16_t* src, float* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint32_t bits = (uint32_t) src[i] << 16;
+        // Flush subnormals to signed zero, matching decode_bfloat16()
+        bits = (bits & UINT32_C(0x7F800000)) ? bits
+                                             : bits & UINT32_C(0x80000000);
+        dst[i] = decode_float32(bits);
+    }
+}
+
+/*
+ * 8-bit floating-point formats share one encoder. The format is described by
+ * the number of mantissa bits, the exponent bias, and the largest finite and
+ * NaN encodings. Decoding reads the tables generated in source/tables.cpp.
+ */
+
+/*
+ * Convert a 32-bit float to an 8-bit float with round-to-nearest-even and
+ * saturation. Every path is computed and the result is selected so the bulk
+ * converters can vectorize this function.
+ */
+static inline float8_t float8_encode(
+    float value, uint32_t mantissa, uint32_t bias, uint32_t max, uint32_t nan
+) {
+    const uint32_t f     = encode_float32(value);
+    const uint32_t sign  = (f >> 24) & UINT32_C(0x80);
+    const uint32_t abs_f = f & UINT32_C(0x7FFFFFFF);
+    const uint32_t shift = 23 - mantissa;
+
+    // Normal: drop the low mantissa bits with round to nearest even, then
+    // rebias the exponent. A mantissa carry propagates into the exponent.
+    const uint32_t odd    = (abs_f >> shift) & 1;
+    const uint32_t normal = ((abs_f + (UINT32_C(1) << (shift - 1)) - 1 + odd)
+                             >> shift)
+                            - ((127 - bias) << mantissa);
+
+    // Subnormal: add a magic number whose ulp equals the smallest subnormal
+    // step, 2^(1 - bias - mantissa), and let the FPU round to nearest even.
+    const float    magic     = decode_float32((151 - bias - mantissa) << 23);
+    const uint32_t subnormal = encode_float32(decode_float32(abs_f) + magic)
+                               - encode_float32(magic);
+
+    // Smallest normal magnitude in the target format, 2^(1 - bias)
+    const uint32_t min_normal = (128 - bias) << 23;
+
+    uint32_t bits = abs_f < min_normal ? subnormal : normal;
+    bits          = bits > max ? max : bits;                   // saturate
+    bits          = abs_f > UINT32_C(0x7F800000) ? nan : bits; // NaN
+    return (float8_t) (sign | bits);
+}
+
+// Encode 32-bit floats into 8-bit floats, eight lanes at a time with AVX2
+static void float8_encode_array(
+    const float* src,
+    float8_t*    dst,
+    size_t       n,
+    uint32_t     mantissa,
+    uint32_t     bias,
+    uint32_t     max,
+    uint32_t     nan
+) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m128i shift      = _mm_cvtsi32_si128((int) (23 - mantissa));
+    const __m256i round      = _mm256_set1_epi32((1 << (22 - mantissa)) - 1);
+    const __m256i rebias     = _mm256_set1_epi32((127 - bias) << mantissa);
+    const __m256i one        = _mm256_set1_epi32(1);
+    const __m256i abs_mask   = _mm256_set1_epi32(0x7FFFFFFF);
+    const __m256i sign_mask  = _mm256_set1_epi32(0x80);
+    const __m256i inf_bits   = _mm256_set1_epi32(0x7F800000);
+    const __m256i min_normal = _mm256_set1_epi32((128 - bias) << 23);
+    const __m256i max_bits   = _mm256_set1_epi32(max);
+    const __m256i nan_bits   = _mm256_set1_epi32(nan);
+    const __m256i magic_int  = _mm256_set1_epi32((151 - bias - mantissa) << 23);
+    const __m256  magic      = _mm256_castsi256_ps(magic_int);
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i f     = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i sign  = _mm256_and_si256(_mm256_srli_epi32(f, 24), sign_mask);
+        __m256i abs_f = _mm256_and_si256(f, abs_mask);
+
+        // Normal: round to nearest even, truncate, and rebias
+        __m256i odd    = _mm256_and_si256(_mm256_srl_epi32(abs_f, shift), one);
+        __m256i normal = _mm256_add_epi32(_mm256_add_epi32(abs_f, round), odd);
+        normal = _mm256_sub_epi32(_mm256_srl_epi32(normal, shift), rebias);
+
+        // Subnormal: magic number addition
+        __m256i subnormal = _mm256_sub_epi32(
+            _mm256_castps_si256(
+                _mm256_add_ps(_mm256_castsi256_ps(abs_f), magic)
+            ),
+            magic_int
+        );
+
+        __m256i is_subnormal = _mm256_cmpgt_epi32(min_normal, abs_f);
+        __m256i is_nan       = _mm256_cmpgt_epi32(abs_f, inf_bits);
+        __m256i bits = _mm256_blendv_epi8(normal, subnormal, is_subnormal);
+        bits         = _mm256_min_epu32(bits, max_bits);
+        bits         = _mm256_blendv_epi8(bits, nan_bits, is_nan);
+        bits         = _mm256_or_si256(bits, sign);
+
+        // Narrow 8 x 32-bit lanes to 8 bytes
+        __m128i words = _mm_packus_epi32(
+            _mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1)
+        );
+        _mm_storel_epi64((__m128i*) (dst + i), _mm_packus_epi16(words, words));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = float8_encode(src[i], mantissa, bias, max, nan);
+    }
+}
+
+// Decode 8-bit floats by gathering through a 256-entry table of f32 bits
+static void float8_decode_array(
+    const uint32_t* table, const float8_t* src, float* dst, size_t n
+) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i bytes   = _mm_loadl_epi64((const __m128i*) (src + i));
+        __m256i indices = _mm256_cvtepu8_epi32(bytes);
+        __m256i bits
+            = _mm256_i32gather_epi32((const int*) table, indices, 4);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(bits));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = decode_float32(table[src[i]]);
+    }
+}
+
+float8_t encode_float8_e4m3(float value) {
+    return float8_encode(value, 3, 7, FLOAT8_E4M3_MAX, FLOAT8_E4M3_NAN);
+}
+
+float decode_float8_e4m3(float8_t bits) {
+    return decode_float32(table_float8_e4m3_decode()[bits]);
+}
+
+float8_t encode_float8_e5m2(float value) {
+    return float8_encode(value, 2, 15, FLOAT8_E5M2_MAX, FLOAT8_E5M2_NAN);
+}
+
+float decode_float8_e5m2(float8_t bits) {
+    return decode_float32(table_float8_e5m2_decode()[bits]);
+}
+
 // Convert a 32-bit floating-point number to an 8-bit floating-point number
 float8_t encode_float8(float value) {
-    // TODO: Implement correct conversion logic
-    float32_t f = encode_float32(value);
-
-    uint32_t  sign     = (f >> 7) & 0x1;
-    float32_t exponent = ((f >> 23) & 0xFF) - 127 + 3; // Adjust exponent bias
-    float32_t mantissa
-        = (f >> 19) & 0x0F; // Extract the 4 most significant bits
-
-    if (exponent <= 0) {
-        // Handle subnormal numbers
-        if (exponent < -3) {
-            return sign << 7; // Return signed zero
-        }
-        mantissa  |= 0x10;                      // Restore implicit bit
-        mantissa >>= (1 - exponent);            // Adjust mantissa
-        return (sign << 7) | (mantissa & 0x7F); // Assemble bits
-    } else if (exponent >= 7) {
-        // Handle overflow to infinity
-        return (sign << 7) | 0x78; // Infinity
-    } else {
-        // Normalized number
-        return (sign << 7) | (exponent << 4) | mantissa;
-    }
+    return encode_float8_e4m3(value);
 }
 
 // Convert an 8-bit floating-point number to a 32-bit floating-point number
 float decode_float8(float8_t bits) {
-    // TODO: Implement correct conversion logic
-    float32_t sign     = (bits >> 7) & 0x1;
-    float32_t exponent = (bits >> 4) & 0x07;
-    float32_t mantissa = bits & 0x0F;
-
-    if (exponent == 0) {
-        if (mantissa == 0) {
-            return sign ? -0.0f : 0.0f; // Signed zero
+    return decode_float8_e4m3(bits);
+}
+
+void encode_float8_e4m3_array(const float* src, float8_t* dst, size_t n) {
+    float8_encode_array(src, dst, n, 3, 7, FLOAT8_E4M3_MAX, FLOAT8_E4M3_NAN);
+}
+
+void decode_float8_e4m3_array(const float8_t* src, float* dst, size_t n) {
+    float8_decode_array(table_float8_e4m3_decode(), src, dst, n);
+}
+
+void encode_float8_e5m2_array(const float* src, float8_t* dst, size_t n) {
+    float8_encode_array(src, dst, n, 2, 15, FLOAT8_E5M2_MAX, FLOAT8_E5M2_NAN);
+}
+
+void decode_float8_e5m2_array(const float8_t* src, float* dst, size_t n) {
+    float8_decode_array(table_float8_e5m2_decode(), src, dst, n);
+}
+
+/*
+ * Stochastic rounding adds uniformly distributed random bits below the
+ * retained precision and truncates, so a value rounds up with probability
+ * equal to the discarded fraction.
+ */
+
+bfloat16_t encode_bfloat16_stochastic(float value, uint32_t random) {
+    const uint32_t bits = encode_float32(value);
+
+    // Handle NaN: force to quiet NaN
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+        return (bits >> 16) | 0x0040;
+    }
+
+    // Handle subnormals: flush to zero
+    if ((bits & 0x7f800000) == 0) {
+        return (bits >> 16) & 0x8000;
+    }
+
+    // Infinities have a zero mantissa and must not be rounded into NaNs
+    if ((bits & 0x7fffffff) == 0x7f800000) {
+        return bits >> 16;
+    }
+
+    return (bits + (random & 0xffff)) >> 16;
+}
+
+static inline float8_t float8_encode_stochastic(
+    float    value,
+    uint32_t random,
+    uint32_t mantissa,
+    uint32_t bias,
+    uint32_t max,
+    uint32_t nan
+) {
+    const uint32_t f        = encode_float32(value);
+    const uint32_t sign     = (f >> 24) & UINT32_C(0x80);
+    const uint32_t abs_f    = f & UINT32_C(0x7FFFFFFF);
+    const uint32_t exponent = abs_f >> 23;
+
+    if (abs_f > UINT32_C(0x7F800000)) {
+        return (float8_t) (sign | nan);
+    }
+
+    uint32_t bits;
+    if (exponent >= 128 - bias) {
+        // Normal: the mantissa carry propagates into the exponent
+        const uint32_t shift = 23 - mantissa;
+        const uint32_t noise = random & ((UINT32_C(1) << shift) - 1);
+        bits = ((abs_f + noise) >> shift) - ((127 - bias) << mantissa);
+        if (abs_f >= UINT32_C(0x7F800000) || bits > max) {
+            bits = max; // saturate
         }
-        // Subnormal number
-        exponent = 1 - 3;
-        return decode_float32(
-            (sign << 31) | (exponent << 23) | (mantissa << 19)
-        );
-    } else if (exponent == 7) {
-        // Infinity or NaN
-        if (mantissa == 0) {
-            return sign ? -INFINITY : INFINITY;
+    } else {
+        // Subnormal: align the significand to the smallest subnormal step,
+        // 2^(1 - bias - mantissa)
+        const uint32_t significand = exponent ? (abs_f & UINT32_C(0x7FFFFF))
+                                                    | UINT32_C(0x800000)
+                                              : abs_f;
+        const uint32_t shift
+            = 151 - bias - mantissa - (exponent ? exponent : 1);
+        if (shift >= 32) {
+            bits = 0; // below 2^-8 of the smallest subnormal
         } else {
-            return NAN; // Not a number
+            const uint32_t noise = random & ((UINT32_C(1) << shift) - 1);
+            bits = (uint32_t) (((uint64_t) significand + noise) >> shift);
+        }
+    }
+
+    return (float8_t) (sign | bits);
+}
+
+float8_t encode_float8_e4m3_stochastic(float value, uint32_t random) {
+    return float8_encode_stochastic(
+        value, random, 3, 7, FLOAT8_E4M3_MAX, FLOAT8_E4M3_NAN
+    );
+}
+
+float8_t encode_float8_e5m2_stochastic(float value, uint32_t random) {
+    return float8_encode_stochastic(
+        value, random, 2, 15, FLOAT8_E5M2_MAX, FLOAT8_E5M2_NAN
+    );
+}
+
+// Number of random words drawn onto the stack at a time
+#define PRECISION_RANDOM_CHUNK 256
+
+/*
+ * Fill bits with n draws from consecutive streams of the state. Lane j uses
+ * stream (state->stream + j) % state->size; the lanes advance in lockstep so
+ * the inner loop vectorizes, and the seeds are written back afterwards.
+ */
+static void precision_random_bits(
+    lehmer_state_t* state, uint32_t* bits, size_t n
+) {
+    uint64_t seed[PRECISION_RANDOM_LANES];
+    size_t   lanes = state->size < PRECISION_RANDOM_LANES
+                         ? state->size
+                         : PRECISION_RANDOM_LANES;
+
+    // No streams to draw from; zero bits round toward zero
+    if (0 == lanes) {
+        memset(bits, 0, sizeof(uint32_t) * n);
+        return;
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+        seed[j] = state->seed[(state->stream + j) % state->size];
+    }
+
+    for (size_t i = 0; i < n; i += lanes) {
+        size_t width = n - i < lanes ? n - i : lanes;
+        for (size_t j = 0; j < width; j++) {
+            seed[j]     = lehmer_step(seed[j]);
+            bits[i + j] = (uint32_t) seed[j];
         }
     }
 
-    // Normalized number
-    exponent = exponent - 3 + 127;
-    return decode_float32((sign << 31) | (exponent << 23) | (mantissa << 19));
+    for (size_t j = 0; j < lanes; j++) {
+        state->seed[(state->stream + j) % state->size] = seed[j];
+    }
+}
+
+void encode_bfloat16_stochastic_array(
+    const float* src, bfloat16_t* dst, size_t n, lehmer_state_t* state
+) {
+    uint32_t random[PRECISION_RANDOM_CHUNK];
+
+    for (size_t i = 0; i < n; i += PRECISION_RANDOM_CHUNK) {
+        size_t width = n - i;
+        width = width < PRECISION_RANDOM_CHUNK ? width : PRECISION_RANDOM_CHUNK;
+
+        precision_random_bits(state, random, width);
+        for (size_t j = 0; j < width; j++) {
+            dst[i + j] = encode_bfloat16_stochastic(src[i + j], random[j]);
+        }
+    }
+}
+
+void encode_float8_e4m3_stochastic_array(
+    const float* src, float8_t* dst, size_t n, lehmer_state_t* state
+) {
+    uint32_t random[PRECISION_RANDOM_CHUNK];
+
+    for (size_t i = 0; i < n; i += PRECISION_RANDOM_CHUNK) {
+        size_t width = n - i;
+        width = width < PRECISION_RANDOM_CHUNK ? width : PRECISION_RANDOM_CHUNK;
+
+        precision_random_bits(state, random, width);
+        for (size_t j = 0; j < width; j++) {
+            dst[i + j] = encode_float8_e4m3_stochastic(src[i + j], random[j]);
+        }
+    }
+}
+
+void encode_float8_e5m2_stochastic_array(
+    const float* src, float8_t* dst, size_t n, lehmer_state_t* state
+) {
+    uint32_t random[PRECISION_RANDOM_CHUNK];
+
+    for (size_t i = 0; i < n; i += PRECISION_RANDOM_CHUNK) {
+        size_t width = n - i;
+        width = width < PRECISION_RANDOM_CHUNK ? width : PRECISION_RANDOM_CHUNK;
+
+        precision_random_bits(state, random, width);
+        for (size_t j = 0; j < width; j++) {
+            dst[i + j] = encode_float8_e5m2_stochastic(src[i + j], random[j]);
+        }
+    }
 }
@@ -0,0 +1,147 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file source/tables.cpp
+ *
+ * @brief Lookup tables generated at compile time
+ *
+ * Each table is a constexpr variable, so it is evaluated by the compiler and
+ * placed in read-only data. The static_asserts pin a few known entries so a
+ * generator regression fails the build rather than a downstream test.
+ */
+
+#include "../include/tables.h"
+#include "../include/tables.hpp"
+
+namespace {
+
+using tables::generate;
+using tables::Table;
+
+constexpr auto FLOAT16_DECODE = generate<std::uint32_t, 65536>(
+    tables::float16_decode_bits
+);
+
+constexpr auto FLOAT8_E4M3_DECODE = generate<std::uint32_t, 256>(
+    [](std::size_t i) { return tables::float8_decode_bits(i, 3, 7, false); }
+);
+
+constexpr auto FLOAT8_E5M2_DECODE = generate<std::uint32_t, 256>(
+    [](std::size_t i) { return tables::float8_decode_bits(i, 2, 15, true); }
+);
+
+constexpr auto EXP     = tables::lut_float(tables::exp);
+constexpr auto SIGMOID = tables::lut_float(tables::sigmoid);
+constexpr auto TANH    = tables::lut_float(tables::tanh);
+constexpr auto GELU    = tables::lut_float(tables::gelu);
+
+constexpr auto EXP_FIXED     = tables::lut_fixed(tables::exp);
+constexpr auto SIGMOID_FIXED = tables::lut_fixed(tables::sigmoid);
+constexpr auto TANH_FIXED    = tables::lut_fixed(tables::tanh);
+constexpr auto GELU_FIXED    = tables::lut_fixed(tables::gelu);
+
+constexpr auto SIN = generate<float, tables::TRIG_SIZE>([](std::size_t i) {
+    return static_cast<float>(tables::sin(tables::trig_input(i)));
+});
+
+constexpr auto COS = generate<float, tables::TRIG_SIZE>([](std::size_t i) {
+    return static_cast<float>(tables::cos(tables::trig_input(i)));
+});
+
+constexpr auto ZIGGURAT = tables::ziggurat();
+
+static_assert(TABLE_TRIG_SIZE == tables::TRIG_SIZE, "trig table size");
+static_assert(TABLE_ZIGGURAT_SIZE == tables::ZIGGURAT_SIZE, "ziggurat size");
+static_assert(TABLE_ZIGGURAT_BITS == tables::ZIGGURAT_BITS, "ziggurat bits");
+static_assert(TABLE_ZIGGURAT_R == tables::ZIGGURAT_R, "ziggurat tail");
+
+// 1.0, the smallest subnormal, -infinity, and a quiet NaN payload
+static_assert(FLOAT16_DECODE[0x3C00] == 0x3F800000u, "f16 one");
+static_assert(FLOAT16_DECODE[0x0001] == 0x33800000u, "f16 subnormal");
+static_assert(FLOAT16_DECODE[0xFC00] == 0xFF800000u, "f16 -inf");
+static_assert(FLOAT16_DECODE[0x7C01] == 0x7FC02000u, "f16 NaN");
+
+// 448 and 57344 are the largest finite E4M3 and E5M2 values
+static_assert(FLOAT8_E4M3_DECODE[0x7E] == 0x43E00000u, "e4m3 max");
+static_assert(FLOAT8_E4M3_DECODE[0x01] == 0x3B000000u, "e4m3 subnormal");
+static_assert(FLOAT8_E5M2_DECODE[0x7B] == 0x47600000u, "e5m2 max");
+static_assert(FLOAT8_E5M2_DECODE[0x7C] == 0x7F800000u, "e5m2 inf");
+
+// sigmoid(-10) ~ 4.54e-5 rounds to 3 lsb; sin(pi / 2) rounds to exactly 1
+static_assert(SIGMOID_FIXED[0] == 3, "sigmoid(-10) in Q16.16");
+static_assert(SIN[tables::TRIG_SIZE / 4] == 1.0f, "sin(pi / 2)");
+
+// The innermost strip edge lands at ~0.2723 and the top strip has no core
+static_assert(ZIGGURAT.w[1] > 0.2722 / 8388608.0, "ziggurat top strip");
+static_assert(ZIGGURAT.w[1] < 0.2724 / 8388608.0, "ziggurat top strip");
+static_assert(ZIGGURAT.k[1] == 0, "ziggurat top strip");
+
+} // namespace
+
+extern "C" {
+
+const uint32_t* table_float16_decode(void) {
+    return FLOAT16_DECODE.values;
+}
+
+const uint32_t* table_float8_e4m3_decode(void) {
+    return FLOAT8_E4M3_DECODE.values;
+}
+
+const uint32_t* table_float8_e5m2_decode(void) {
+    return FLOAT8_E5M2_DECODE.values;
+}
+
+const float* table_exp(void) {
+    return EXP.values;
+}
+
+const float* table_sigmoid(void) {
+    return SIGMOID.values;
+}
+
+const float* table_tanh(void) {
+    return TANH.values;
+}
+
+const float* table_gelu(void) {
+    return GELU.values;
+}
+
+const fixed16_t* table_exp_fixed(void) {
+    return EXP_FIXED.values;
+}
+
+const fixed16_t* table_sigmoid_fixed(void) {
+    return SIGMOID_FIXED.values;
+}
+
+const fixed16_t* table_tanh_fixed(void) {
+    return TANH_FIXED.values;
+}
+
+const fixed16_t* table_gelu_fixed(void) {
+    return GELU_FIXED.values;
+}
+
+const float* table_sin(void) {
+    return SIN.values;
+}
+
+const float* table_cos(void) {
+    return COS.values;
+}
+
+const uint32_t* table_ziggurat_k(void) {
+    return ZIGGURAT.k;
+}
+
+const double* table_ziggurat_w(void) {
+    return ZIGGURAT.w;
+}
+
+const double* table_ziggurat_f(void) {
+    return ZIGGURAT.f;
+}
+
+} // extern "C"
@@ -14,6 +14,8 @@
  * Only pure C is used with minimal dependencies on external libraries.
  */
 
+#define LOG_MODULE_ID LOG_MODULE_VECTOR
+
 #include "../include/vector.h"
 #include "../include/logger.h"
 
@@ -182,11 +184,15 @@ float scalar_multiply(float x, float y) {
 
 float scalar_divide(float x, float y) {
     if (y == 0) {
-        LOG(&global_logger,
+        // Element-wise division may hit this once per element
+        LOG_EVERY_MS(
+            &global_logger,
             LOG_LEVEL_ERROR,
+            1000,
             "Division by zero is undefined. Cannot divide x (%f) by y (%f).\n",
             x,
-            y);
+            y
+        );
         return NAN; // Division by zero is undefined
     }
     return x / y;
@@ -23,6 +23,8 @@
  *
  */
 
+#define LOG_MODULE_ID LOG_MODULE_XOR
+
 #include "logger.h"
 
 #include <stdint.h>
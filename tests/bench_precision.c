@@ -0,0 +1,611 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/bench_precision.c
+ *
+ * @brief Conversion benchmark and error analysis for precision.h
+ *
+ * - Exhaustively sweeps every f16, bf16, and f8 encoding: every decode path
+ *   must agree and every finite value must survive a round trip.
+ * - Encodes a large sample of f32 inputs spread over each format's range and
+ *   reports the max and mean error in units of the target format's ulp.
+ *   Round to nearest must stay within 0.5 ulp; stochastic rounding within 1.
+ * - Reports throughput per format and per code path (scalar, array, LUT,
+ *   F16C) in millions of elements per second.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -c source/tables.cpp -o tables.o
+ *   gcc -O2 -march=native -Iinclude -o bench_precision \
+ *       tests/bench_precision.c \
+ *       source/precision.c source/lehmer.c source/logger.c tables.o \
+ *       -lm -lpthread
+ * Run:
+ *   ./bench_precision [samples]
+ *
+ * The process exits with a failure status if any correctness check fails,
+ * so it can gate kernel changes as well as report numbers.
+ */
+
+#include "../include/lehmer.h"
+#include "../include/logger.h"
+#include "../include/precision.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+// Default number of sampled f32 inputs per format
+#define BENCH_SAMPLES (1 << 22)
+
+// Repetitions per throughput measurement; the fastest run is reported
+#define BENCH_RUNS    5
+
+/**
+ * @brief Format descriptions
+ */
+
+typedef struct BenchFormat {
+    const char* name;
+    int         mantissa; // explicit mantissa bits
+    int         bias;     // exponent bias
+    float       max;      // largest finite value
+    size_t      width;    // bytes per element
+    bool        flushes;  // subnormals flush to zero
+    void (*encode)(const float* src, void* dst, size_t n);
+    void (*decode)(const void* src, float* dst, size_t n);
+    void (*encode_stochastic)(
+        const float* src, void* dst, size_t n, lehmer_state_t* state
+    );
+} bench_format_t;
+
+static void f16_encode(const float* src, void* dst, size_t n) {
+    encode_float16_array(src, (float16_t*) dst, n);
+}
+
+static void f16_decode(const void* src, float* dst, size_t n) {
+    decode_float16_array((const float16_t*) src, dst, n);
+}
+
+static void bf16_encode(const float* src, void* dst, size_t n) {
+    encode_bfloat16_array(src, (bfloat16_t*) dst, n);
+}
+
+static void bf16_decode(const void* src, float* dst, size_t n) {
+    decode_bfloat16_array((const bfloat16_t*) src, dst, n);
+}
+
+static void bf16_encode_stochastic(
+    const float* src, void* dst, size_t n, lehmer_state_t* state
+) {
+    encode_bfloat16_stochastic_array(src, (bfloat16_t*) dst, n, state);
+}
+
+static void e4m3_encode(const float* src, void* dst, size_t n) {
+    encode_float8_e4m3_array(src, (float8_t*) dst, n);
+}
+
+static void e4m3_decode(const void* src, float* dst, size_t n) {
+    decode_float8_e4m3_array((const float8_t*) src, dst, n);
+}
+
+static void e4m3_encode_stochastic(
+    const float* src, void* dst, size_t n, lehmer_state_t* state
+) {
+    encode_float8_e4m3_stochastic_array(src, (float8_t*) dst, n, state);
+}
+
+static void e5m2_encode(const float* src, void* dst, size_t n) {
+    encode_float8_e5m2_array(src, (float8_t*) dst, n);
+}
+
+static void e5m2_decode(const void* src, float* dst, size_t n) {
+    decode_float8_e5m2_array((const float8_t*) src, dst, n);
+}
+
+static void e5m2_encode_stochastic(
+    const float* src, void* dst, size_t n, lehmer_state_t* state
+) {
+    encode_float8_e5m2_stochastic_array(src, (float8_t*) dst, n, state);
+}
+
+static const bench_format_t BENCH_FORMATS[] = {
+    {"f16", 10, 15, 65504.0f, 2, false, f16_encode, f16_decode, NULL},
+    {"bf16",
+     7,
+     127,
+     3.3895314e38f,
+     2,
+     true,
+     bf16_encode,
+     bf16_decode,
+     bf16_encode_stochastic},
+    {"f8_e4m3",
+     3,
+     7,
+     448.0f,
+     1,
+     false,
+     e4m3_encode,
+     e4m3_decode,
+     e4m3_encode_stochastic},
+    {"f8_e5m2",
+     2,
+     15,
+     57344.0f,
+     1,
+     false,
+     e5m2_encode,
+     e5m2_decode,
+     e5m2_encode_stochastic},
+};
+
+#define BENCH_FORMAT_COUNT (sizeof(BENCH_FORMATS) / sizeof(BENCH_FORMATS[0]))
+
+/**
+ * @brief Helpers
+ */
+
+static double bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+static bool bench_bits_equal(float a, float b) {
+    return encode_float32(a) == encode_float32(b);
+}
+
+// Size of one ulp of the target format at magnitude |x|
+static double bench_ulp(const bench_format_t* format, double x) {
+    int exponent;
+    frexp(fabs(x), &exponent); // |x| = f * 2^exponent with f in [0.5, 1)
+    exponent -= 1;             // |x| = f * 2^exponent with f in [1, 2)
+
+    int min_exponent = 1 - format->bias;
+    if (exponent < min_exponent) {
+        exponent = min_exponent; // subnormals share the smallest step
+    }
+    return ldexp(1.0, exponent - format->mantissa);
+}
+
+// A random f32 spread log-uniformly over the format's finite range
+static float bench_sample(const bench_format_t* format, lehmer_state_t* state) {
+    // Start just below the smallest subnormal, or at the smallest normal
+    const int min_exponent = format->flushes
+                                 ? 2 - format->bias
+                                 : 1 - format->bias - format->mantissa;
+    int       max_exponent;
+    frexpf(format->max, &max_exponent);
+
+    uint32_t random   = (uint32_t) (lehmer_generate(state) * 4294967296.0);
+    uint32_t mantissa = random & UINT32_C(0x7FFFFF);
+    uint32_t sign     = random & UINT32_C(0x80000000);
+    int      span     = max_exponent - min_exponent;
+    int exponent = min_exponent + (int) (lehmer_generate(state) * span);
+
+    float value = ldexpf(1.0f + ldexpf((float) mantissa, -23), exponent - 1);
+    value       = value > format->max ? format->max : value;
+    return sign ? -value : value;
+}
+
+/**
+ * @brief Exhaustive sweeps
+ */
+
+// Decode every f16 value through every path; finite values must round trip
+static bool bench_sweep_float16(void) {
+    const size_t n        = 65536;
+    float16_t*   src      = (float16_t*) malloc(n * sizeof(float16_t));
+    float16_t*   encoded  = (float16_t*) malloc(n * sizeof(float16_t));
+    float*       expected = (float*) malloc(n * sizeof(float));
+    float*       values   = (float*) malloc(n * sizeof(float));
+
+    const precision_decode_path_t paths[]  = {
+        PRECISION_DECODE_ARITHMETIC,
+        PRECISION_DECODE_LUT,
+        PRECISION_DECODE_F16C,
+    };
+    const char*                   labels[] = {"arithmetic", "lut", "f16c"};
+
+    for (size_t i = 0; i < n; i++) {
+        src[i]      = (float16_t) i;
+        expected[i] = decode_float16(src[i]);
+    }
+
+    size_t mismatches[3] = {0};
+    for (size_t p = 0; p < 3; p++) {
+        decode_float16_array_path(src, values, n, paths[p]);
+        for (size_t i = 0; i < n; i++) {
+            bool same = isnan(expected[i]) ? isnan(values[i])
+                                           : bench_bits_equal(values[i], expected[i]);
+            mismatches[p] += same ? 0 : 1;
+        }
+    }
+
+    size_t scalar_failures = 0, array_failures = 0, finite = 0;
+    encode_float16_array(expected, encoded, n);
+    for (size_t i = 0; i < n; i++) {
+        if (isnan(expected[i])) {
+            continue;
+        }
+        finite++;
+        scalar_failures += encode_float16(expected[i]) == src[i] ? 0 : 1;
+        array_failures  += encoded[i] == src[i] ? 0 : 1;
+    }
+
+    printf("f16 sweep: %zu encodings, %zu non-NaN\n", n, finite);
+    for (size_t p = 0; p < 3; p++) {
+        printf("  decode %-10s mismatches: %zu\n", labels[p], mismatches[p]);
+    }
+    printf("  round trip failures: scalar %zu, array %zu\n",
+           scalar_failures,
+           array_failures);
+
+    free(src);
+    free(encoded);
+    free(expected);
+    free(values);
+
+    return 0 == mismatches[0] + mismatches[1] + mismatches[2] + scalar_failures
+                    + array_failures;
+}
+
+// bf16 flushes subnormals, so those are counted separately from failures
+static bool bench_sweep_bfloat16(void) {
+    const size_t n        = 65536;
+    bfloat16_t*  src      = (bfloat16_t*) malloc(n * sizeof(bfloat16_t));
+    bfloat16_t*  encoded  = (bfloat16_t*) malloc(n * sizeof(bfloat16_t));
+    float*       values   = (float*) malloc(n * sizeof(float));
+
+    for (size_t i = 0; i < n; i++) {
+        src[i] = (bfloat16_t) i;
+    }
+
+    size_t mismatches = 0;
+    decode_bfloat16_array(src, values, n);
+    for (size_t i = 0; i < n; i++) {
+        float expected = decode_bfloat16(src[i]);
+        bool  same     = isnan(expected) ? isnan(values[i])
+                                         : bench_bits_equal(values[i], expected);
+        mismatches += same ? 0 : 1;
+    }
+
+    size_t failures = 0, flushed = 0;
+    encode_bfloat16_array(values, encoded, n);
+    for (size_t i = 0; i < n; i++) {
+        if (isnan(values[i])) {
+            continue;
+        }
+        if (0 == (src[i] & 0x7F80) && 0 != (src[i] & 0x007F)) {
+            flushed++;
+            continue;
+        }
+        failures += encoded[i] == src[i] ? 0 : 1;
+    }
+
+    printf("bf16 sweep: %zu encodings\n", n);
+    printf("  decode array mismatches: %zu\n", mismatches);
+    printf("  round trip failures: %zu (subnormals flushed: %zu)\n",
+           failures,
+           flushed);
+
+    free(src);
+    free(encoded);
+    free(values);
+
+    return 0 == mismatches + failures;
+}
+
+// Every finite 8-bit value must round trip through the scalar and array paths
+static bool bench_sweep_float8(const bench_format_t* format) {
+    uint8_t src[256], encoded[256];
+    float   values[256];
+
+    for (size_t i = 0; i < 256; i++) {
+        src[i] = (uint8_t) i;
+    }
+
+    format->decode(src, values, 256);
+    format->encode(values, encoded, 256);
+
+    size_t failures = 0, finite = 0;
+    for (size_t i = 0; i < 256; i++) {
+        if (!isfinite(values[i])) {
+            continue;
+        }
+        finite++;
+        failures += encoded[i] == src[i] ? 0 : 1;
+    }
+
+    printf("%s sweep: 256 encodings, %zu finite\n", format->name, finite);
+    printf("  round trip failures: %zu\n", failures);
+    return 0 == failures;
+}
+
+/**
+ * @brief Sampled error analysis
+ */
+
+typedef struct BenchError {
+    double max_ulp;
+    double mean_ulp;
+    double mean_signed_ulp; // bias; ~0 for unbiased rounding
+} bench_error_t;
+
+static bench_error_t bench_measure_error(
+    const bench_format_t* format, const float* src, const float* values, size_t n
+) {
+    bench_error_t error = {0.0, 0.0, 0.0};
+
+    for (size_t i = 0; i < n; i++) {
+        double ulp                = bench_ulp(format, src[i]);
+        double difference         = ((double) values[i] - src[i]) / ulp;
+        double magnitude          = fabs(difference);
+        error.max_ulp             = fmax(error.max_ulp, magnitude);
+        error.mean_ulp           += magnitude;
+        error.mean_signed_ulp    += difference;
+    }
+
+    error.mean_ulp        /= (double) n;
+    error.mean_signed_ulp /= (double) n;
+    return error;
+}
+
+static bool bench_sample_errors(
+    const bench_format_t* format, size_t n, lehmer_state_t* state
+) {
+    float* src     = (float*) malloc(n * sizeof(float));
+    float* values  = (float*) malloc(n * sizeof(float));
+    void*  encoded = malloc(n * format->width);
+
+    for (size_t i = 0; i < n; i++) {
+        src[i] = bench_sample(format, state);
+    }
+
+    format->encode(src, encoded, n);
+    format->decode(encoded, values, n);
+    bench_error_t nearest = bench_measure_error(format, src, values, n);
+
+    printf("%s error over %zu samples:\n", format->name, n);
+    printf("  nearest:    max %.4f ulp, mean %.4f ulp, bias %+.5f ulp\n",
+           nearest.max_ulp,
+           nearest.mean_ulp,
+           nearest.mean_signed_ulp);
+
+    bool result = nearest.max_ulp <= 0.5;
+
+    if (NULL != format->encode_stochastic) {
+        format->encode_stochastic(src, encoded, n, state);
+        format->decode(encoded, values, n);
+        bench_error_t stochastic = bench_measure_error(format, src, values, n);
+        printf("  stochastic: max %.4f ulp, mean %.4f ulp, bias %+.5f ulp\n",
+               stochastic.max_ulp,
+               stochastic.mean_ulp,
+               stochastic.mean_signed_ulp);
+        result &= stochastic.max_ulp < 1.0;
+    }
+
+    free(src);
+    free(values);
+    free(encoded);
+    return result;
+}
+
+/**
+ * @brief Throughput
+ */
+
+typedef void (*bench_kernel_t)(const void* src, void* dst, size_t n);
+
+static double bench_throughput(
+    bench_kernel_t kernel, const void* src, void* dst, size_t n
+) {
+    double best = INFINITY;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        double start = bench_now();
+        kernel(src, dst, n);
+        double elapsed = bench_now() - start;
+        best           = elapsed < best ? elapsed : best;
+    }
+    return (double) n / best * 1e-6; // millions of elements per second
+}
+
+static void f16_scalar_encode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float16_t*) dst)[i] = encode_float16(((const float*) src)[i]);
+    }
+}
+
+static void f16_scalar_decode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float*) dst)[i] = decode_float16(((const float16_t*) src)[i]);
+    }
+}
+
+static void f16_array_encode(const void* src, void* dst, size_t n) {
+    encode_float16_array((const float*) src, (float16_t*) dst, n);
+}
+
+static void f16_arithmetic_decode(const void* src, void* dst, size_t n) {
+    decode_float16_array_path(
+        (const float16_t*) src, (float*) dst, n, PRECISION_DECODE_ARITHMETIC
+    );
+}
+
+static void f16_lut_decode(const void* src, void* dst, size_t n) {
+    decode_float16_array_path(
+        (const float16_t*) src, (float*) dst, n, PRECISION_DECODE_LUT
+    );
+}
+
+static void f16_f16c_decode(const void* src, void* dst, size_t n) {
+    decode_float16_array_path(
+        (const float16_t*) src, (float*) dst, n, PRECISION_DECODE_F16C
+    );
+}
+
+static void bf16_scalar_encode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((bfloat16_t*) dst)[i] = encode_bfloat16(((const float*) src)[i]);
+    }
+}
+
+static void bf16_scalar_decode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float*) dst)[i] = decode_bfloat16(((const bfloat16_t*) src)[i]);
+    }
+}
+
+static void bf16_array_encode(const void* src, void* dst, size_t n) {
+    encode_bfloat16_array((const float*) src, (bfloat16_t*) dst, n);
+}
+
+static void bf16_array_decode(const void* src, void* dst, size_t n) {
+    decode_bfloat16_array((const bfloat16_t*) src, (float*) dst, n);
+}
+
+static void e4m3_scalar_encode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float8_t*) dst)[i] = encode_float8_e4m3(((const float*) src)[i]);
+    }
+}
+
+static void e4m3_scalar_decode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float*) dst)[i] = decode_float8_e4m3(((const float8_t*) src)[i]);
+    }
+}
+
+static void e4m3_array_encode(const void* src, void* dst, size_t n) {
+    encode_float8_e4m3_array((const float*) src, (float8_t*) dst, n);
+}
+
+static void e4m3_array_decode(const void* src, void* dst, size_t n) {
+    decode_float8_e4m3_array((const float8_t*) src, (float*) dst, n);
+}
+
+static void e5m2_scalar_encode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float8_t*) dst)[i] = encode_float8_e5m2(((const float*) src)[i]);
+    }
+}
+
+static void e5m2_scalar_decode(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((float*) dst)[i] = decode_float8_e5m2(((const float8_t*) src)[i]);
+    }
+}
+
+static void e5m2_array_encode(const void* src, void* dst, size_t n) {
+    encode_float8_e5m2_array((const float*) src, (float8_t*) dst, n);
+}
+
+static void e5m2_array_decode(const void* src, void* dst, size_t n) {
+    decode_float8_e5m2_array((const float8_t*) src, (float*) dst, n);
+}
+
+typedef struct BenchPath {
+    const char*    format;
+    const char*    path;
+    bench_kernel_t encode; // NULL if the path only decodes
+    bench_kernel_t decode;
+} bench_path_t;
+
+static const bench_path_t BENCH_PATHS[] = {
+    {"f16", "scalar", f16_scalar_encode, f16_scalar_decode},
+    {"f16", "array", f16_array_encode, f16_arithmetic_decode},
+    {"f16", "lut", NULL, f16_lut_decode},
+    {"f16", "f16c", NULL, f16_f16c_decode},
+    {"bf16", "scalar", bf16_scalar_encode, bf16_scalar_decode},
+    {"bf16", "array", bf16_array_encode, bf16_array_decode},
+    {"f8_e4m3", "scalar", e4m3_scalar_encode, e4m3_scalar_decode},
+    {"f8_e4m3", "array", e4m3_array_encode, e4m3_array_decode},
+    {"f8_e5m2", "scalar", e5m2_scalar_encode, e5m2_scalar_decode},
+    {"f8_e5m2", "array", e5m2_array_encode, e5m2_array_decode},
+};
+
+static void bench_report_throughput(size_t n, lehmer_state_t* state) {
+    float* src     = (float*) malloc(n * sizeof(float));
+    float* values  = (float*) malloc(n * sizeof(float));
+    void*  encoded = malloc(n * sizeof(float16_t));
+
+    // Values in [-1, 1) are representable by every format
+    for (size_t i = 0; i < n; i++) {
+        src[i] = (float) (lehmer_generate(state) * 2.0 - 1.0);
+    }
+
+    printf("throughput over %zu elements (Melem/s):\n", n);
+    printf("  %-8s %-8s %12s %12s\n", "format", "path", "encode", "decode");
+
+    for (size_t p = 0; p < sizeof(BENCH_PATHS) / sizeof(BENCH_PATHS[0]); p++) {
+        const bench_path_t* path = &BENCH_PATHS[p];
+
+        // Encode first so the decode input holds realistic bit patterns
+        double encode = 0.0;
+        if (NULL != path->encode) {
+            encode = bench_throughput(path->encode, src, encoded, n);
+        } else {
+            encode_float16_array(src, (float16_t*) encoded, n);
+        }
+        double decode = bench_throughput(path->decode, encoded, values, n);
+
+        if (NULL != path->encode) {
+            printf("  %-8s %-8s %12.1f %12.1f\n",
+                   path->format,
+                   path->path,
+                   encode,
+                   decode);
+        } else {
+            printf("  %-8s %-8s %12s %12.1f\n",
+                   path->format,
+                   path->path,
+                   "-",
+                   decode);
+        }
+    }
+
+    free(src);
+    free(values);
+    free(encoded);
+}
+
+int main(int argc, char* argv[]) {
+    initialize_global_logger(
+        LOG_LEVEL_INFO, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    size_t samples = BENCH_SAMPLES;
+    if (argc > 1) {
+        samples = (size_t) strtoull(argv[1], NULL, 10);
+        samples = samples > 0 ? samples : BENCH_SAMPLES;
+    }
+
+    lehmer_state_t* state = lehmer_create_state(STREAMS);
+    lehmer_seed_streams(state, DEFAULT);
+
+    bool result = true;
+
+    result &= bench_sweep_float16();
+    result &= bench_sweep_bfloat16();
+    result &= bench_sweep_float8(&BENCH_FORMATS[2]);
+    result &= bench_sweep_float8(&BENCH_FORMATS[3]);
+    printf("\n");
+
+    for (size_t f = 0; f < BENCH_FORMAT_COUNT; f++) {
+        result &= bench_sample_errors(&BENCH_FORMATS[f], samples, state);
+    }
+    printf("\n");
+
+    bench_report_throughput(samples, state);
+    printf("\n");
+
+    lehmer_free_state(state);
+
+    if (result) {
+        printf("All checks passed.\n");
+    } else {
+        printf("Checks failed. Please review the report above.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
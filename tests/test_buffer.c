@@ -0,0 +1,237 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_buffer.c
+ *
+ * Build:
+ *   g++ -std=c++17 -c source/tables.cpp -o tables.o
+ *   gcc -Iinclude -o test_buffer tests/test_buffer.c source/buffer.c \
+ *       source/vector.c source/matrix.c source/precision.c source/lehmer.c \
+ *       source/logger.c tables.o -lm -lpthread
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible. The
+ * simpler, the better.
+ */
+
+#include "../include/buffer.h"
+#include "../include/logger.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/** Prototypes */
+
+bool test_buffer_create(void);
+bool test_buffer_round_trip(data_type_t type, float tolerance);
+bool test_buffer_dot_float(data_type_t type, float tolerance);
+bool test_buffer_quant_range(data_type_t type, float levels);
+bool test_vector_buffer(void);
+
+/** Fixtures */
+
+// Deterministic values in [-2, 2) with a few exact zeros
+static void buffer_values_fixture(float* values, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        values[i] = (i % 7 == 0) ? 0.0f : sinf((float) i * 0.37f) * 2.0f;
+    }
+}
+
+/** Unit Tests */
+
+bool test_buffer_create(void) {
+    bool result = true;
+
+    const size_t count = 100; // not a multiple of BUFFER_BLOCK_SIZE
+    for (int type = TYPE_FLOAT_F32; type < TYPE_MAX_COUNT; type++) {
+        buffer_t* buffer = buffer_create((data_type_t) type, count);
+        if (NULL == buffer) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "Failed to create %s buffer.\n",
+                buffer_type_name((data_type_t) type));
+            result = false;
+            continue;
+        }
+
+        result &= buffer->count == count;
+        result &= buffer->size == buffer_type_size((data_type_t) type, count);
+        result &= 0 == (uintptr_t) buffer->data % BUFFER_ALIGNMENT;
+        buffer_free(buffer);
+    }
+
+    // Storage is exactly the width of the format
+    result &= buffer_type_size(TYPE_FLOAT_F16, 64) == 128;
+    result &= buffer_type_size(TYPE_FLOAT_F8, 64) == 64;
+    result &= buffer_type_size(TYPE_QUANT_K8, 64) == 2 * sizeof(block_q8_t);
+    result &= buffer_type_size(TYPE_QUANT_K4, 64) == 2 * sizeof(block_q4_t);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_buffer_round_trip(data_type_t type, float tolerance) {
+    const size_t count = 100;
+    float        values[100];
+    float        decoded[100];
+
+    buffer_values_fixture(values, count);
+
+    buffer_t* buffer = buffer_create(type, count);
+    bool      result = NULL != buffer;
+    result = result && buffer_from_float(buffer, values)
+             && buffer_to_float(buffer, decoded);
+
+    for (size_t i = 0; result && i < count; i++) {
+        if (fabsf(decoded[i] - values[i]) > tolerance) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "%s: element %zu decoded to %f, expected %f\n",
+                buffer_type_name(type),
+                i,
+                (double) decoded[i],
+                (double) values[i]);
+            result = false;
+        }
+    }
+
+    buffer_free(buffer);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Blocks far below and above the half range of the scale keep their signs
+// and stay finite; out of range blocks saturate at levels * 65504
+bool test_buffer_quant_range(data_type_t type, float levels) {
+    const size_t count        = 100;
+    const float  magnitudes[] = {1e-9f, 1e-5f, 1e7f, 1e9f};
+    float        values[100];
+    float        decoded[100];
+    bool         result = true;
+
+    for (size_t m = 0; m < sizeof(magnitudes) / sizeof(*magnitudes); m++) {
+        buffer_values_fixture(values, count);
+        for (size_t i = 0; i < count; i++) {
+            values[i] *= magnitudes[m] / 2.0f;
+        }
+
+        // One step of the largest finite or smallest subnormal scale
+        float limit = levels * 65504.0f;
+        float step  = magnitudes[m] / levels + 5.97e-8f;
+        step        = step < 65504.0f ? step : 65504.0f;
+
+        buffer_t* buffer = buffer_create(type, count);
+        bool      ok     = NULL != buffer && buffer_from_float(buffer, values)
+                           && buffer_to_float(buffer, decoded);
+
+        for (size_t i = 0; ok && i < count; i++) {
+            float clamped = fminf(fmaxf(values[i], -limit), limit);
+            if (!isfinite(decoded[i]) || decoded[i] * values[i] < 0.0f
+                || fabsf(decoded[i] - clamped) > step) {
+                LOG(&global_logger,
+                    LOG_LEVEL_ERROR,
+                    "%s: element %zu decoded to %g, expected %g\n",
+                    buffer_type_name(type),
+                    i,
+                    (double) decoded[i],
+                    (double) clamped);
+                ok = false;
+            }
+        }
+
+        buffer_free(buffer);
+        result &= ok;
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_buffer_dot_float(data_type_t type, float tolerance) {
+    const size_t count = 300; // spans several decode chunks
+    float        values[300];
+    float        weights[300];
+    float        decoded[300];
+
+    buffer_values_fixture(values, count);
+    for (size_t i = 0; i < count; i++) {
+        weights[i] = cosf((float) i * 0.11f);
+    }
+
+    buffer_t* buffer = buffer_create(type, count);
+    bool      result = NULL != buffer && buffer_from_float(buffer, values)
+                       && buffer_to_float(buffer, decoded);
+
+    if (result) {
+        // The kernel must agree with decoding first and reducing afterwards
+        float expected = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            expected += decoded[i] * weights[i];
+        }
+        result = fabsf(buffer_dot_float(buffer, weights) - expected)
+                 <= tolerance;
+    }
+
+    buffer_free(buffer);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_buffer(void) {
+    vector_t* vector = vector_create(3);
+    vector->elements[0] = 1.0f;
+    vector->elements[1] = -0.5f;
+    vector->elements[2] = 0.25f;
+
+    buffer_t* buffer = vector_to_buffer(vector, TYPE_FLOAT_BF16);
+    vector_t* copy   = NULL != buffer ? vector_from_buffer(buffer) : NULL;
+
+    bool result = NULL != copy && copy->dimensions == vector->dimensions;
+    for (size_t i = 0; result && i < vector->dimensions; i++) {
+        result &= copy->elements[i] == vector->elements[i];
+    }
+
+    vector_free(vector);
+    vector_free(copy);
+    buffer_free(buffer);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    result &= test_buffer_create();
+
+    // Tolerances are one quantization step of each format at |x| <= 2
+    result &= test_buffer_round_trip(TYPE_FLOAT_F32, 0.0f);
+    result &= test_buffer_round_trip(TYPE_FLOAT_F16, 1e-3f);
+    result &= test_buffer_round_trip(TYPE_FLOAT_BF16, 8e-3f);
+    result &= test_buffer_round_trip(TYPE_FLOAT_F8, 0.125f);
+    result &= test_buffer_round_trip(TYPE_FLOAT_F8_E5M2, 0.25f);
+    result &= test_buffer_round_trip(TYPE_QUANT_K8, 2.0f / 127.0f);
+    result &= test_buffer_round_trip(TYPE_QUANT_K4, 2.0f / 7.0f);
+    result &= test_buffer_quant_range(TYPE_QUANT_K8, 127.0f);
+    result &= test_buffer_quant_range(TYPE_QUANT_K4, 7.0f);
+
+    for (int type = TYPE_FLOAT_F32; type < TYPE_MAX_COUNT; type++) {
+        result &= test_buffer_dot_float((data_type_t) type, 1e-3f);
+    }
+
+    result &= test_vector_buffer();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,495 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_fixed.c
+ *
+ * Build:
+ *   gcc -O2 -march=native -o test_fixed tests/test_fixed.c source/fixed.c \
+ *       source/logger.c -lm -lpthread
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible. The
+ * simpler, the better.
+ */
+
+#include "../include/fixed.h"
+#include "../include/logger.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** Prototypes */
+
+bool test_fixed_saturation(void);
+bool test_fixed_rounding(void);
+bool test_fixed_mul(void);
+bool test_fixed_div(void);
+bool test_fixed_arrays(void);
+bool test_fixed_dot(void);
+bool test_fixed_requantize(void);
+bool test_fixed_gemm(size_t m, size_t n, size_t k);
+bool test_fixed_gemm_end_to_end(size_t m, size_t n, size_t k);
+
+/** Fixtures */
+
+#define FIXTURE_SIZE 67 // not a multiple of the vector width
+
+// Values covering signs, tiny fractions and both saturation bounds
+static void fixed_values_fixture(fixed16_t* values, size_t n, uint32_t seed) {
+    static const fixed16_t edges[] = {
+        0,
+        1,
+        -1,
+        INT_TO_FIXED(1),
+        -INT_TO_FIXED(1),
+        FIXED_MAX,
+        FIXED_MIN,
+        FIXED_MAX - 1,
+        INT_TO_FIXED(30000),
+        -INT_TO_FIXED(30000),
+    };
+    const size_t count = sizeof(edges) / sizeof(edges[0]);
+
+    for (size_t i = 0; i < n; i++) {
+        seed      = seed * 1664525u + 1013904223u; // numerical recipes LCG
+        values[i] = i < count ? edges[(i + seed % 3) % count]
+                              : (fixed16_t) seed >> (seed % 16);
+    }
+}
+
+// Uniform float in [-1, 1) from the fixture LCG
+static float fixed_uniform_fixture(uint32_t* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return (float) ((double) *seed / 2147483648.0 - 1.0);
+}
+
+// Symmetric 12-bit quantization; returns the scale
+static float fixed_quantize_fixture(
+    const float* src, int16_t* dst, size_t n, size_t stride
+) {
+    float max = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        max = fmaxf(max, fabsf(src[i * stride]));
+    }
+    float scale = max > 0.0f ? max / 2047.0f : 1.0f;
+    for (size_t i = 0; i < n; i++) {
+        dst[i * stride] = (int16_t) lrintf(src[i * stride] / scale);
+    }
+    return scale;
+}
+
+// Float GEMM with the same panel blocking as fixed_gemm_s16
+static void float_gemm_fixture(
+    const float* a, const float* b, float* c, size_t m, size_t n, size_t k
+) {
+    memset(c, 0, m * n * sizeof(float));
+    for (size_t jb = 0; jb < n; jb += FIXED_GEMM_BLOCK_N) {
+        size_t je = jb + FIXED_GEMM_BLOCK_N < n ? jb + FIXED_GEMM_BLOCK_N : n;
+        for (size_t kb = 0; kb < k; kb += FIXED_GEMM_BLOCK_K) {
+            size_t ke = kb + FIXED_GEMM_BLOCK_K < k ? kb + FIXED_GEMM_BLOCK_K
+                                                    : k;
+            for (size_t i = 0; i < m; i++) {
+                for (size_t p = kb; p < ke; p++) {
+                    for (size_t j = jb; j < je; j++) {
+                        c[i * n + j] += a[i * k + p] * b[p * n + j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+static double fixture_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+// Exact a / b in Q16.16 rounded to nearest, for reference
+static int64_t fixed_div_reference(fixed16_t a, fixed16_t b) {
+    return (int64_t) llround(ldexp((double) a / (double) b, FIXED_SIZE));
+}
+
+/** Unit Tests */
+
+bool test_fixed_saturation(void) {
+    bool result = true;
+
+    result &= fixed_add(FIXED_MAX, 1) == FIXED_MAX;
+    result &= fixed_add(FIXED_MIN, -1) == FIXED_MIN;
+    result &= fixed_sub(FIXED_MIN, 1) == FIXED_MIN;
+    result &= fixed_sub(FIXED_MAX, -1) == FIXED_MAX;
+    result &= fixed_sub(0, FIXED_MIN) == FIXED_MAX;
+    result &= fixed_add(INT_TO_FIXED(2), INT_TO_FIXED(3)) == INT_TO_FIXED(5);
+    result &= fixed_saturate(INT64_C(1) << 40) == FIXED_MAX;
+    result &= fixed_saturate(-(INT64_C(1) << 40)) == FIXED_MIN;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_rounding(void) {
+    bool result = true;
+
+    // 2.5 and -2.5 with one fractional bit, then 3.5 and -3.5
+    result &= fixed_round_shift(5, 1, FIXED_ROUND_FLOOR) == 2;
+    result &= fixed_round_shift(-5, 1, FIXED_ROUND_FLOOR) == -3;
+    result &= fixed_round_shift(5, 1, FIXED_ROUND_ZERO) == 2;
+    result &= fixed_round_shift(-5, 1, FIXED_ROUND_ZERO) == -2;
+    result &= fixed_round_shift(5, 1, FIXED_ROUND_NEAREST) == 3;
+    result &= fixed_round_shift(-5, 1, FIXED_ROUND_NEAREST) == -2;
+    result &= fixed_round_shift(5, 1, FIXED_ROUND_NEAREST_EVEN) == 2;
+    result &= fixed_round_shift(-5, 1, FIXED_ROUND_NEAREST_EVEN) == -2;
+    result &= fixed_round_shift(7, 1, FIXED_ROUND_NEAREST_EVEN) == 4;
+    result &= fixed_round_shift(-7, 1, FIXED_ROUND_NEAREST_EVEN) == -4;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_mul(void) {
+    bool result = true;
+
+    const fixed16_t half  = INT_TO_FIXED(1) / 2;
+    const fixed16_t three = INT_TO_FIXED(3);
+
+    result &= fixed_mul(three, half) == INT_TO_FIXED(3) / 2;
+    result &= fixed_mul(-three, half) == -INT_TO_FIXED(3) / 2;
+    result &= fixed_mul(INT_TO_FIXED(200), INT_TO_FIXED(200)) == FIXED_MAX;
+    result &= fixed_mul(-INT_TO_FIXED(200), INT_TO_FIXED(200)) == FIXED_MIN;
+    result &= fixed_mul(FIXED_MIN, FIXED_MIN) == FIXED_MAX;
+
+    // The smallest fraction squared is 2^-32: it rounds to 0 but floors to -1
+    // when negative
+    result &= fixed_mul(1, 1) == 0;
+    result &= fixed_mul_round(-1, 1, FIXED_ROUND_FLOOR) == -1;
+    result &= fixed_mul_round(-1, 1, FIXED_ROUND_ZERO) == 0;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_div(void) {
+    bool      result = true;
+    fixed16_t a[FIXTURE_SIZE], b[FIXTURE_SIZE];
+
+    fixed_values_fixture(a, FIXTURE_SIZE, 1);
+    fixed_values_fixture(b, FIXTURE_SIZE, 2);
+
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        for (size_t j = 0; j < FIXTURE_SIZE; j++) {
+            if (0 == b[j]) {
+                continue;
+            }
+
+            // Correctly rounded, ties away from zero like llround()
+            int64_t expected = fixed_div_reference(a[i], b[j]);
+            int64_t actual   = fixed_div(a[i], b[j]);
+            if (actual != fixed_saturate(expected)) {
+                LOG(&global_logger,
+                    LOG_LEVEL_ERROR,
+                    "%d / %d = %lld, expected %lld\n",
+                    a[i],
+                    b[j],
+                    (long long) actual,
+                    (long long) fixed_saturate(expected));
+                result = false;
+            }
+        }
+    }
+
+    result &= fixed_div(INT_TO_FIXED(1), 0) == FIXED_MAX;
+    result &= fixed_div(-INT_TO_FIXED(1), 0) == FIXED_MIN;
+    result &= fixed_div(0, 0) == 0;
+    result &= fixed_reciprocal(INT_TO_FIXED(4)) == INT_TO_FIXED(1) / 4;
+    result &= fixed_div(INT_TO_FIXED(7), -INT_TO_FIXED(2))
+              == -INT_TO_FIXED(7) / 2;
+
+    // Quotients at and past the range saturate, and those just inside it
+    // still round correctly
+    result &= fixed_div(FIXED_MAX, 1) == FIXED_MAX;
+    result &= fixed_div(FIXED_MIN, 1) == FIXED_MIN;
+    result &= fixed_div(FIXED_MAX, -1) == FIXED_MIN;
+    result &= fixed_div(FIXED_MIN, -1) == FIXED_MAX;
+    result &= fixed_div(INT_TO_FIXED(1), 1) == FIXED_MAX;
+    for (int32_t i = 0; i < 4096; i++) {
+        for (fixed16_t d = 1; d <= 4; d++) {
+            fixed16_t a = FIXED_MAX - i;
+            fixed16_t n = (fixed16_t) ((int64_t) d << 15) - 1;
+            result &= fixed_div(a, d) == FIXED_MAX;
+            result &= fixed_div(-a, d) == FIXED_MIN;
+            result &= fixed_div(n - i, d)
+                      == fixed_saturate(fixed_div_reference(n - i, d));
+            result &= fixed_div(-(n - i), d)
+                      == fixed_saturate(fixed_div_reference(-(n - i), d));
+        }
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_arrays(void) {
+    bool      result = true;
+    fixed16_t a[FIXTURE_SIZE], b[FIXTURE_SIZE], dst[FIXTURE_SIZE];
+
+    fixed_values_fixture(a, FIXTURE_SIZE, 3);
+    fixed_values_fixture(b, FIXTURE_SIZE, 4);
+
+    // The vector kernels must match the scalar definitions exactly
+    fixed_add_array(a, b, dst, FIXTURE_SIZE);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        result &= dst[i] == fixed_add(a[i], b[i]);
+    }
+
+    fixed_sub_array(a, b, dst, FIXTURE_SIZE);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        result &= dst[i] == fixed_sub(a[i], b[i]);
+    }
+
+    fixed_mul_array(a, b, dst, FIXTURE_SIZE);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        result &= dst[i] == fixed_mul(a[i], b[i]);
+    }
+
+    fixed_scale_array(a, b[5], dst, FIXTURE_SIZE);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        result &= dst[i] == fixed_mul(a[i], b[5]);
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_dot(void) {
+    bool      result = true;
+    fixed16_t a[FIXTURE_SIZE], b[FIXTURE_SIZE];
+
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        a[i] = FLOAT_TO_FIXED(sinf((float) i * 0.3f));
+        b[i] = FLOAT_TO_FIXED(cosf((float) i * 0.7f) * 4.0f);
+    }
+
+    double expected = 0.0;
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        expected += (double) a[i] * (double) b[i];
+    }
+    expected = ldexp(expected, -FIXED_SIZE);
+
+    // Products are summed exactly, so only the final rounding is lost
+    result &= fabs(fixed_dot(a, b, FIXTURE_SIZE) - expected) <= 0.5;
+
+    // Saturates instead of wrapping
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        a[i] = b[i] = INT_TO_FIXED(100);
+    }
+    result &= fixed_dot(a, b, FIXTURE_SIZE) == FIXED_MAX;
+
+    // Products near 2^62 overflow a 64-bit running sum, yet the two halves
+    // cancel exactly and leave only the last product
+    const size_t half = (FIXTURE_SIZE - 1) / 2;
+    for (size_t i = 0; i < 2 * half; i++) {
+        a[i] = FIXED_MAX;
+        b[i] = i < half ? FIXED_MAX : -FIXED_MAX;
+    }
+    a[FIXTURE_SIZE - 1]  = INT_TO_FIXED(3);
+    b[FIXTURE_SIZE - 1]  = INT_TO_FIXED(1) / 2;
+    result              &= fixed_dot(a, b, FIXTURE_SIZE) == INT_TO_FIXED(3) / 2;
+
+    // Sums past the int64 range saturate rather than wrap to the wrong sign
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        a[i] = FIXED_MIN;
+        b[i] = FIXED_MIN;
+    }
+    result &= fixed_dot(a, b, 2) == FIXED_MAX;
+    result &= fixed_dot(a, b, FIXTURE_SIZE) == FIXED_MAX;
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        b[i] = FIXED_MAX;
+    }
+    result &= fixed_dot(a, b, 4) == FIXED_MIN;
+    result &= fixed_dot(a, b, FIXTURE_SIZE) == FIXED_MIN;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_requantize(void) {
+    bool result = true;
+
+    fixed_requant_t half  = fixed_requant_create(0.5);
+    fixed_requant_t third = fixed_requant_create(1.0 / 3.0);
+    fixed_requant_t large = fixed_requant_create(1000.0);
+
+    result &= half.multiplier == (INT32_C(1) << 30);
+    result &= fixed_requantize(100, half) == 50;
+    result &= fixed_requantize(-101, half) == -50; // -50.5 ties upward
+    result &= fixed_requantize(300, third) == 100;
+    result &= fixed_requantize(-7, third) == -2;
+    result &= fixed_requantize(100, large) == INT16_MAX;
+    result &= fixed_requantize(-100, large) == -INT16_MAX;
+    result &= fixed_requantize(12345, fixed_requant_create(0.0)) == 0;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_gemm(size_t m, size_t n, size_t k) {
+    bool     result = true;
+    uint32_t seed   = 5;
+    int16_t* a      = (int16_t*) malloc(m * k * sizeof(int16_t));
+    int16_t* b      = (int16_t*) malloc(k * n * sizeof(int16_t));
+    int32_t* c      = (int32_t*) malloc(m * n * sizeof(int32_t));
+
+    for (size_t i = 0; i < m * k; i++) {
+        a[i] = (int16_t) lrintf(fixed_uniform_fixture(&seed) * 2047.0f);
+    }
+    for (size_t i = 0; i < k * n; i++) {
+        b[i] = (int16_t) lrintf(fixed_uniform_fixture(&seed) * 2047.0f);
+    }
+
+    // The packed kernels must match a naive triple loop exactly
+    fixed_gemm_s16(a, b, c, m, n, k);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            int64_t expected = 0;
+            for (size_t p = 0; p < k; p++) {
+                expected += (int64_t) a[i * k + p] * b[p * n + j];
+            }
+            result &= c[i * n + j] == expected;
+        }
+    }
+
+    free(a);
+    free(b);
+    free(c);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_fixed_gemm_end_to_end(size_t m, size_t n, size_t k) {
+    bool     result = true;
+    uint32_t seed   = 9;
+
+    float*   a        = (float*) malloc(m * k * sizeof(float));
+    float*   b        = (float*) malloc(k * n * sizeof(float));
+    float*   expected = (float*) malloc(m * n * sizeof(float));
+    int16_t* qa       = (int16_t*) malloc(m * k * sizeof(int16_t));
+    int16_t* qb       = (int16_t*) malloc(k * n * sizeof(int16_t));
+    int32_t* qc       = (int32_t*) malloc(m * n * sizeof(int32_t));
+    int16_t* qy       = (int16_t*) malloc(m * n * sizeof(int16_t));
+    float*   sb       = (float*) malloc(n * sizeof(float));
+
+    fixed_requant_t* requant
+        = (fixed_requant_t*) malloc(n * sizeof(fixed_requant_t));
+
+    for (size_t i = 0; i < m * k; i++) {
+        a[i] = fixed_uniform_fixture(&seed);
+    }
+    for (size_t i = 0; i < k * n; i++) {
+        // Columns get different ranges so the per-channel scales differ
+        b[i] = fixed_uniform_fixture(&seed) * (float) (1 + i % n % 5);
+    }
+
+    double start = fixture_seconds();
+    float_gemm_fixture(a, b, expected, m, n, k);
+    double float_seconds = fixture_seconds() - start;
+
+    // Per-tensor activations, per-channel weights, per-tensor outputs
+    float sa = fixed_quantize_fixture(a, qa, m * k, 1);
+    for (size_t j = 0; j < n; j++) {
+        sb[j] = fixed_quantize_fixture(b + j, qb + j, k, n);
+    }
+    float sy = 0.0f;
+    for (size_t i = 0; i < m * n; i++) {
+        sy = fmaxf(sy, fabsf(expected[i]));
+    }
+    sy /= INT16_MAX;
+    for (size_t j = 0; j < n; j++) {
+        requant[j] = fixed_requant_create((double) sa * sb[j] / sy);
+    }
+
+    start = fixture_seconds();
+    fixed_gemm_s16(qa, qb, qc, m, n, k);
+    fixed_gemm_requantize(qc, NULL, requant, qy, m, n);
+    double fixed_seconds = fixture_seconds() - start;
+
+    // Each input is within half a step, so the product error is bounded by
+    // sum(|a| db + |b| da + da db) plus half an output step
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double bound = 0.5 * sy;
+            for (size_t p = 0; p < k; p++) {
+                bound += fabs(a[i * k + p]) * sb[j] * 0.5
+                         + fabs(b[p * n + j]) * sa * 0.5 + sa * sb[j] * 0.25;
+            }
+            double actual = qy[i * n + j] * (double) sy;
+            double error  = fabs(actual - expected[i * n + j]);
+            if (error > bound * 1.0001) {
+                LOG(&global_logger,
+                    LOG_LEVEL_ERROR,
+                    "gemm[%zu][%zu]: error %g exceeds bound %g\n",
+                    i,
+                    j,
+                    error,
+                    bound);
+                result = false;
+            }
+        }
+    }
+
+    double operations = 2.0 * (double) m * n * k;
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "gemm %zux%zux%zu: f32 %.2f GOP/s, int16 %.2f GOP/s\n",
+        m,
+        n,
+        k,
+        operations / float_seconds * 1e-9,
+        operations / fixed_seconds * 1e-9);
+
+    free(a);
+    free(b);
+    free(expected);
+    free(qa);
+    free(qb);
+    free(qc);
+    free(qy);
+    free(sb);
+    free(requant);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    result &= test_fixed_saturation();
+    result &= test_fixed_rounding();
+    result &= test_fixed_mul();
+    result &= test_fixed_div();
+    result &= test_fixed_arrays();
+    result &= test_fixed_dot();
+    result &= test_fixed_requantize();
+
+    // Shapes cross panel edges, odd k, and column tails narrower than 8
+    result &= test_fixed_gemm(1, 1, 1);
+    result &= test_fixed_gemm(5, 70, 301);
+    result &= test_fixed_gemm(3, 131, 512);
+    result &= test_fixed_gemm_end_to_end(256, 256, 256);
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,729 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_lehmer.c
+ *
+ * Build:
+ *   g++ -std=c++17 -c source/tables.cpp -o tables.o
+ *   gcc -O2 -march=native -Iinclude -o test_lehmer tests/test_lehmer.c \
+ *       source/lehmer.c source/logger.c tables.o -lm -lpthread
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible. The
+ * simpler, the better.
+ */
+
+#include "../include/lehmer.h"
+#include "../include/logger.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** Prototypes */
+
+bool test_lehmer_step(void);
+bool test_lehmer_check(void);
+bool test_lehmer_generate_batch(void);
+bool test_lehmer_generate_lanes(size_t lanes);
+bool test_lehmer_throughput(void);
+bool test_lehmer_jump(void);
+bool test_lehmer_jump_workers(size_t workers);
+bool test_lehmer_thread_streams(void);
+bool test_lehmer_normal(void);
+bool test_lehmer_uniform(void);
+bool test_lehmer_bounded(uint32_t range);
+
+/** Fixtures */
+
+#define FIXTURE_SIZE 1003 // not a multiple of any lane count
+#define FIXTURE_SEED 42
+
+// Two states seeded identically, one for the reference and one under test
+static void lehmer_pair_fixture(
+    lehmer_state_t** reference, lehmer_state_t** actual, size_t size
+) {
+    *reference = lehmer_create_state(size);
+    *actual    = lehmer_create_state(size);
+    lehmer_seed_streams(*reference, FIXTURE_SEED);
+    lehmer_seed_streams(*actual, FIXTURE_SEED);
+    lehmer_select_stream(*reference, 3);
+    lehmer_select_stream(*actual, 3);
+}
+
+static bool lehmer_seeds_match(
+    const lehmer_state_t* reference, const lehmer_state_t* actual
+) {
+    return 0
+           == memcmp(
+               reference->seed, actual->seed, sizeof(uint64_t) * actual->size
+           );
+}
+
+static double fixture_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+#define FIXTURE_THREADS 4
+
+typedef struct LehmerWorker {
+    lehmer_state_t* state;
+    size_t          stream;
+    double          values[FIXTURE_SIZE];
+    bool            bound;
+} lehmer_worker_t;
+
+// Half the draws through the thread binding, half through a handle
+static void* lehmer_worker_fixture(void* argument) {
+    lehmer_worker_t* worker = (lehmer_worker_t*) argument;
+    const size_t     half   = FIXTURE_SIZE / 2;
+
+    worker->bound = lehmer_thread_bind(worker->state, worker->stream)
+                    && !lehmer_thread_bind(worker->state, worker->stream);
+    for (size_t i = 0; i < half; i++) {
+        worker->values[i] = lehmer_thread_generate();
+    }
+    lehmer_thread_unbind();
+
+    lehmer_stream_t handle;
+    lehmer_stream_checkout(worker->state, &handle, worker->stream);
+    lehmer_stream_generate_batch(
+        &handle, worker->values + half, FIXTURE_SIZE - half
+    );
+    lehmer_stream_commit(worker->state, &handle);
+
+    return NULL;
+}
+
+#define FIXTURE_SAMPLES 200003
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/** Unit Tests */
+
+// The division-free step against the plain remainder
+bool test_lehmer_step(void) {
+    static const uint64_t edges[] = {
+        1, 2, MULTIPLIER, MODULUS - 2, MODULUS - 1
+    };
+    bool     result = true;
+    uint32_t state  = FIXTURE_SEED;
+
+    for (size_t i = 0; i < FIXTURE_SAMPLES; i++) {
+        state = state * 1664525u + 1013904223u; // numerical recipes LCG
+
+        uint64_t seed = i < 5 ? edges[i] : 1 + state % (MODULUS - 1);
+        uint64_t a    = 1 + (state >> 1) % (MODULUS - 1); // product < 2^62
+        if (lehmer_step(seed) != (seed * MULTIPLIER) % MODULUS
+            || lehmer_reduce(seed * a) != (seed * a) % MODULUS) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "step: seed %lu, multiplier %lu\n",
+                (unsigned long) seed,
+                (unsigned long) a);
+            result = false;
+            break;
+        }
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Park and Miller: 10,000 steps from seed 1 land on CHECK
+bool test_lehmer_check(void) {
+    const size_t    steps  = 10000;
+    const size_t    rows   = steps / 10; // lanes advance one step per row
+    bool            result = true;
+    lehmer_state_t* state  = lehmer_create_state(LEHMER_MAX_LANES);
+    double*         values = (double*) malloc(sizeof(double) * steps * 2);
+    uint64_t        seed   = 1;
+
+    for (size_t i = 0; i < steps; i++) {
+        seed = lehmer_step(seed);
+    }
+    result &= CHECK == seed;
+
+    lehmer_set_seed(state, 1);
+    for (size_t i = 0; i < steps; i++) {
+        lehmer_generate(state);
+    }
+    result &= CHECK == lehmer_get_seed(state);
+
+    // The leapfrogged batch and every vector lane take the same path
+    lehmer_set_seed(state, 1);
+    lehmer_generate_batch(state, values, steps);
+    result &= CHECK == lehmer_get_seed(state);
+
+    for (size_t j = 0; j < LEHMER_MAX_LANES; j++) {
+        state->seed[j] = 1;
+    }
+    for (size_t i = 0; i < steps / rows; i++) {
+        lehmer_generate_lanes(
+            state, values, rows * LEHMER_MAX_LANES, LEHMER_MAX_LANES
+        );
+    }
+    for (size_t j = 0; j < LEHMER_MAX_LANES; j++) {
+        result &= CHECK == state->seed[j];
+    }
+
+    if (!result) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "check: expected %d after %zu steps, got %lu\n",
+            CHECK,
+            steps,
+            (unsigned long) seed);
+    }
+
+    free(values);
+    lehmer_free_state(state);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lehmer_generate_batch(void) {
+    bool            result = true;
+    lehmer_state_t* reference;
+    lehmer_state_t* actual;
+    double          values[FIXTURE_SIZE];
+    float           floats[FIXTURE_SIZE];
+
+    lehmer_pair_fixture(&reference, &actual, STREAMS);
+
+    lehmer_generate_batch(actual, values, FIXTURE_SIZE);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        double expected = lehmer_generate(reference);
+        if (expected != values[i] || values[i] <= 0.0 || values[i] >= 1.0) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "batch[%zu]: expected %.17g, got %.17g\n",
+                i,
+                expected,
+                values[i]);
+            result = false;
+            break;
+        }
+    }
+
+    lehmer_generate_batch_float(actual, floats, FIXTURE_SIZE);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        float expected = lehmer_generate_float(reference);
+        if (expected != floats[i] || floats[i] < 0.0f || floats[i] >= 1.0f) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "batch float[%zu]: expected %.9g, got %.9g\n",
+                i,
+                (double) expected,
+                (double) floats[i]);
+            result = false;
+            break;
+        }
+    }
+
+    if (!lehmer_seeds_match(reference, actual)) {
+        LOG(&global_logger, LOG_LEVEL_ERROR, "batch: seeds diverged\n");
+        result = false;
+    }
+
+    lehmer_free_state(reference);
+    lehmer_free_state(actual);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// out[i] must equal the next draw of stream (3 + i % lanes) % size
+bool test_lehmer_generate_lanes(size_t lanes) {
+    bool            result = true;
+    lehmer_state_t* reference;
+    lehmer_state_t* actual;
+    double          values[FIXTURE_SIZE];
+    float           floats[FIXTURE_SIZE];
+    const size_t    size = 12; // fewer streams than 16 lanes clamps to 12
+
+    lehmer_pair_fixture(&reference, &actual, size);
+
+    const size_t width = lanes < size ? lanes : size;
+
+    lehmer_generate_lanes(actual, values, FIXTURE_SIZE, lanes);
+    lehmer_generate_lanes_float(actual, floats, FIXTURE_SIZE, lanes);
+
+    for (size_t pass = 0; pass < 2 && result; pass++) {
+        for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+            lehmer_select_stream(reference, 3 + i % width);
+
+            double expected = pass ? lehmer_generate_float(reference)
+                                   : lehmer_generate(reference);
+            double value    = pass ? floats[i] : values[i];
+            if (expected != value) {
+                LOG(&global_logger,
+                    LOG_LEVEL_ERROR,
+                    "lanes %zu (%s)[%zu]: expected %.17g, got %.17g\n",
+                    lanes,
+                    pass ? "float" : "double",
+                    i,
+                    expected,
+                    value);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    if (result && !lehmer_seeds_match(reference, actual)) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "lanes %zu: seeds diverged\n",
+            lanes);
+        result = false;
+    }
+
+    lehmer_free_state(reference);
+    lehmer_free_state(actual);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lehmer_throughput(void) {
+    const size_t    n      = 1 << 22;
+    lehmer_state_t* state  = lehmer_create_state(STREAMS);
+    float*          values = (float*) malloc(sizeof(float) * n);
+    double          sum    = 0.0;
+
+    lehmer_seed_streams(state, FIXTURE_SEED);
+
+    double start = fixture_seconds();
+    for (size_t i = 0; i < n; i++) {
+        values[i] = lehmer_generate_float(state);
+    }
+    double scalar_seconds = fixture_seconds() - start;
+    sum                  += values[n - 1];
+
+    start = fixture_seconds();
+    lehmer_generate_batch_float(state, values, n);
+    double batch_seconds  = fixture_seconds() - start;
+    sum                  += values[n - 1];
+
+    start = fixture_seconds();
+    lehmer_generate_lanes_float(state, values, n, LEHMER_MAX_LANES);
+    double lanes_seconds  = fixture_seconds() - start;
+    sum                  += values[n - 1];
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "lehmer float: scalar %.1f, batch %.1f, %d lanes %.1f M/s (%g)\n",
+        n / scalar_seconds * 1e-6,
+        n / batch_seconds * 1e-6,
+        LEHMER_MAX_LANES,
+        n / lanes_seconds * 1e-6,
+        sum);
+
+    // Normals: Box-Muller on lehmer_generate against the ziggurat
+    start = fixture_seconds();
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        double radius = sqrt(-2.0 * log(lehmer_generate(state)));
+        double angle  = 2.0 * M_PI * lehmer_generate(state);
+        values[i]     = (float) (radius * cos(angle));
+        values[i + 1] = (float) (radius * sin(angle));
+    }
+    double box_muller_seconds  = fixture_seconds() - start;
+    sum                       += values[n - 2];
+
+    start = fixture_seconds();
+    lehmer_normal_batch(state, values, n, 0.0f, 1.0f);
+    double ziggurat_seconds  = fixture_seconds() - start;
+    sum                     += values[n - 1];
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "lehmer normal: box-muller %.1f, ziggurat %.1f M/s (%g)\n",
+        n / box_muller_seconds * 1e-6,
+        n / ziggurat_seconds * 1e-6,
+        sum);
+
+    free(values);
+    lehmer_free_state(state);
+
+    printf(".");
+    return true;
+}
+
+bool test_lehmer_jump(void) {
+    static const uint64_t steps[] = {0, 1, 2, 1000, 123457};
+    bool                  result  = true;
+    lehmer_state_t*       reference;
+    lehmer_state_t*       actual;
+
+    lehmer_pair_fixture(&reference, &actual, STREAMS);
+
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        for (uint64_t i = 0; i < steps[s]; i++) {
+            lehmer_generate(reference);
+        }
+        lehmer_jump(actual, steps[s]);
+
+        if (!lehmer_seeds_match(reference, actual)) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "jump %lu: expected seed %lu, got %lu\n",
+                (unsigned long) steps[s],
+                (unsigned long) lehmer_get_seed(reference),
+                (unsigned long) lehmer_get_seed(actual));
+            result = false;
+        }
+    }
+
+    // A full period is the identity
+    uint64_t seed = lehmer_get_seed(actual);
+    lehmer_jump(actual, MODULUS - 1);
+    if (seed != lehmer_get_seed(actual)) {
+        LOG(&global_logger, LOG_LEVEL_ERROR, "jump: period is not MODULUS-1\n");
+        result = false;
+    }
+
+    // The fixed stream spacing is one particular stride
+    if (A256 != lehmer_jump_multiplier(LEHMER_STREAM_STRIDE)) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "jump: MULTIPLIER^%d is %lu, expected A256\n",
+            LEHMER_STREAM_STRIDE,
+            (unsigned long) lehmer_jump_multiplier(LEHMER_STREAM_STRIDE));
+        result = false;
+    }
+
+    lehmer_seed_streams(reference, FIXTURE_SEED);
+    lehmer_seed_streams_stride(actual, FIXTURE_SEED, LEHMER_STREAM_STRIDE);
+    if (!lehmer_seeds_match(reference, actual)) {
+        LOG(&global_logger, LOG_LEVEL_ERROR, "jump: stride seeding differs\n");
+        result = false;
+    }
+
+    lehmer_free_state(reference);
+    lehmer_free_state(actual);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Workers on disjoint jumps of one stream reproduce the serial sequence
+bool test_lehmer_jump_workers(size_t workers) {
+    bool            result   = true;
+    const size_t    chunk    = FIXTURE_SIZE;
+    const size_t    n        = chunk * workers;
+    lehmer_state_t* serial   = lehmer_create_state(1);
+    lehmer_state_t* worker   = lehmer_create_state(workers);
+    double*         expected = (double*) malloc(sizeof(double) * n);
+    double*         actual   = (double*) malloc(sizeof(double) * n);
+
+    lehmer_set_seed(serial, FIXTURE_SEED);
+    lehmer_generate_batch(serial, expected, n);
+
+    lehmer_seed_streams_stride(worker, FIXTURE_SEED, chunk);
+    for (size_t w = 0; w < workers; w++) {
+        lehmer_select_stream(worker, w);
+        lehmer_generate_batch(worker, actual + w * chunk, chunk);
+    }
+
+    if (0 != memcmp(expected, actual, sizeof(double) * n)) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "jump workers %zu: sequence differs from serial\n",
+            workers);
+        result = false;
+    }
+
+    free(expected);
+    free(actual);
+    lehmer_free_state(serial);
+    lehmer_free_state(worker);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Concurrent workers on distinct streams match serial generation
+bool test_lehmer_thread_streams(void) {
+    bool            result = true;
+    lehmer_state_t* reference;
+    lehmer_state_t* actual;
+    pthread_t       threads[FIXTURE_THREADS];
+    lehmer_worker_t workers[FIXTURE_THREADS];
+
+    lehmer_pair_fixture(&reference, &actual, FIXTURE_THREADS);
+
+    if (LEHMER_CACHE_LINE != sizeof(lehmer_stream_t)
+        || LEHMER_CACHE_LINE != alignof(lehmer_stream_t)) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "thread streams: handle is %zu bytes aligned to %zu\n",
+            sizeof(lehmer_stream_t),
+            alignof(lehmer_stream_t));
+        result = false;
+    }
+
+    for (size_t w = 0; w < FIXTURE_THREADS; w++) {
+        workers[w].state  = actual;
+        workers[w].stream = w;
+        pthread_create(&threads[w], NULL, lehmer_worker_fixture, &workers[w]);
+    }
+    for (size_t w = 0; w < FIXTURE_THREADS; w++) {
+        pthread_join(threads[w], NULL);
+    }
+
+    for (size_t w = 0; w < FIXTURE_THREADS && result; w++) {
+        result &= workers[w].bound;
+
+        lehmer_select_stream(reference, w);
+        for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+            double expected = lehmer_generate(reference);
+            if (expected != workers[w].values[i]) {
+                LOG(&global_logger,
+                    LOG_LEVEL_ERROR,
+                    "thread stream %zu[%zu]: expected %.17g, got %.17g\n",
+                    w,
+                    i,
+                    expected,
+                    workers[w].values[i]);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    if (result && !lehmer_seeds_match(reference, actual)) {
+        LOG(&global_logger, LOG_LEVEL_ERROR, "thread streams: not committed\n");
+        result = false;
+    }
+
+    lehmer_free_state(reference);
+    lehmer_free_state(actual);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Kolmogorov-Smirnov against the normal CDF, plus the first two moments
+bool test_lehmer_normal(void) {
+    const size_t    n        = FIXTURE_SAMPLES;
+    bool            result   = true;
+    lehmer_state_t* state    = lehmer_create_state(1);
+    lehmer_state_t* batch    = lehmer_create_state(1);
+    double*         samples  = (double*) malloc(sizeof(double) * n);
+    float           values[FIXTURE_SIZE];
+    double          mean     = 0.0;
+    double          variance = 0.0;
+
+    lehmer_set_seed(state, FIXTURE_SEED);
+    lehmer_set_seed(batch, FIXTURE_SEED);
+
+    lehmer_normal_batch(batch, values, FIXTURE_SIZE, 0.5f, 2.0f);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        float expected = (float) (0.5f + 2.0f * lehmer_normal(state));
+        if (expected != values[i]) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "normal batch[%zu]: expected %.9g, got %.9g\n",
+                i,
+                (double) expected,
+                (double) values[i]);
+            result = false;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < FIXTURE_SAMPLES; i++) {
+        samples[i]  = lehmer_normal(state);
+        mean       += samples[i];
+        variance   += samples[i] * samples[i];
+    }
+    mean     /= FIXTURE_SAMPLES;
+    variance  = variance / FIXTURE_SAMPLES - mean * mean;
+
+    qsort(samples, FIXTURE_SAMPLES, sizeof(double), compare_doubles);
+
+    double distance = 0.0;
+    for (size_t i = 0; i < FIXTURE_SAMPLES; i++) {
+        double cdf  = 0.5 * erfc(-samples[i] / sqrt(2.0));
+        double low  = fabs(cdf - (double) i / FIXTURE_SAMPLES);
+        double high = fabs(cdf - (double) (i + 1) / FIXTURE_SAMPLES);
+        distance    = fmax(distance, fmax(low, high));
+    }
+
+    // Critical values at the 0.1% level
+    double limit = 1.95 / sqrt((double) FIXTURE_SAMPLES);
+    LOG(&global_logger, LOG_LEVEL_DEBUG, "normal: KS %g\n", distance);
+    if (distance > limit || fabs(mean) > 3.3 / sqrt((double) FIXTURE_SAMPLES)
+        || fabs(variance - 1.0) > 0.015) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "normal: KS %g (limit %g), mean %g, variance %g\n",
+            distance,
+            limit,
+            mean,
+            variance);
+        result = false;
+    }
+
+    free(samples);
+    lehmer_free_state(state);
+    lehmer_free_state(batch);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lehmer_uniform(void) {
+    bool            result = true;
+    lehmer_state_t* state  = lehmer_create_state(1);
+    float           values[FIXTURE_SIZE];
+
+    lehmer_set_seed(state, FIXTURE_SEED);
+    lehmer_uniform_batch(state, values, FIXTURE_SIZE, -0.25f, 0.75f);
+
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        if (values[i] < -0.25f || values[i] >= 0.75f) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "uniform[%zu]: %.9g outside [-0.25, 0.75)\n",
+                i,
+                (double) values[i]);
+            result = false;
+            break;
+        }
+    }
+
+    // Stepping back one draw from the extreme seeds: MODULUS - 2 steps
+    static const uint64_t seeds[]    = {1, MODULUS - 1};
+    static const float    expected[] = {0.0f, 1.0f - 0x1p-23f};
+    for (size_t i = 0; i < 2; i++) {
+        lehmer_set_seed(state, seeds[i]);
+        lehmer_jump(state, MODULUS - 2);
+
+        float value = lehmer_generate_float(state);
+        if (expected[i] != value) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "uniform: seed %lu gives %.9g, expected %.9g\n",
+                (unsigned long) seeds[i],
+                (double) value,
+                (double) expected[i]);
+            result = false;
+        }
+    }
+
+    lehmer_free_state(state);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Chi-square over range buckets, bounds, and batch against scalar
+bool test_lehmer_bounded(uint32_t range) {
+    bool            result = true;
+    lehmer_state_t* state  = lehmer_create_state(1);
+    lehmer_state_t* batch  = lehmer_create_state(1);
+    uint32_t        values[FIXTURE_SIZE];
+    size_t          counts[16] = {0};
+
+    lehmer_set_seed(state, FIXTURE_SEED);
+    lehmer_set_seed(batch, FIXTURE_SEED);
+
+    lehmer_bounded_batch(batch, values, FIXTURE_SIZE, range);
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        uint32_t expected = lehmer_bounded(state, range);
+        if (expected != values[i] || (range && values[i] >= range)
+            || (!range && values[i])) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "bounded %u[%zu]: expected %u, got %u\n",
+                range,
+                i,
+                expected,
+                values[i]);
+            result = false;
+            break;
+        }
+    }
+
+    if (range > 1 && range <= 16) {
+        double chi = 0.0;
+        for (size_t i = 0; i < FIXTURE_SAMPLES; i++) {
+            counts[lehmer_bounded(state, range)]++;
+        }
+        for (uint32_t b = 0; b < range; b++) {
+            double expected  = (double) FIXTURE_SAMPLES / range;
+            chi             += (counts[b] - expected) * (counts[b] - expected)
+                   / expected;
+        }
+
+        // 0.1% critical value for up to 15 degrees of freedom
+        if (chi > 37.7) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "bounded %u: chi-square %g\n",
+                range,
+                chi);
+            result = false;
+        }
+    }
+
+    lehmer_free_state(state);
+    lehmer_free_state(batch);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    result &= test_lehmer_step();
+    result &= test_lehmer_check();
+    result &= test_lehmer_generate_batch();
+
+    // Odd, partial and whole-register lane counts, and more lanes than streams
+    result &= test_lehmer_generate_lanes(1);
+    result &= test_lehmer_generate_lanes(3);
+    result &= test_lehmer_generate_lanes(4);
+    result &= test_lehmer_generate_lanes(8);
+    result &= test_lehmer_generate_lanes(16);
+    result &= test_lehmer_throughput();
+    result &= test_lehmer_jump();
+    result &= test_lehmer_jump_workers(1);
+    result &= test_lehmer_jump_workers(7);
+    result &= test_lehmer_thread_streams();
+    result &= test_lehmer_normal();
+    result &= test_lehmer_uniform();
+
+    // Empty, trivial, small, and ranges that force rejection
+    result &= test_lehmer_bounded(0);
+    result &= test_lehmer_bounded(1);
+    result &= test_lehmer_bounded(10);
+    result &= test_lehmer_bounded(16);
+    result &= test_lehmer_bounded(LEHMER_RANGE_MAX / 3 * 2);
+    result &= test_lehmer_bounded(LEHMER_RANGE_MAX);
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,482 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear.c
+ *
+ * Build:
+ *   g++ -std=c++17 -c source/tables.cpp -o tables.o
+ *   g++ -std=c++17 -O2 -march=native -c source/linear.cpp -o linear.o
+ *   gcc -O2 -march=native -Iinclude -o test_linear tests/test_linear.c \
+ *       source/vector.c source/lehmer.c source/logger.c linear.o tables.o \
+ *       -lm -lpthread
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible. The
+ * simpler, the better.
+ */
+
+#include "../include/linear.h"
+#include "../include/logger.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** Prototypes */
+
+bool test_linear_model(void);
+bool test_linear_gradient(size_t n);
+bool test_linear_fit(void);
+bool test_linear_throughput(void);
+bool test_linear_ols(float offset);
+bool test_linear_stats_merge(void);
+bool test_linear_ols_threads(size_t threads);
+bool test_linear_ols_degenerate(void);
+bool test_linear_ols_throughput(void);
+bool test_linear_shuffle(size_t n);
+bool test_linear_minibatch(size_t batch_size);
+bool test_linear_minibatch_throughput(void);
+
+/** Fixtures */
+
+#define FIXTURE_SIZE      1003 // not a multiple of the lane count
+#define FIXTURE_SLOPE     2.0f
+#define FIXTURE_INTERCEPT 1.0f
+#define FIXTURE_TOLERANCE 1e-4f
+#define FIXTURE_THREADS   8
+#define FIXTURE_SEED      20240601
+
+// Points on y = 2x + 1 with a small deterministic wobble, x in [0, 1)
+static void linear_fixture(float* X, float* Y, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        X[i] = (float) i / (float) n;
+        Y[i] = FIXTURE_SLOPE * X[i] + FIXTURE_INTERCEPT
+               + 0.01f * (float) ((int) (i * 7919 % 13) - 6);
+    }
+}
+
+static bool fixture_close(float actual, float expected, float tolerance) {
+    return fabsf(actual - expected) <= tolerance * fmaxf(1.0f, fabsf(expected));
+}
+
+static double fixture_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+/** Unit Tests */
+
+bool test_linear_model(void) {
+    struct LinearModel* model = create_linear_model(FIXTURE_SIZE, 1e-5f, 100);
+
+    bool result = NULL != model && NULL != model->params
+                  && FIXTURE_SIZE == model->X->dimensions
+                  && FIXTURE_SIZE == model->Y->dimensions
+                  && 1.0f == model->params->slope
+                  && 1.0f == model->params->intercept && 100 == model->iterations;
+
+    result &= destroy_linear_model(model);
+    result &= !destroy_linear_model(NULL);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// The fused pass matches the three separate passes
+bool test_linear_gradient(size_t n) {
+    float* X = (float*) calloc(n + 1, sizeof(float));
+    float* Y = (float*) calloc(n + 1, sizeof(float));
+    linear_fixture(X, Y, n);
+
+    const float     m        = 0.5f;
+    const float     b        = -0.25f;
+    struct Gradient gradient = mean_square_error_gradient(X, Y, n, m, b);
+
+    float mse  = mean_square_error(X, Y, n, m, b);
+    float dedm = n ? partial_derivative_m(X, Y, n, m, b) : 0.0f;
+    float dedb = n ? partial_derivative_b(X, Y, n, m, b) : 0.0f;
+
+    bool result = fixture_close(gradient.mse, mse, FIXTURE_TOLERANCE)
+                  && fixture_close(gradient.dedm, dedm, FIXTURE_TOLERANCE)
+                  && fixture_close(gradient.dedb, dedb, FIXTURE_TOLERANCE);
+
+    // Below the line, both derivatives point down
+    result &= 0 == n || (gradient.dedm < 0.0f && gradient.dedb < 0.0f);
+
+    if (!result) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "gradient n=%zu: fused (%g, %g, %g), separate (%g, %g, %g)\n",
+            n,
+            (double) gradient.mse,
+            (double) gradient.dedm,
+            (double) gradient.dedb,
+            (double) mse,
+            (double) dedm,
+            (double) dedb);
+    }
+
+    free(X);
+    free(Y);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Descent converges to the line the fixture was drawn from
+bool test_linear_fit(void) {
+    float X[FIXTURE_SIZE];
+    float Y[FIXTURE_SIZE];
+    linear_fixture(X, Y, FIXTURE_SIZE);
+
+    struct Params params = fit_linear_regression(X, Y, FIXTURE_SIZE, 0.5f, 5000);
+
+    bool result = fixture_close(params.slope, FIXTURE_SLOPE, 1e-2f)
+                  && fixture_close(params.intercept, FIXTURE_INTERCEPT, 1e-2f);
+    if (!result) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "fit: slope %f, intercept %f\n",
+            (double) params.slope,
+            (double) params.intercept);
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_throughput(void) {
+    const size_t n          = 1 << 20;
+    const size_t iterations = 20;
+    float*       X          = (float*) malloc(sizeof(float) * n);
+    float*       Y          = (float*) malloc(sizeof(float) * n);
+    float        sum        = 0.0f;
+    linear_fixture(X, Y, n);
+
+    double start = fixture_seconds();
+    for (size_t i = 0; i < iterations; i++) {
+        sum += mean_square_error(X, Y, n, 1.0f, 1.0f);
+        sum += partial_derivative_m(X, Y, n, 1.0f, 1.0f);
+        sum += partial_derivative_b(X, Y, n, 1.0f, 1.0f);
+    }
+    double separate_seconds = fixture_seconds() - start;
+
+    start = fixture_seconds();
+    for (size_t i = 0; i < iterations; i++) {
+        struct Gradient gradient = mean_square_error_gradient(X, Y, n, 1.0f, 1.0f);
+        sum += gradient.mse + gradient.dedm + gradient.dedb;
+    }
+    double fused_seconds = fixture_seconds() - start;
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "linear gradient: separate %.2f, fused %.2f ms per iteration (%g)\n",
+        separate_seconds / iterations * 1e3,
+        fused_seconds / iterations * 1e3,
+        (double) sum);
+
+    free(X);
+    free(Y);
+
+    printf(".");
+    return true;
+}
+
+// Points exactly on y = 2x + 1 give back the line, even far from the origin
+bool test_linear_ols(float offset) {
+    float X[FIXTURE_SIZE];
+    float Y[FIXTURE_SIZE];
+    for (size_t i = 0; i < FIXTURE_SIZE; i++) {
+        X[i] = offset + (float) i / 8.0f; // exact in float
+        Y[i] = FIXTURE_SLOPE * X[i] + FIXTURE_INTERCEPT;
+    }
+
+    struct Params params = fit_linear_ols(X, Y, FIXTURE_SIZE, 1);
+
+    // The intercept is extrapolated from offset back to 0
+    bool result = fixture_close(params.slope, FIXTURE_SLOPE, 1e-6f)
+                  && fixture_close(params.intercept, FIXTURE_INTERCEPT, 1e-6f * (1.0f + offset));
+    if (!result) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "ols offset %g: slope %.9g, intercept %.9g\n",
+            (double) offset,
+            (double) params.slope,
+            (double) params.intercept);
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Statistics built in pieces and merged solve to the same line as one pass
+bool test_linear_stats_merge(void) {
+    float X[FIXTURE_SIZE];
+    float Y[FIXTURE_SIZE];
+    linear_fixture(X, Y, FIXTURE_SIZE);
+
+    struct LinearStats whole = {0};
+    struct LinearStats parts = {0};
+    struct LinearStats tail  = {0};
+    linear_stats_update(&whole, X, Y, FIXTURE_SIZE);
+    linear_stats_update(&parts, X, Y, 1);
+    linear_stats_update(&parts, X + 1, Y + 1, 500);
+    linear_stats_update(&tail, X + 501, Y + 501, FIXTURE_SIZE - 501);
+    linear_stats_merge(&parts, &tail);
+
+    struct Params expected, actual;
+    bool          result = linear_stats_solve(&whole, &expected);
+    result              &= linear_stats_solve(&parts, &actual);
+    result              &= FIXTURE_SIZE == parts.n;
+    result              &= fixture_close(actual.slope, expected.slope, 1e-6f)
+              && fixture_close(actual.intercept, expected.intercept, 1e-6f);
+
+    // The wobble averages out, so least squares lands near the generating line
+    result &= fixture_close(expected.slope, FIXTURE_SLOPE, 1e-2f)
+              && fixture_close(expected.intercept, FIXTURE_INTERCEPT, 1e-2f);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Any thread count fits the same line
+bool test_linear_ols_threads(size_t threads) {
+    const size_t n = 1 << 16;
+    float*       X = (float*) malloc(sizeof(float) * n);
+    float*       Y = (float*) malloc(sizeof(float) * n);
+    linear_fixture(X, Y, n);
+
+    struct Params expected = fit_linear_ols(X, Y, n, 1);
+    struct Params actual   = fit_linear_ols(X, Y, n, threads);
+
+    bool result = fixture_close(actual.slope, expected.slope, 1e-6f)
+                  && fixture_close(actual.intercept, expected.intercept, 1e-6f);
+    if (!result) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "ols threads %zu: slope %.9g vs %.9g\n",
+            threads,
+            (double) actual.slope,
+            (double) expected.slope);
+    }
+
+    free(X);
+    free(Y);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_ols_degenerate(void) {
+    float X[] = {3.0f, 3.0f, 3.0f};
+    float Y[] = {1.0f, 2.0f, 6.0f};
+
+    struct LinearStats stats  = {0};
+    struct Params      params = {1.0f, 1.0f};
+
+    // No points, then a vertical set of points: no unique line
+    bool result = !linear_stats_solve(&stats, &params);
+    result     &= 0.0f == params.slope && 0.0f == params.intercept;
+
+    linear_stats_update(&stats, X, Y, 3);
+    result &= !linear_stats_solve(&stats, &params);
+    result &= 0.0f == params.slope && 3.0f == params.intercept;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_ols_throughput(void) {
+    const size_t n = 1 << 22;
+    float*       X = (float*) malloc(sizeof(float) * n);
+    float*       Y = (float*) malloc(sizeof(float) * n);
+    linear_fixture(X, Y, n);
+
+    double        start  = fixture_seconds();
+    struct Params single = fit_linear_ols(X, Y, n, 1);
+    double        one    = fixture_seconds() - start;
+
+    start                  = fixture_seconds();
+    struct Params parallel = fit_linear_ols(X, Y, n, FIXTURE_THREADS);
+    double        many     = fixture_seconds() - start;
+
+    start                    = fixture_seconds();
+    struct Gradient gradient = mean_square_error_gradient(X, Y, n, 1.0f, 1.0f);
+    double          step     = fixture_seconds() - start;
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "linear ols: 1 thread %.2f, %d threads %.2f, one gradient step %.2f ms (%g)\n",
+        one * 1e3,
+        FIXTURE_THREADS,
+        many * 1e3,
+        step * 1e3,
+        (double) (single.slope + parallel.slope + gradient.mse));
+
+    free(X);
+    free(Y);
+
+    printf(".");
+    return true;
+}
+
+// Every index appears once, and a seed always gives the same order
+bool test_linear_shuffle(size_t n) {
+    uint32_t*       order  = (uint32_t*) malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t*       again  = (uint32_t*) malloc(sizeof(uint32_t) * (n + 1));
+    bool*           seen   = (bool*) calloc(n + 1, sizeof(bool));
+    lehmer_state_t* state  = lehmer_create_state(1);
+    bool            result = true;
+
+    lehmer_set_seed(state, FIXTURE_SEED);
+    linear_shuffle(order, n, state);
+    lehmer_set_seed(state, FIXTURE_SEED);
+    linear_shuffle(again, n, state);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (order[i] >= n || seen[order[i]]) {
+            result = false;
+            break;
+        }
+        seen[order[i]]  = true;
+        moved          += order[i] != i;
+    }
+    result &= 0 == memcmp(order, again, sizeof(uint32_t) * n);
+
+    // A long identity permutation would be vanishingly unlikely
+    result &= n < 16 || moved > n / 2;
+
+    free(order);
+    free(again);
+    free(seen);
+    lehmer_free_state(state);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Mini-batch descent reaches the least squares line, reproducibly
+bool test_linear_minibatch(size_t batch_size) {
+    struct LinearModel* model = create_linear_model(FIXTURE_SIZE, 0.1f, 200);
+    lehmer_state_t*     state = lehmer_create_state(1);
+    linear_fixture(model->X->elements, model->Y->elements, FIXTURE_SIZE);
+
+    // Full batches take the same steps as plain gradient descent, in another order
+    struct Params expected
+        = batch_size
+              ? fit_linear_ols(model->X->elements, model->Y->elements, FIXTURE_SIZE, 1)
+              : fit_linear_regression(
+                    model->X->elements, model->Y->elements, FIXTURE_SIZE, 0.1f, 200
+                );
+    float tolerance = batch_size ? 2e-2f : FIXTURE_TOLERANCE;
+
+    lehmer_set_seed(state, FIXTURE_SEED);
+    struct Params actual = fit_linear_minibatch(model, batch_size, state);
+
+    bool result = actual.slope == model->params->slope
+                  && actual.intercept == model->params->intercept
+                  && fixture_close(actual.slope, expected.slope, tolerance)
+                  && fixture_close(actual.intercept, expected.intercept, tolerance);
+
+    // Same seed, same start, same result
+    model->params->slope     = 1.0f;
+    model->params->intercept = 1.0f;
+    lehmer_set_seed(state, FIXTURE_SEED);
+    struct Params repeat = fit_linear_minibatch(model, batch_size, state);
+    result              &= repeat.slope == actual.slope && repeat.intercept == actual.intercept;
+
+    if (!result) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "minibatch %zu: slope %f, intercept %f, expected %f, %f\n",
+            batch_size,
+            (double) actual.slope,
+            (double) actual.intercept,
+            (double) expected.slope,
+            (double) expected.intercept);
+    }
+
+    destroy_linear_model(model);
+    lehmer_free_state(state);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Loss above the optimum after the same number of passes over the data
+bool test_linear_minibatch_throughput(void) {
+    const size_t        n      = 1 << 20;
+    const size_t        epochs = 4;
+    struct LinearModel* model  = create_linear_model(n, 0.5f, epochs);
+    lehmer_state_t*     state  = lehmer_create_state(1);
+    float*              X      = model->X->elements;
+    float*              Y      = model->Y->elements;
+    linear_fixture(X, Y, n);
+    lehmer_set_seed(state, FIXTURE_SEED);
+
+    struct Params best    = fit_linear_ols(X, Y, n, 1);
+    float         optimum = mean_square_error(X, Y, n, best.slope, best.intercept);
+
+    double        start = fixture_seconds();
+    struct Params full  = fit_linear_regression(X, Y, n, model->learning_rate, epochs);
+    double        full_seconds = fixture_seconds() - start;
+
+    start                       = fixture_seconds();
+    struct Params batch         = fit_linear_minibatch(model, 256, state);
+    double        batch_seconds = fixture_seconds() - start;
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "linear %zu epochs: full batch %.1f ms (excess mse %.2e), batch 256 %.1f ms (%.2e)\n",
+        epochs,
+        full_seconds * 1e3,
+        (double) (mean_square_error(X, Y, n, full.slope, full.intercept) - optimum),
+        batch_seconds * 1e3,
+        (double) (mean_square_error(X, Y, n, batch.slope, batch.intercept) - optimum));
+
+    destroy_linear_model(model);
+    lehmer_free_state(state);
+
+    printf(".");
+    return true;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    result &= test_linear_model();
+    result &= test_linear_gradient(FIXTURE_SIZE);
+    result &= test_linear_gradient(LINEAR_LANES - 1);
+    result &= test_linear_gradient(0);
+    result &= test_linear_fit();
+    result &= test_linear_throughput();
+    result &= test_linear_ols(0.0f);
+    result &= test_linear_ols(1e4f);
+    result &= test_linear_stats_merge();
+    result &= test_linear_ols_threads(3);
+    result &= test_linear_ols_threads(FIXTURE_THREADS);
+    result &= test_linear_ols_degenerate();
+    result &= test_linear_ols_throughput();
+    result &= test_linear_shuffle(0);
+    result &= test_linear_shuffle(1);
+    result &= test_linear_shuffle(FIXTURE_SIZE);
+    result &= test_linear_minibatch(1);
+    result &= test_linear_minibatch(32);
+    result &= test_linear_minibatch(0);
+    result &= test_linear_minibatch_throughput();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
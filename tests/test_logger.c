@@ -14,6 +14,21 @@
  *   [ERROR] Lazy logger error
  *   [INFO] Should log info
  *   [ERROR] Should log error
+ *   [ERROR] Module error 1
+ *   [INFO] Module levels: filtered
+ *   [INFO] Limited logging: 7 messages, 1013 suppressed
+ *   [INFO] Limited summaries: 499 periodic, 300 after destruction
+ *   [INFO] Async logger: 40000 lines in order
+ *   [INFO] Async logger (drop): ... lines written, ... dropped
+ *   [INFO] Async logger (overwrite): ... lines written, ... dropped
+ *   [INFO] Segment logger: ... segments rotated and compressed
+ *   [INFO] Buffered logger: 40000 lines in order
+ *   [INFO] Binary logger: 4 lines decoded exactly
+ *   [INFO] Structured logger: 4 lines as expected
+ *   [INFO] Truncated JSON: 12 lines valid
+ *   [INFO] 4 threads: sync ... ns, async ... ns, buffered ... ns per message
+ *   [INFO] 1 thread: buffered text ... ns, binary ... ns per message
+ *   [INFO] 1 thread: plain ... ns, stamped ... ns, json ... ns per message
  *   Finished all tests!
  * Run: cat test.log
  * Expected output:
@@ -22,7 +37,162 @@
 
 #include "../include/logger.h"
 
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ASYNC_THREADS  4
+#define ASYNC_MESSAGES 10000
+#define ASYNC_PATH     "test_async.log"
+#define BUFFERED_PATH  "test_buffered.log"
+#define BINARY_PATH    "test_binary.log"
+#define DECODED_PATH   "test_decoded.log"
+#define BINARY_COUNT   1000000
+#define LIMITED_PATH   "test_limited.log"
+#define SEGMENT_PATH   "test_segment"
+#define SEGMENT_MAX    256
+#define FORMAT_PATH    "test_format.log"
+#define FORMAT_COUNT   1000000
+
+typedef struct AsyncWorker {
+    struct Logger* logger;
+    int            thread;
+    int            messages;
+} async_worker_t;
+
+static void* async_worker(void* argument) {
+    async_worker_t* worker = (async_worker_t*) argument;
+    for (int i = 0; i < worker->messages; i++) {
+        logger_message(worker->logger, LOG_LEVEL_INFO, "thread %d message %d\n", worker->thread, i);
+    }
+    return NULL;
+}
+
+// Log from several threads; returns the elapsed seconds
+static double async_run_workers(struct Logger* logger, int messages) {
+    pthread_t       threads[ASYNC_THREADS];
+    async_worker_t  workers[ASYNC_THREADS];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < ASYNC_THREADS; t++) {
+        workers[t] = (async_worker_t) {logger, t, messages};
+        pthread_create(&threads[t], NULL, async_worker, &workers[t]);
+    }
+    for (int t = 0; t < ASYNC_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+// Count the lines of the async test file and check per-thread ordering
+static int async_count_lines(bool* ordered) {
+    FILE* file = fopen(ASYNC_PATH, "r");
+    int   next[ASYNC_THREADS] = {0};
+    int   lines               = 0;
+    char  line[256];
+
+    *ordered = true;
+    while (file && fgets(line, sizeof(line), file)) {
+        int thread, message;
+        if (2 == sscanf(line, "[INFO] thread %d message %d", &thread, &message)) {
+            *ordered       &= message >= next[thread];
+            next[thread]    = message + 1;
+        }
+        lines++;
+    }
+    if (file) {
+        fclose(file);
+    }
+    return lines;
+}
+
+// Check that sequence numbers cover [0, lines) and replay each thread in order
+static int buffered_count_lines(bool* ordered) {
+    const int total               = ASYNC_THREADS * ASYNC_MESSAGES;
+    int*      message_of_sequence = (int*) malloc(sizeof(int) * total);
+    int*      thread_of_sequence  = (int*) malloc(sizeof(int) * total);
+    int       next[ASYNC_THREADS] = {0};
+    int       lines               = 0;
+    FILE*     file                = fopen(BUFFERED_PATH, "r");
+    char      line[256];
+
+    for (int i = 0; i < total; i++) {
+        thread_of_sequence[i] = -1;
+    }
+
+    *ordered = true;
+    while (file && fgets(line, sizeof(line), file)) {
+        unsigned long long sequence;
+        int                thread, message;
+        if (3 != sscanf(line, "%llu [INFO] thread %d message %d", &sequence, &thread, &message)
+            || sequence >= (unsigned long long) total || -1 != thread_of_sequence[sequence]) {
+            *ordered = false;
+            continue;
+        }
+        thread_of_sequence[sequence]  = thread;
+        message_of_sequence[sequence] = message;
+        lines++;
+    }
+    if (file) {
+        fclose(file);
+    }
+
+    // Merged by sequence number, every thread's messages come out in order
+    for (int i = 0; i < lines && *ordered; i++) {
+        int thread  = thread_of_sequence[i];
+        *ordered   &= thread >= 0 && message_of_sequence[i] == next[thread]++;
+    }
+
+    free(message_of_sequence);
+    free(thread_of_sequence);
+    return lines;
+}
+
+// Stand-in compressor: renames the segment and counts the calls
+static bool segment_compress(const char* path, char* compressed, size_t size, void* context) {
+    snprintf(compressed, size, "%s.z", path);
+    ++*(int*) context;
+    return 0 == rename(path, compressed);
+}
+
+// Count, check and remove the compressed segments; returns the number of files
+static int segment_count_files(int* lines, bool* ordered) {
+    int  next[ASYNC_THREADS] = {0};
+    int  files               = 0;
+    char path[64];
+    char line[256];
+
+    *lines   = 0;
+    *ordered = true;
+    for (int index = 0; index < SEGMENT_MAX; index++) {
+        snprintf(path, sizeof(path), "%s.%06d.z", SEGMENT_PATH, index);
+        FILE* file = fopen(path, "r");
+        if (NULL == file) {
+            continue;
+        }
+        while (fgets(line, sizeof(line), file)) {
+            int thread, message;
+            if (2 == sscanf(line, "[INFO] thread %d message %d", &thread, &message)) {
+                *ordered       &= message >= next[thread];
+                next[thread]    = message + 1;
+            }
+            (*lines)++;
+        }
+        fclose(file);
+        remove(path);
+        files++;
+    }
+    return files;
+}
 
 // Test the explicit initialization of the global logger
 void test_global_logger_initialization() {
@@ -59,6 +229,629 @@ void test_logging_to_file() {
     logger_destroy(file_logger);
 }
 
+// Counts how often LOG evaluated its arguments
+static int module_argument(int* evaluations) {
+    return ++*evaluations;
+}
+
+// Test that filtered messages never evaluate their arguments
+bool test_module_levels() {
+    struct Logger* logger      = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, NULL);
+    int            evaluations = 0;
+    bool           result      = true;
+
+    // Below the compile-time minimum the call is gone entirely
+    LOG(logger, LOG_LEVEL_DEBUG, "Module debug %d\n", module_argument(&evaluations));
+    result &= evaluations == ((int) LOG_MIN_LEVEL > (int) LOG_LEVEL_DEBUG ? 0 : 1);
+
+    evaluations = 0;
+    logger_set_module_level(LOG_MODULE_DEFAULT, LOG_LEVEL_ERROR);
+    result &= LOG_LEVEL_ERROR == logger_get_module_level(LOG_MODULE_DEFAULT);
+    result &= LOG_LEVEL_DEBUG == logger_get_module_level(LOG_MODULE_VECTOR);
+    LOG(logger, LOG_LEVEL_WARN, "Module warning %d\n", module_argument(&evaluations));
+    LOG(logger, LOG_LEVEL_ERROR, "Module error %d\n", module_argument(&evaluations));
+    result &= 1 == evaluations;
+
+    result &= !logger_set_module_level(LOG_MODULE_COUNT, LOG_LEVEL_ERROR);
+    logger_set_module_level(LOG_MODULE_DEFAULT, LOG_LEVEL_DEBUG);
+    logger_destroy(logger);
+
+    LOG(&global_logger, LOG_LEVEL_INFO, "Module levels: %s\n", result ? "filtered" : "FAILED");
+    return result;
+}
+
+// Counts the messages and the suppressed totals reported in a limited log
+static unsigned long long limited_count_suppressed(int* messages) {
+    FILE*              file  = fopen(LIMITED_PATH, "r");
+    unsigned long long total = 0;
+    char               line[256];
+
+    // Buffered lines start with a sequence number, so parse after the prefix
+    *messages = 0;
+    while (file && fgets(line, sizeof(line), file)) {
+        const char*        body = strrchr(line, ']');
+        unsigned long long suppressed;
+        if (body && 1 == sscanf(body + 1, " %llu similar messages suppressed", &suppressed)) {
+            total += suppressed;
+        } else {
+            (*messages)++;
+        }
+    }
+    if (file) {
+        fclose(file);
+    }
+    return total;
+}
+
+// One limited site shared by every logger passed in
+static void limited_storm(struct Logger* logger, int count) {
+    for (int i = 0; i < count; i++) {
+        LOG_EVERY_MS(logger, LOG_LEVEL_WARN, 60 * 1000, "storm %d\n", i);
+    }
+}
+
+// Test that limited sites account for every message they suppress
+bool test_limited_logging() {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, LIMITED_PATH);
+    int            evaluations = 0;
+
+    for (int i = 0; i < 10; i++) {
+        LOG_FIRST_N(logger, LOG_LEVEL_WARN, 3, "first %d\n", module_argument(&evaluations));
+    }
+    for (int i = 0; i < 10; i++) {
+        LOG_EVERY_N(logger, LOG_LEVEL_WARN, 4, "every %d\n", i);
+    }
+    for (int i = 0; i < 1000; i++) {
+        LOG_EVERY_MS(logger, LOG_LEVEL_ERROR, 60 * 1000, "interval %d\n", i);
+    }
+    logger_destroy(logger);
+
+    // 3 + 3 + 1 messages; 7 + 7 + 999 suppressed, in reports or at destruction
+    int                messages;
+    unsigned long long total = limited_count_suppressed(&messages);
+    remove(LIMITED_PATH);
+
+    // Arguments of suppressed messages are never evaluated
+    bool result = 3 == evaluations && 7 == messages && 1013 == total;
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Limited logging: %d messages, %llu suppressed\n",
+        messages,
+        total);
+    return result;
+}
+
+// Test that summaries arrive without further suppressions, and only at their logger
+bool test_limited_summary() {
+    struct Logger*     logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, LIMITED_PATH);
+    struct timespec    pause  = {1, 500000000};
+    int                messages;
+    unsigned long long periodic;
+    unsigned long long moved;
+    bool               result = logger_start_buffered(logger, 0, 0);
+
+    // The flusher reports the storm once the summary interval has passed
+    limited_storm(logger, 500);
+    nanosleep(&pause, NULL);
+    periodic  = limited_count_suppressed(&messages);
+    result   &= 1 == messages && 499 == periodic;
+    logger_destroy(logger);
+    remove(LIMITED_PATH);
+
+    // Destruction released the site, so a new logger collects what follows
+    logger  = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, LIMITED_PATH);
+    limited_storm(logger, 300);
+    logger_flush(logger);
+    moved   = limited_count_suppressed(&messages);
+    result &= 0 == messages && 300 == moved;
+    logger_destroy(logger);
+    remove(LIMITED_PATH);
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Limited summaries: %llu periodic, %llu after destruction\n",
+        periodic,
+        moved);
+    return result;
+}
+
+// Test that every message from concurrent producers is written once, in order
+bool test_async_logging() {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, ASYNC_PATH);
+
+    logger_start_async(logger, 0, LOG_POLICY_BLOCK);
+    async_run_workers(logger, ASYNC_MESSAGES);
+    logger_flush(logger);
+
+    bool ordered;
+    int  lines  = async_count_lines(&ordered);
+    bool result = ordered && ASYNC_THREADS * ASYNC_MESSAGES == lines;
+
+    logger_destroy(logger);
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Async logger: %d lines %s\n",
+        lines,
+        ordered ? "in order" : "out of order");
+    return result;
+}
+
+// Test that a tiny queue accounts for every message it drops or overwrites
+bool test_async_policy(log_policy_t policy, const char* name) {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, ASYNC_PATH);
+
+    logger_start_async(logger, 2, policy);
+    async_run_workers(logger, ASYNC_MESSAGES);
+    logger_flush(logger);
+
+    size_t dropped = logger_dropped(logger);
+    logger_destroy(logger);
+
+    bool ordered;
+    int  lines  = async_count_lines(&ordered);
+    bool result = ordered && ASYNC_THREADS * ASYNC_MESSAGES == lines + (int) dropped;
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Async logger (%s): %d lines written, %zu dropped\n",
+        name,
+        lines,
+        dropped);
+    return result;
+}
+
+// Test rotation by size and time, compression and retention of segment files
+bool test_segment_logging() {
+    struct Logger*       logger     = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, NULL);
+    int                  compressed = 0;
+    log_segment_config_t config     = {
+        .path     = SEGMENT_PATH,
+        .size     = 64 * 1024,
+        .compress = segment_compress,
+        .context  = &compressed,
+        .policy   = LOG_POLICY_BLOCK,
+    };
+
+    // Every line lands in some segment, in order, and every segment is compressed
+    bool result = logger_start_segments(logger, &config);
+    async_run_workers(logger, ASYNC_MESSAGES);
+    logger_stop_async(logger);
+
+    bool ordered;
+    int  lines;
+    int  files  = segment_count_files(&lines, &ordered);
+    result     &= ordered && ASYNC_THREADS * ASYNC_MESSAGES == lines;
+    result     &= files > 1 && files == compressed;
+
+    // Only the newest segments are kept
+    config.keep  = 2;
+    result      &= logger_start_segments(logger, &config);
+    async_run_workers(logger, ASYNC_MESSAGES);
+    logger_stop_async(logger);
+    result &= 2 == segment_count_files(&lines, &ordered);
+
+    // An idle segment is closed once its interval has passed
+    struct timespec pause = {1, 200000000};
+    config.keep           = 0;
+    config.interval       = 1;
+    result               &= logger_start_segments(logger, &config);
+    logger_message(logger, LOG_LEVEL_INFO, "before the interval\n");
+    logger_flush(logger);
+    nanosleep(&pause, NULL);
+    logger_message(logger, LOG_LEVEL_INFO, "after the interval\n");
+    logger_stop_async(logger);
+    result &= 2 == segment_count_files(&lines, &ordered) && 2 == lines;
+
+    logger_destroy(logger);
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Segment logger: %d segments rotated and compressed\n",
+        files);
+    return result;
+}
+
+// Test that per-thread buffers lose no lines and merge back into order
+bool test_buffered_logging() {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, BUFFERED_PATH);
+    bool           result = true;
+
+    // The modes are exclusive
+    result &= logger_start_buffered(logger, 0, 0);
+    result &= !logger_start_buffered(logger, 0, 0);
+    result &= !logger_start_async(logger, 0, LOG_POLICY_BLOCK);
+
+    // Worker buffers are written when their threads exit
+    async_run_workers(logger, ASYNC_MESSAGES);
+
+    bool ordered;
+    int  lines  = buffered_count_lines(&ordered);
+    result     &= ordered && ASYNC_THREADS * ASYNC_MESSAGES == lines;
+
+    // Errors are written at once, without waiting for the flusher
+    logger_stop_buffered(logger);
+    logger_start_buffered(logger, 0, 60 * 1000);
+    logger_message(logger, LOG_LEVEL_INFO, "buffered info\n");
+    logger_message(logger, LOG_LEVEL_ERROR, "buffered error\n");
+
+    FILE* file = fopen(BUFFERED_PATH, "r");
+    char  line[256];
+    int   found = 0;
+    while (file && fgets(line, sizeof(line), file)) {
+        found += NULL != strstr(line, "buffered info") || NULL != strstr(line, "buffered error");
+    }
+    if (file) {
+        fclose(file);
+    }
+    result &= 2 == found;
+
+    logger_destroy(logger);
+    remove(BUFFERED_PATH);
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Buffered logger: %d lines %s\n",
+        lines,
+        ordered ? "in order" : "out of order");
+    return result;
+}
+
+// Check a decoded line: a timestamp, then the level, the call site and message
+static bool binary_matches(const char* line, const char* level, const char* message) {
+    const char* text = strchr(line, ' ');
+    if (NULL == text || 0 != strncmp(text + 1, level, strlen(level))) {
+        return false;
+    }
+
+    size_t length = strlen(line);
+    size_t suffix = strlen(message);
+    return length >= suffix && 0 == strcmp(line + length - suffix, message)
+           && NULL != strstr(text, "[" __FILE__ ":");
+}
+
+// Test that decoding a binary log reproduces what printf would have written
+bool test_binary_logging() {
+    struct Logger* logger    = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, BINARY_PATH);
+    bool           result    = logger_start_binary(logger, 0, 0);
+    const char*    levels[4] = {"[INFO] ", "[WARN] ", "[DEBUG] ", "[ERROR] "};
+    char           expected[4][128];
+    char           transient[16];
+
+    // Every argument kind, star width and precision, and copied strings
+    errno = 0;
+    strcpy(transient, "copied");
+    LOG_BINARY(
+        logger,
+        LOG_LEVEL_INFO,
+        "kinds %d %ld %lld %zu %jd %td %c %%\n",
+        -1,
+        -2L,
+        -3LL,
+        (size_t) 4,
+        (intmax_t) -5,
+        (ptrdiff_t) 6,
+        'x'
+    );
+    LOG_BINARY(logger, LOG_LEVEL_WARN, "floats %.3f %*.*e %Lg\n", 3.14159, 12, 2, 6.02e23, 1.5L);
+    LOG_BINARY(logger, LOG_LEVEL_DEBUG, "strings [%s] [%-8s] [%.3s]\n", transient, "pad", "truncate");
+    strcpy(transient, "clobbered");
+    LOG(logger, LOG_LEVEL_ERROR, "text %d\n", 7);
+    logger_destroy(logger);
+
+    snprintf(expected[0], sizeof(expected[0]), "] kinds -1 -2 -3 4 -5 6 x %%\n");
+    snprintf(expected[1], sizeof(expected[1]), "] floats 3.142 %*.*e 1.5\n", 12, 2, 6.02e23);
+    snprintf(expected[2], sizeof(expected[2]), "] strings [copied] [pad     ] [tru]\n");
+    snprintf(expected[3], sizeof(expected[3]), "] text 7\n");
+
+    FILE* input  = fopen(BINARY_PATH, "rb");
+    FILE* output = fopen(DECODED_PATH, "w");
+    result      &= NULL != input && NULL != output && logger_decode(input, output);
+    if (input) {
+        fclose(input);
+    }
+    if (output) {
+        fclose(output);
+    }
+
+    FILE* decoded = fopen(DECODED_PATH, "r");
+    char  line[512];
+    int   lines = 0;
+    while (decoded && fgets(line, sizeof(line), decoded)) {
+        result &= lines < 4 && binary_matches(line, levels[lines], expected[lines]);
+        lines++;
+    }
+    if (decoded) {
+        fclose(decoded);
+    }
+    result &= 4 == lines;
+
+    remove(BINARY_PATH);
+    remove(DECODED_PATH);
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Binary logger: %d lines decoded %s\n",
+        lines,
+        result ? "exactly" : "with differences");
+    return result;
+}
+
+// Test the plain, stamped and JSON layouts of one message with fields
+bool test_structured_logging() {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, FORMAT_PATH);
+    log_field_t    fields[] = {
+        log_field_int("step", -42),
+        log_field_double("loss", 0.25),
+        log_field_string("name", "a \"b\"\n"),
+        log_field_bool("done", true),
+    };
+    log_field_t nan_field[] = {log_field_double("rate", NAN)};
+
+    logger_fields_message(logger, LOG_LEVEL_INFO, fields, 4, "epoch %d\n", 3);
+    bool result = logger_set_format(logger, LOG_FORMAT_STAMPED);
+    logger_fields_message(logger, LOG_LEVEL_WARN, fields, 2, "epoch %d\n", 3);
+    result &= logger_set_format(logger, LOG_FORMAT_JSON);
+    errno   = ENOENT;
+    logger_fields_message(logger, LOG_LEVEL_ERROR, fields, 4, "say \"%s\"\n", "hi");
+    logger_fields_message(logger, LOG_LEVEL_DEBUG, nan_field, 1, "tab\there");
+    result &= !logger_set_format(logger, (log_format_t) 3);
+    logger_destroy(logger);
+
+    const char* expected[] = {
+        "[INFO] epoch 3 step=-42 loss=0.25 name=\"a \\\"b\\\"\\n\" done=true\n",
+        "[WARN] epoch 3 step=-42 loss=0.25\n",
+        ",\"level\":\"ERROR\",\"error\":\"No such file or directory\",\"msg\":\"say \\\"hi\\\"\","
+        "\"step\":-42,\"loss\":0.25,\"name\":\"a \\\"b\\\"\\n\",\"done\":true}\n",
+        ",\"level\":\"DEBUG\",\"msg\":\"tab\\there\",\"rate\":\"nan\"}\n",
+    };
+
+    FILE*  file  = fopen(FORMAT_PATH, "r");
+    int    lines = 0;
+    double now   = (double) time(NULL);
+    char   line[512];
+    while (file && fgets(line, sizeof(line), file) && lines < 4) {
+        const char* tail = line;
+        double      stamp;
+        int         thread, used = 0;
+
+        // Timestamped lines start with the time and thread ID, which vary
+        if (1 == lines) {
+            result &= 2 == sscanf(line, "%lf %d %n", &stamp, &thread, &used) && thread > 0;
+        } else if (lines > 1) {
+            result &= 2 == sscanf(line, "{\"ts\":%lf,\"tid\":%d%n", &stamp, &thread, &used)
+                      && thread > 0;
+        }
+        if (lines > 0) {
+            result &= stamp > now - 10 && stamp < now + 10;
+        }
+        tail   += used;
+        result &= 0 == strcmp(tail, expected[lines++]);
+    }
+    if (file) {
+        fclose(file);
+    }
+    remove(FORMAT_PATH);
+    result &= 4 == lines;
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Structured logger: %d lines %s\n",
+        lines,
+        result ? "as expected" : "with differences");
+    return result;
+}
+
+// Skip a JSON string at text, returning what follows it or NULL if malformed
+static const char* json_skip_string(const char* text) {
+    if ('"' != *text++) {
+        return NULL;
+    }
+    for (; '"' != *text; text++) {
+        if ((unsigned char) *text < 0x20) {
+            return NULL;
+        }
+        if ('\\' == *text) {
+            text++;
+            if ('u' == *text) {
+                for (int i = 0; i < 4; i++) {
+                    if (!isxdigit((unsigned char) *++text)) {
+                        return NULL;
+                    }
+                }
+            } else if (NULL == strchr("\"\\/bfnrt", *text) || '\0' == *text) {
+                return NULL;
+            }
+        }
+    }
+    return text + 1;
+}
+
+// Check a line is one flat JSON object of strings, numbers and literals
+static bool json_line_valid(const char* line) {
+    const char* text = line;
+    if ('{' != *text++) {
+        return false;
+    }
+    do {
+        if (NULL == (text = json_skip_string(text)) || ':' != *text++) {
+            return false;
+        }
+        if ('"' == *text) {
+            text = json_skip_string(text);
+        } else if (0 == strncmp(text, "true", 4) || 0 == strncmp(text, "null", 4)) {
+            text += 4;
+        } else if (0 == strncmp(text, "false", 5)) {
+            text += 5;
+        } else {
+            char* end;
+            strtod(text, &end);
+            text = end == text ? NULL : end;
+        }
+    } while (NULL != text && ',' == *text++);
+    return NULL != text && '}' == text[-1] && 0 == strcmp(text, "\n");
+}
+
+// Test that JSON lines too long for their buffer stay valid and keep their fields
+bool test_truncated_json() {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, FORMAT_PATH);
+    char           letters[1201], quotes[500], accents[1201], big[2001];
+    memset(letters, 'a', sizeof(letters) - 1);
+    memset(quotes, '"', sizeof(quotes) - 1);
+    memset(big, 'b', sizeof(big) - 1);
+    for (size_t i = 0; i + 1 < sizeof(accents); i += 2) {
+        memcpy(accents + i, "\xc3\xa9", 2); // U+00E9, two bytes
+    }
+    letters[sizeof(letters) - 1] = quotes[sizeof(quotes) - 1] = '\0';
+    accents[sizeof(accents) - 1] = big[sizeof(big) - 1] = '\0';
+
+    log_field_t fields[]  = {log_field_int("k", 1)};
+    log_field_t dropped[] = {log_field_string("big", big), log_field_int("k", 1)};
+    bool        result    = logger_set_format(logger, LOG_FORMAT_JSON);
+
+    // Synchronous, asynchronous and buffered lines have different buffers
+    for (int mode = 0; mode < 3; mode++) {
+        if (1 == mode) {
+            result &= logger_start_async(logger, 0, LOG_POLICY_BLOCK);
+        } else if (2 == mode) {
+            result &= logger_start_buffered(logger, 0, 0);
+        }
+        LOG_FIELDS(logger, LOG_LEVEL_INFO, fields, "%s", letters);
+        LOG_FIELDS(logger, LOG_LEVEL_INFO, fields, "%s", quotes);
+        LOG_FIELDS(logger, LOG_LEVEL_INFO, fields, "%s", accents);
+        LOG_FIELDS(logger, LOG_LEVEL_INFO, dropped, "short");
+        if (1 == mode) {
+            logger_stop_async(logger);
+        } else if (2 == mode) {
+            logger_stop_buffered(logger);
+        }
+    }
+    logger_destroy(logger);
+
+    FILE* file  = fopen(FORMAT_PATH, "r");
+    int   lines = 0;
+    char  line[4096];
+    while (file && fgets(line, sizeof(line), file)) {
+        const char* message = strstr(line, "\"msg\":\"");
+        const char* end     = NULL == message ? NULL : json_skip_string(message + 6);
+
+        result &= json_line_valid(line) && NULL != strstr(line, ",\"truncated\":true}");
+        result &= NULL != strstr(line, ",\"k\":1,") && NULL == strstr(line, "\"big\"");
+
+        // A cut message ends on a whole character
+        result &= NULL != end && 0xC3 != (unsigned char) end[-2];
+
+        // The synchronous buffer holds twice what the others do
+        if (lines < 3) {
+            result &= strlen(line) > LOG_ASYNC_MESSAGE_SIZE;
+        }
+        lines++;
+    }
+    if (file) {
+        fclose(file);
+    }
+    remove(FORMAT_PATH);
+    result &= 12 == lines;
+
+    LOG(&global_logger,
+        result ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR,
+        "Truncated JSON: %d lines %s\n",
+        lines,
+        result ? "valid" : "malformed");
+    return result;
+}
+
+// Compare the caller-side cost of the line layouts, with writes amortized
+void test_format_throughput() {
+    struct Logger*  logger   = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, FORMAT_PATH);
+    log_format_t    format[] = {LOG_FORMAT_PLAIN, LOG_FORMAT_STAMPED, LOG_FORMAT_JSON};
+    struct timespec start, end;
+    double          seconds[3];
+
+    for (int f = 0; f < 3; f++) {
+        logger_set_format(logger, format[f]);
+        logger_start_buffered(logger, 0, 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < FORMAT_COUNT; i++) {
+            LOG(logger, LOG_LEVEL_DEBUG, "step %d loss %f rate %g\n", i, 1.0 / (i + 1), 1e-3);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        logger_stop_buffered(logger);
+        seconds[f] = (double) (end.tv_sec - start.tv_sec)
+                     + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+    }
+
+    logger_destroy(logger);
+    remove(FORMAT_PATH);
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "1 thread: plain %.0f ns, stamped %.0f ns, json %.0f ns per message\n",
+        seconds[0] / FORMAT_COUNT * 1e9,
+        seconds[1] / FORMAT_COUNT * 1e9,
+        seconds[2] / FORMAT_COUNT * 1e9);
+}
+
+// Compare the caller-side cost of binary records and buffered text lines
+void test_binary_throughput() {
+    struct Logger*  logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, BINARY_PATH);
+    struct timespec start, end;
+    double          seconds[2];
+
+    for (int binary = 0; binary < 2; binary++) {
+        if (binary) {
+            logger_start_binary(logger, 0, 0);
+        } else {
+            logger_start_buffered(logger, 0, 0);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < BINARY_COUNT; i++) {
+            LOG_BINARY(logger, LOG_LEVEL_DEBUG, "step %d loss %f rate %g\n", i, 1.0 / (i + 1), 1e-3);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        logger_stop_buffered(logger);
+        seconds[binary] = (double) (end.tv_sec - start.tv_sec)
+                          + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+    }
+
+    logger_destroy(logger);
+    remove(BINARY_PATH);
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "1 thread: buffered text %.0f ns, binary %.0f ns per message\n",
+        seconds[0] / BINARY_COUNT * 1e9,
+        seconds[1] / BINARY_COUNT * 1e9);
+}
+
+// Compare the caller-side cost of synchronous, asynchronous and buffered logging
+void test_async_throughput() {
+    struct Logger* logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, ASYNC_PATH);
+    double         sync   = async_run_workers(logger, ASYNC_MESSAGES);
+
+    logger_start_async(logger, 0, LOG_POLICY_BLOCK);
+    double async = async_run_workers(logger, ASYNC_MESSAGES);
+    logger_stop_async(logger);
+
+    logger_start_buffered(logger, 0, 0);
+    double buffered = async_run_workers(logger, ASYNC_MESSAGES);
+    logger_destroy(logger);
+    remove(ASYNC_PATH);
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "%d threads: sync %.0f ns, async %.0f ns, buffered %.0f ns per message\n",
+        ASYNC_THREADS,
+        sync / ASYNC_MESSAGES * 1e9,
+        async / ASYNC_MESSAGES * 1e9,
+        buffered / ASYNC_MESSAGES * 1e9);
+}
+
 int main(void) {
     // Run all test cases
     test_global_logger_initialization();
@@ -66,6 +859,25 @@ int main(void) {
     test_logging_at_different_levels();
     test_logging_to_file();
 
+    // The global logger was raised to WARN above
+    initialize_global_logger(LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL);
+
+    bool result = true;
+    result &= test_module_levels();
+    result &= test_limited_logging();
+    result &= test_limited_summary();
+    result &= test_async_logging();
+    result &= test_async_policy(LOG_POLICY_DROP, "drop");
+    result &= test_async_policy(LOG_POLICY_OVERWRITE, "overwrite");
+    result &= test_segment_logging();
+    result &= test_buffered_logging();
+    result &= test_binary_logging();
+    result &= test_structured_logging();
+    result &= test_truncated_json();
+    test_async_throughput();
+    test_binary_throughput();
+    test_format_throughput();
+
     puts("Finished all tests!");
-    return 0;
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
 }
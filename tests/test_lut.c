@@ -0,0 +1,263 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_lut.c
+ *
+ * Build:
+ *   g++ -std=c++17 -c source/tables.cpp -o tables.o
+ *   gcc -o test_lut tests/test_lut.c source/lut.c source/fixed.c \
+ *       source/logger.c tables.o -lm -lpthread
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible. The
+ * simpler, the better.
+ */
+
+#include "../include/logger.h"
+#include "../include/lut.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+bool test_lut_error_bounds(void);
+bool test_lut_fixed_error_bounds(void);
+bool test_lut_arrays(void);
+bool test_lut_out_of_range(void);
+
+/** Fixtures */
+
+// Inputs sweep past both ends of the table at an irrational stride
+#define SWEEP_MIN  (EXP_MIN - 2.0)
+#define SWEEP_MAX  (EXP_MAX + 0.3)
+#define SWEEP_SIZE 100003
+
+typedef struct LutCase {
+    const char* name;
+    float (*evaluate)(float);
+    fixed16_t (*evaluate_fixed)(fixed16_t);
+    void (*array)(const float*, float*, size_t);
+    void (*fixed_array)(const fixed16_t*, fixed16_t*, size_t);
+    double (*reference)(double);
+    double bound;    // documented error bound
+    bool   relative; // bound is relative to |f(x)|
+} lut_case_t;
+
+static double reference_sigmoid(double x) {
+    return 1.0 / (1.0 + exp(-x));
+}
+
+static double reference_gelu(double x) {
+    return 0.5 * x
+           * (1.0 + tanh(sqrt(2.0 / M_PI) * (x + 0.044715 * x * x * x)));
+}
+
+static const lut_case_t LUT_CASES[] = {
+    {"exp",
+     lut_exp,
+     lut_exp_fixed,
+     lut_exp_array,
+     lut_exp_fixed_array,
+     exp,
+     5.3e-5,
+     true},
+    {"sigmoid",
+     lut_sigmoid,
+     lut_sigmoid_fixed,
+     lut_sigmoid_array,
+     lut_sigmoid_fixed_array,
+     reference_sigmoid,
+     4.6e-5,
+     false},
+    {"tanh",
+     lut_tanh,
+     lut_tanh_fixed,
+     lut_tanh_array,
+     lut_tanh_fixed_array,
+     tanh,
+     3.9e-5,
+     false},
+    {"gelu",
+     lut_gelu,
+     lut_gelu_fixed,
+     lut_gelu_array,
+     lut_gelu_fixed_array,
+     reference_gelu,
+     4.0e-5,
+     false},
+};
+
+#define LUT_CASE_COUNT (sizeof(LUT_CASES) / sizeof(LUT_CASES[0]))
+
+static double sweep_input(size_t i) {
+    return SWEEP_MIN + (SWEEP_MAX - SWEEP_MIN) * (double) i / (SWEEP_SIZE - 1);
+}
+
+// Error of value against f(x), relative where the case says so
+static double case_error(const lut_case_t* c, double x, double value) {
+    double expected = c->reference(x);
+    double error    = fabs(value - expected);
+    if (c->relative) {
+        // exp flushes below the table, so there the error is absolute and
+        // no larger than exp(EXP_MIN) ~ 4.5e-5
+        return x < EXP_MIN ? error : error / expected;
+    }
+    return error;
+}
+
+/** Unit Tests */
+
+bool test_lut_error_bounds(void) {
+    bool result = true;
+
+    for (size_t c = 0; c < LUT_CASE_COUNT; c++) {
+        const lut_case_t* lut   = &LUT_CASES[c];
+        double            worst = 0.0;
+
+        for (size_t i = 0; i < SWEEP_SIZE; i++) {
+            float x = (float) sweep_input(i);
+            worst   = fmax(worst, case_error(lut, x, lut->evaluate(x)));
+        }
+
+        // float storage adds a few ulp on top of the interpolation bound
+        if (worst > lut->bound * 1.01) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "%s: error %g exceeds bound %g\n",
+                lut->name,
+                worst,
+                lut->bound);
+            result = false;
+        }
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lut_fixed_error_bounds(void) {
+    bool result = true;
+
+    for (size_t c = 0; c < LUT_CASE_COUNT; c++) {
+        const lut_case_t* lut   = &LUT_CASES[c];
+        double            worst = 0.0;
+
+        for (size_t i = 0; i < SWEEP_SIZE; i++) {
+            fixed16_t x     = FLOAT_TO_FIXED(sweep_input(i));
+            double    input = ldexp(x, -FIXED_SIZE);
+            double    value = ldexp(lut->evaluate_fixed(x), -FIXED_SIZE);
+            if (lut->relative && input > EXP_MAX) {
+                continue; // exp saturates above the table
+            }
+
+            // Output quantization adds up to one lsb on top of the bound
+            double lsb = ldexp(1.0, -FIXED_SIZE);
+            if (lut->relative && input >= EXP_MIN) {
+                lsb /= exp(input);
+            }
+            worst = fmax(worst, case_error(lut, input, value) - lsb);
+        }
+
+        if (worst > lut->bound * 1.01) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "%s (fixed): error %g exceeds bound %g\n",
+                lut->name,
+                worst,
+                lut->bound);
+            result = false;
+        }
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lut_arrays(void) {
+    bool         result = true;
+    const size_t n      = 1003; // not a multiple of the vector width
+    float*       src    = (float*) malloc(n * sizeof(float));
+    float*       dst    = (float*) malloc(n * sizeof(float));
+    fixed16_t*   fsrc   = (fixed16_t*) malloc(n * sizeof(fixed16_t));
+    fixed16_t*   fdst   = (fixed16_t*) malloc(n * sizeof(fixed16_t));
+
+    for (size_t i = 0; i < n; i++) {
+        src[i]  = (float) (SWEEP_MIN + (SWEEP_MAX - SWEEP_MIN) * i / (n - 1));
+        fsrc[i] = FLOAT_TO_FIXED(src[i]);
+    }
+    src[7] = NAN;
+
+    for (size_t c = 0; c < LUT_CASE_COUNT; c++) {
+        const lut_case_t* lut = &LUT_CASES[c];
+
+        // The vector path may contract differently, so allow a float ulp
+        lut->array(src, dst, n);
+        for (size_t i = 0; i < n; i++) {
+            float expected = lut->evaluate(src[i]);
+            if (isnan(expected)) {
+                result &= isnan(dst[i]);
+            } else {
+                result &= fabsf(dst[i] - expected)
+                          <= 2.0f * FLT_EPSILON * fmaxf(1.0f, fabsf(expected));
+            }
+        }
+
+        // Integer paths must agree exactly
+        lut->fixed_array(fsrc, fdst, n);
+        for (size_t i = 0; i < n; i++) {
+            result &= fdst[i] == lut->evaluate_fixed(fsrc[i]);
+        }
+    }
+
+    free(src);
+    free(dst);
+    free(fsrc);
+    free(fdst);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lut_out_of_range(void) {
+    bool result = true;
+
+    result &= lut_exp(-50.0f) == 0.0f;
+    result &= fabsf(lut_exp(20.0f) - expf(20.0f)) <= expf(20.0f) * 1e-6f;
+    result &= lut_sigmoid(50.0f) == lut_sigmoid((float) EXP_MAX);
+    result &= lut_tanh(-50.0f) == lut_tanh((float) EXP_MIN);
+    result &= lut_gelu(-50.0f) == 0.0f;
+    result &= lut_gelu(50.0f) == 50.0f;
+
+    result &= lut_exp_fixed(-INT_TO_FIXED(50)) == 0;
+    result &= lut_exp_fixed(INT_TO_FIXED(11)) == FIXED_MAX;
+    result &= lut_gelu_fixed(INT_TO_FIXED(50)) == INT_TO_FIXED(50);
+    result &= lut_sigmoid_fixed(0) == INT_TO_FIXED(1) / 2;
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    result &= test_lut_error_bounds();
+    result &= test_lut_fixed_error_bounds();
+    result &= test_lut_arrays();
+    result &= test_lut_out_of_range();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,272 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_philox.c
+ *
+ * Build:
+ *   gcc -O2 -march=native -o test_philox tests/test_philox.c \
+ *       source/philox.c source/logger.c -lm -lpthread
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible. The
+ * simpler, the better.
+ */
+
+#include "../include/logger.h"
+#include "../include/philox.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** Prototypes */
+
+bool test_philox_known_answers(void);
+bool test_philox_batch(uint64_t offset, size_t n);
+bool test_philox_threads(size_t threads);
+bool test_philox_throughput(void);
+
+/** Fixtures */
+
+#define FIXTURE_SIZE    1003 // not a multiple of the block or vector width
+#define FIXTURE_SEED    0x0123456789ABCDEFull
+#define FIXTURE_STREAM  7
+#define FIXTURE_THREADS 8
+
+// Known-answer vectors from Random123 (kat_vectors, philox4x32 10 rounds)
+typedef struct PhiloxCase {
+    uint32_t counter[PHILOX_BLOCK_SIZE];
+    uint32_t key[2];
+    uint32_t expected[PHILOX_BLOCK_SIZE];
+} philox_case_t;
+
+static const philox_case_t philox_cases[] = {
+    {
+        {0x00000000, 0x00000000, 0x00000000, 0x00000000},
+        {0x00000000, 0x00000000},
+        {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+    },
+    {
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+        {0xffffffff, 0xffffffff},
+        {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+    },
+    {
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+        {0xa4093822, 0x299f31d0},
+        {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+    },
+};
+
+typedef struct PhiloxWorker {
+    const philox_key_t* key;
+    uint64_t            offset;
+    size_t              n;
+    float*              out;
+} philox_worker_t;
+
+static void* philox_worker_fixture(void* argument) {
+    philox_worker_t* worker = (philox_worker_t*) argument;
+    philox_generate_batch_float(
+        worker->key, worker->offset, worker->out, worker->n
+    );
+    return NULL;
+}
+
+static double fixture_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+/** Unit Tests */
+
+bool test_philox_known_answers(void) {
+    bool result = true;
+
+    for (size_t c = 0; c < sizeof(philox_cases) / sizeof(philox_cases[0]);
+         c++) {
+        const philox_case_t* test = &philox_cases[c];
+        uint32_t             out[PHILOX_BLOCK_SIZE];
+
+        philox_4x32_10(test->counter, test->key, out);
+        if (0 != memcmp(out, test->expected, sizeof(out))) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "kat %zu: got %08x %08x %08x %08x\n",
+                c,
+                out[0],
+                out[1],
+                out[2],
+                out[3]);
+            result = false;
+        }
+    }
+
+    // The stream API addresses the same blocks; 64-bit positions only reach
+    // block indices below 2^62, so use the zero counter
+    const philox_case_t* test = &philox_cases[0];
+    philox_key_t         key  = philox_create_key(
+        (uint64_t) test->key[1] << 32 | test->key[0],
+        (uint64_t) test->counter[3] << 32 | test->counter[2]
+    );
+    uint64_t block = (uint64_t) test->counter[1] << 32 | test->counter[0];
+    for (size_t w = 0; w < PHILOX_BLOCK_SIZE; w++) {
+        uint32_t bits = philox_generate_bits(&key, block * 4 + w);
+        if (bits != test->expected[w]) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "kat stream word %zu: got %08x\n",
+                w,
+                bits);
+            result = false;
+        }
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Every batch path must match the scalar value at each position
+bool test_philox_batch(uint64_t offset, size_t n) {
+    bool         result = true;
+    philox_key_t key    = philox_create_key(FIXTURE_SEED, FIXTURE_STREAM);
+    uint32_t*    bits   = (uint32_t*) malloc(sizeof(uint32_t) * n);
+    double*      values = (double*) malloc(sizeof(double) * n);
+    float*       floats = (float*) malloc(sizeof(float) * n);
+
+    philox_generate_batch_bits(&key, offset, bits, n);
+    philox_generate_batch(&key, offset, values, n);
+    philox_generate_batch_float(&key, offset, floats, n);
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t index = offset + i;
+        if (bits[i] != philox_generate_bits(&key, index)
+            || values[i] != philox_generate(&key, index)
+            || floats[i] != philox_generate_float(&key, index)
+            || values[i] < 0.0 || values[i] >= 1.0 || floats[i] < 0.0f
+            || floats[i] >= 1.0f) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "batch offset %lu [%zu]: %08x, %.17g, %.9g\n",
+                (unsigned long) offset,
+                i,
+                bits[i],
+                values[i],
+                (double) floats[i]);
+            result = false;
+            break;
+        }
+    }
+
+    free(bits);
+    free(values);
+    free(floats);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Any split of one range across threads reproduces the single-thread output
+bool test_philox_threads(size_t threads) {
+    const size_t    n        = 1 << 16;
+    bool            result   = true;
+    philox_key_t    key      = philox_create_key(FIXTURE_SEED, FIXTURE_STREAM);
+    float*          expected = (float*) malloc(sizeof(float) * n);
+    float*          actual   = (float*) malloc(sizeof(float) * n);
+    pthread_t       thread[FIXTURE_THREADS];
+    philox_worker_t worker[FIXTURE_THREADS];
+
+    philox_generate_batch_float(&key, 0, expected, n);
+
+    // Uneven chunks so boundaries fall inside blocks
+    size_t start = 0;
+    for (size_t t = 0; t < threads; t++) {
+        size_t end       = t + 1 == threads ? n : (t + 1) * n / threads + t;
+        worker[t].key    = &key;
+        worker[t].offset = start;
+        worker[t].n      = end - start;
+        worker[t].out    = actual + start;
+        pthread_create(&thread[t], NULL, philox_worker_fixture, &worker[t]);
+        start = end;
+    }
+    for (size_t t = 0; t < threads; t++) {
+        pthread_join(thread[t], NULL);
+    }
+
+    if (0 != memcmp(expected, actual, sizeof(float) * n)) {
+        LOG(&global_logger,
+            LOG_LEVEL_ERROR,
+            "threads %zu: output differs from one thread\n",
+            threads);
+        result = false;
+    }
+
+    free(expected);
+    free(actual);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_philox_throughput(void) {
+    const size_t n      = 1 << 22;
+    philox_key_t key    = philox_create_key(FIXTURE_SEED, FIXTURE_STREAM);
+    float*       values = (float*) malloc(sizeof(float) * n);
+    double       sum    = 0.0;
+
+    double start = fixture_seconds();
+    for (size_t i = 0; i < n; i++) {
+        values[i] = philox_generate_float(&key, i);
+    }
+    double scalar_seconds = fixture_seconds() - start;
+    sum                  += values[n - 1];
+
+    start = fixture_seconds();
+    philox_generate_batch_float(&key, n, values, n);
+    double batch_seconds  = fixture_seconds() - start;
+    sum                  += values[n - 1];
+
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "philox float: scalar %.1f, batch %.1f M/s (%g)\n",
+        n / scalar_seconds * 1e-6,
+        n / batch_seconds * 1e-6,
+        sum);
+
+    free(values);
+
+    printf(".");
+    return true;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    result &= test_philox_known_answers();
+
+    // Aligned and unaligned offsets, short ranges, and a 32-bit counter carry
+    result &= test_philox_batch(0, FIXTURE_SIZE);
+    result &= test_philox_batch(3, FIXTURE_SIZE);
+    result &= test_philox_batch(5, 2);
+    result &= test_philox_batch(0, 0);
+    result &= test_philox_batch(4 * 0xFFFFFFF0ull + 1, FIXTURE_SIZE);
+
+    result &= test_philox_threads(1);
+    result &= test_philox_threads(3);
+    result &= test_philox_threads(FIXTURE_THREADS);
+    result &= test_philox_throughput();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
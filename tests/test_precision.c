@@ -3,10 +3,17 @@
  *
  * @file tests/test_precision.c
  *
+ * Build:
+ *   g++ -std=c++17 -c source/tables.cpp -o tables.o
+ *   gcc -Iinclude -o test_precision tests/test_precision.c \
+ *       source/precision.c source/lehmer.c source/logger.c tables.o \
+ *       -lm -lpthread
+ *
  * @note keep fixtures and related tests as simple as reasonably possible. The
  * simpler, the better.
  */
 
+#include "../include/lehmer.h"
 #include "../include/logger.h"
 #include "../include/precision.h"
 
@@ -25,6 +32,18 @@ void  print_bit_representation(float32_t n, size_t width);
 char* get_binary_representation(float32_t n, size_t width);
 bool  compare_binary_strings(const char* str1, const char* str2, size_t length);
 
+// 16-bit decode paths
+bool test_float16_decode_paths(void);
+bool test_bfloat16_array(void);
+
+// 8-bit floating-point formats
+bool test_float8_e4m3(void);
+bool test_float8_e5m2(void);
+bool test_float8_array(void);
+
+// Stochastic rounding
+bool test_stochastic_rounding(void);
+
 // Function to convert an unsigned int into its bit representation
 //
 // void print_bit_representation(float32_t n, size_t width) {
@@ -131,6 +150,265 @@ bool compare_binary_strings(const char* str1, const char* str2, size_t length) {
     return true;
 }
 
+// Compare decoded values bit for bit so NaN payloads are checked as well
+static bool float_bits_equal(float a, float b) {
+    return encode_float32(a) == encode_float32(b);
+}
+
+bool test_float16_decode_paths(void) {
+    const size_t n      = 65536;
+    float16_t*   src    = (float16_t*) malloc(n * sizeof(float16_t));
+    float*       values = (float*) malloc(n * sizeof(float));
+    bool         result = NULL != src && NULL != values;
+
+    const precision_decode_path_t paths[] = {
+        PRECISION_DECODE_ARITHMETIC,
+        PRECISION_DECODE_LUT,
+        PRECISION_DECODE_F16C,
+        PRECISION_DECODE_AUTO,
+    };
+
+    for (size_t i = 0; result && i < n; i++) {
+        src[i]  = (float16_t) i;
+        result &= float_bits_equal(
+            decode_float16_lut(src[i]), decode_float16(src[i])
+        );
+    }
+
+    for (size_t p = 0; result && p < sizeof(paths) / sizeof(paths[0]); p++) {
+        decode_float16_array_path(src, values, n, paths[p]);
+        for (size_t i = 0; i < n; i++) {
+            // F16C quiets signaling NaNs, so only compare NaN-ness there
+            if (isnan(values[i])) {
+                result &= isnan(decode_float16(src[i]));
+            } else {
+                result &= float_bits_equal(values[i], decode_float16(src[i]));
+            }
+        }
+    }
+
+    precision_decode_path_t path = float16_calibrate_decode(n);
+    result &= float16_get_decode_path(n) == path;
+    float16_set_decode_path(PRECISION_DECODE_AUTO);
+
+    free(src);
+    free(values);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_bfloat16_array(void) {
+    const size_t n      = 65536;
+    bfloat16_t*  src    = (bfloat16_t*) malloc(n * sizeof(bfloat16_t));
+    float*       values = (float*) malloc(n * sizeof(float));
+    bool         result = NULL != src && NULL != values;
+
+    for (size_t i = 0; result && i < n; i++) {
+        src[i] = (bfloat16_t) i;
+    }
+
+    if (result) {
+        decode_bfloat16_array(src, values, n);
+        for (size_t i = 0; i < n; i++) {
+            float expected = decode_bfloat16(src[i]);
+            result &= isnan(expected) ? isnan(values[i])
+                                      : float_bits_equal(values[i], expected);
+        }
+    }
+
+    free(src);
+    free(values);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Decode every encoding and re-encode it; all finite values must round-trip
+static bool float8_round_trip(
+    float (*decode)(float8_t), float8_t (*encode)(float), const char* label
+) {
+    bool result = true;
+    for (uint32_t i = 0; i < 256; i++) {
+        float value = decode((float8_t) i);
+        if (!isfinite(value)) {
+            continue; // NaN stays NaN and infinities saturate
+        }
+        if (encode(value) != (float8_t) i) {
+            LOG(&global_logger,
+                LOG_LEVEL_ERROR,
+                "%s: 0x%02x decoded to %g but encoded to 0x%02x\n",
+                label,
+                i,
+                (double) value,
+                encode(value));
+            result = false;
+        }
+    }
+    return result;
+}
+
+bool test_float8_e4m3(void) {
+    bool result = float8_round_trip(
+        decode_float8_e4m3, encode_float8_e4m3, "e4m3"
+    );
+
+    result &= encode_float8_e4m3(1.0f) == 0x38;
+    result &= encode_float8_e4m3(-2.0f) == 0xC0;
+    result &= encode_float8_e4m3(448.0f) == FLOAT8_E4M3_MAX;
+    result &= encode_float8_e4m3(1e6f) == FLOAT8_E4M3_MAX;     // saturate
+    result &= encode_float8_e4m3(-INFINITY) == 0xFE;           // saturate
+    result &= encode_float8_e4m3(NAN) == FLOAT8_E4M3_NAN;      // NaN
+    result &= encode_float8_e4m3(1.0625f) == 0x38;             // tie to even
+    result &= encode_float8_e4m3(1.1875f) == 0x3A;             // tie to even
+    result &= decode_float8_e4m3(0x01) == ldexpf(1.0f, -9);    // subnormal
+    result &= decode_float8_e4m3(FLOAT8_E4M3_MAX) == 448.0f;
+    result &= isnan(decode_float8_e4m3(0xFF));
+    result &= encode_float8(3.0f) == encode_float8_e4m3(3.0f);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_float8_e5m2(void) {
+    bool result = float8_round_trip(
+        decode_float8_e5m2, encode_float8_e5m2, "e5m2"
+    );
+
+    result &= encode_float8_e5m2(1.0f) == 0x3C;
+    result &= encode_float8_e5m2(57344.0f) == FLOAT8_E5M2_MAX;
+    result &= encode_float8_e5m2(1e9f) == FLOAT8_E5M2_MAX;     // saturate
+    result &= encode_float8_e5m2(INFINITY) == FLOAT8_E5M2_MAX; // saturate
+    result &= encode_float8_e5m2(NAN) == FLOAT8_E5M2_NAN;      // NaN
+    result &= decode_float8_e5m2(0x01) == ldexpf(1.0f, -16);   // subnormal
+    result &= isinf(decode_float8_e5m2(0x7C));
+    result &= isnan(decode_float8_e5m2(0x7D));
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_float8_array(void) {
+    const size_t n = 37; // exercise both the vector body and the scalar tail
+    float        src[37];
+    float        e4m3_values[37], e5m2_values[37];
+    float8_t     e4m3[37], e5m2[37];
+
+    for (size_t i = 0; i < n; i++) {
+        src[i] = ((float) i - 18.0f) * 0.37f * (float) (i + 1);
+    }
+    src[3] = NAN;
+    src[4] = 1e-9f;
+
+    encode_float8_e4m3_array(src, e4m3, n);
+    encode_float8_e5m2_array(src, e5m2, n);
+    decode_float8_e4m3_array(e4m3, e4m3_values, n);
+    decode_float8_e5m2_array(e5m2, e5m2_values, n);
+
+    bool result = true;
+    for (size_t i = 0; i < n; i++) {
+        result &= e4m3[i] == encode_float8_e4m3(src[i]);
+        result &= e5m2[i] == encode_float8_e5m2(src[i]);
+        result &= (isnan(e4m3_values[i]) && isnan(decode_float8_e4m3(e4m3[i])))
+                  || e4m3_values[i] == decode_float8_e4m3(e4m3[i]);
+        result &= (isnan(e5m2_values[i]) && isnan(decode_float8_e5m2(e5m2[i])))
+                  || e5m2_values[i] == decode_float8_e5m2(e5m2[i]);
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+// Mean of n stochastically rounded copies of value, decoded back to float
+static double stochastic_mean(
+    float           value,
+    size_t          n,
+    lehmer_state_t* state,
+    data_type_t     type,
+    float*          values
+) {
+    float*      src  = (float*) malloc(n * sizeof(float));
+    bfloat16_t* bf16 = (bfloat16_t*) malloc(n * sizeof(bfloat16_t));
+    float8_t*   f8   = (float8_t*) malloc(n * sizeof(float8_t));
+    double      mean = 0.0;
+
+    for (size_t i = 0; i < n; i++) {
+        src[i] = value;
+    }
+
+    if (TYPE_FLOAT_BF16 == type) {
+        encode_bfloat16_stochastic_array(src, bf16, n, state);
+        decode_bfloat16_array(bf16, values, n);
+    } else {
+        encode_float8_e4m3_stochastic_array(src, f8, n, state);
+        decode_float8_e4m3_array(f8, values, n);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        mean += values[i];
+    }
+
+    free(src);
+    free(bf16);
+    free(f8);
+    return mean / (double) n;
+}
+
+bool test_stochastic_rounding(void) {
+    const size_t    n      = 1 << 16;
+    float*          values = (float*) malloc(n * sizeof(float));
+    lehmer_state_t* state  = lehmer_create_state(STREAMS);
+    bool            result = true;
+
+    lehmer_seed_streams(state, DEFAULT);
+
+    // A quarter of a bfloat16 step above 1.0 rounds up a quarter of the time
+    float  bf16_value = 1.0f + ldexpf(1.0f, -9);
+    double bf16_mean  = stochastic_mean(
+        bf16_value, n, state, TYPE_FLOAT_BF16, values
+    );
+    result &= fabs(bf16_mean - bf16_value) < 1e-4;
+    for (size_t i = 0; i < n; i++) {
+        result &= values[i] == 1.0f || values[i] == 1.0f + ldexpf(1.0f, -7);
+    }
+
+    // Same for E4M3 with a value 0.3 of the way between 1.0 and 1.125, and
+    // a subnormal 0.7 of the way between 0 and the smallest subnormal
+    float  f8_value = 1.0375f;
+    double f8_mean  = stochastic_mean(
+        f8_value, n, state, TYPE_FLOAT_F8, values
+    );
+    float  tiny_value = 0.7f * ldexpf(1.0f, -9);
+    double tiny_mean  = stochastic_mean(
+        tiny_value, n, state, TYPE_FLOAT_F8, values
+    );
+    result &= fabs(f8_mean - f8_value) < 1e-3;
+    result &= fabs(tiny_mean - tiny_value) < 1e-5;
+
+    // Representable values, NaN and saturation are unaffected by the noise
+    result &= encode_bfloat16_stochastic(1.5f, 0xFFFF) == 0x3FC0;
+    result &= encode_bfloat16_stochastic(INFINITY, 0xFFFF) == 0x7F80;
+    result &= encode_float8_e4m3_stochastic(1.0f, 0xFFFFFFFF) == 0x38;
+    result &= encode_float8_e4m3_stochastic(1e6f, 0) == FLOAT8_E4M3_MAX;
+    result &= encode_float8_e4m3_stochastic(NAN, 0) == FLOAT8_E4M3_NAN;
+    result &= encode_float8_e5m2_stochastic(-INFINITY, 0) == 0xFB;
+
+    lehmer_free_state(state);
+
+    // A state without streams truncates instead of hanging
+    state             = lehmer_create_state(0);
+    float      src[3] = {bf16_value, -bf16_value, 1.5f};
+    bfloat16_t dst[3] = {0};
+    encode_bfloat16_stochastic_array(src, dst, 3, state);
+    result &= 0x3F80 == dst[0] && 0xBF80 == dst[1] && 0x3FC0 == dst[2];
+    lehmer_free_state(state);
+
+    free(values);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
 int main(void) {
     // NULL for const char* file_path
     // the log level can probably be set via a CLI param or config in the
@@ -144,6 +422,14 @@ int main(void) {
     float32_t n = encode_float32(10.0f);
     print_bit_representation(n, BIT_WIDTH);
 
+    result &= test_float16_decode_paths();
+    result &= test_bfloat16_array();
+    result &= test_float8_e4m3();
+    result &= test_float8_e5m2();
+    result &= test_float8_array();
+    result &= test_stochastic_rounding();
+    printf("\n");
+
     // char* bin = get_binary_representation(1, 32);
     // fprintf(stderr, "bin: %s\n", bin);
 
@@ -15,6 +15,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 /** Prototypes */
 
@@ -38,6 +39,7 @@ bool test_vector_vector_elementwise_operation(
     vector_t* (*operation_elementwise)(const vector_t*, const vector_t*),
     float (*operation)(float a, float b)
 );
+bool test_vector_divide_by_zero(void);
 
 // Common vector operations
 bool test_vector_magnitude(void);
@@ -359,6 +361,45 @@ bool test_vector_free(void) {
     return result;
 }
 
+// A zero divisor per element must not turn into one log line per element
+bool test_vector_divide_by_zero(void) {
+    const size_t    n = 1 << 20;
+    vector_t*       a = vector_create(n);
+    vector_t*       b = vector_create(n);
+    struct timespec start, end;
+
+    for (size_t i = 0; i < n; ++i) {
+        a->elements[i] = 1.0f;
+        b->elements[i] = 0.0f;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    vector_t* c = vector_vector_divide(a, b);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    bool result = NULL != c;
+    for (size_t i = 0; result && i < n; ++i) {
+        result = isnan(c->elements[i]);
+    }
+
+    double seconds = (double) (end.tv_sec - start.tv_sec)
+                     + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+    LOG(&global_logger,
+        LOG_LEVEL_INFO,
+        "%zu zero divisors in %.1f ms\n",
+        n,
+        seconds * 1e3);
+
+    vector_free(a);
+    vector_free(b);
+    if (c) {
+        vector_free(c);
+    }
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
 bool test_vector_magnitude(void) {
     bool  result    = true;
     float tolerance = 0.0001; // Tolerance for floating-point comparison
@@ -512,6 +553,7 @@ int main(void) {
     result &= test_vector_vector_elementwise_operation(
         "divide", vector_vector_divide, scalar_divide
     );
+    result &= test_vector_divide_by_zero();
 
     // Common vector operations
 